@@ -167,9 +167,16 @@ void Model::init_ranks (int comm)
             for (int i = 0; i < G->_nifelm; i++)
                   proc_rank (g, i, comm);
             }
+      proc_jobs();
       _ready = true;
       }
 
+//---------------------------------------------------------
+//   proc_rank
+//    MT_SAVE_RANK saves modified waves, otherwise a job
+//    is queued for every rank whose cache key changed
+//---------------------------------------------------------
+
 
 void Model::proc_rank (int g, int i, int comm)
       {
@@ -179,37 +186,66 @@ void Model::proc_rank (int g, int i, int comm)
             int r = (I->_action0 >>  8) & 255;
             Rank* R = _divis [d]._ranks + r;
             if (comm == MT_SAVE_RANK) {
-                  if (R->_wave->modif ()) {
+                  if (R->_wave && R->_wave->modif ()) {
                         R->_wave->save(_waves, R->_sdef, _aeolus->_fsamp,
-                           _fbase, scales[_itemp]._data);
+                           _fbase, scales[_itemp]._data, R->_key);
                         }
                   }
             else if (R->_count != _count) {
                   R->_count = _count;
-                  M_def_rank* M = new M_def_rank (comm);
-                  M->_divis = d;
-                  M->_rank  = r;
-                  M->_group = g;
-                  M->_ifelm = i;
-                  M->_fsamp = _aeolus->_fsamp;
-                  M->_fbase = _fbase;
-                  M->_scale = scales [_itemp]._data;
-                  M->_sdef  = R->_sdef;
-                  M->_wave  = R->_wave;
-                  M->_path  = _waves;
-
-//WS                  send_event(TO_IFACE, new M_ifc_ifelm (MT_IFC_ELATT, M->_group, M->_ifelm));
-
-                  M->_wave = new Rankwave (M->_sdef->_n0, M->_sdef->_n1);
-                  if (M->_wave->load (M->_path, M->_sdef, M->_fsamp, M->_fbase, M->_scale))
-                        M->_wave->gen_waves (M->_sdef, M->_fsamp, M->_fbase, M->_scale);
-
-                  _aeolus->_divisp [M->_divis]->set_rank (M->_rank, M->_wave,  M->_sdef->_pan, M->_sdef->_del);
-                  _divis [M->_divis]._ranks [M->_rank]._wave = M->_wave;
+                  uint32_t key = Rankwave::cacheKey(R->_sdef, _aeolus->_fsamp, _fbase, scales[_itemp]._data);
+                  if (R->_wave && R->_key == key)
+                        return;           // waves are up to date
+                  RankJob j;
+                  j._divis = d;
+                  j._rank  = r;
+                  j._key   = key;
+                  j._sdef  = R->_sdef;
+                  j._wave  = 0;
+                  j._path  = _waves;
+                  j._fsamp = _aeolus->_fsamp;
+                  j._fbase = _fbase;
+                  j._scale = scales [_itemp]._data;
+                  _jobs.append(j);
                   }
             }
       }
 
+//---------------------------------------------------------
+//   loadRank
+//    load the waves of a rank from the cache or generate
+//    and cache them; runs on a worker thread
+//---------------------------------------------------------
+
+static void loadRank(RankJob& j)
+      {
+      j._wave = new Rankwave (j._sdef->_n0, j._sdef->_n1);
+      if (j._wave->load (j._path, j._sdef, j._fsamp, j._fbase, j._scale, j._key)) {
+            j._wave->gen_waves (j._sdef, j._fsamp, j._fbase, j._scale, j._key);
+            j._wave->save (j._path, j._sdef, j._fsamp, j._fbase, j._scale, j._key);
+            }
+      }
+
+//---------------------------------------------------------
+//   proc_jobs
+//    load or generate all queued ranks concurrently and
+//    hand them to the divisions
+//---------------------------------------------------------
+
+void Model::proc_jobs()
+      {
+      if (_jobs.isEmpty())
+            return;
+      QtConcurrent::blockingMap(_jobs, loadRank);
+      foreach (const RankJob& j, _jobs) {
+            _aeolus->_divisp [j._divis]->set_rank (j._rank, j._wave, j._sdef->_pan, j._sdef->_del);
+            Rank* R  = _divis [j._divis]._ranks + j._rank;
+            R->_wave = j._wave;
+            R->_key  = j._key;
+            }
+      _jobs.clear();
+      }
+
 //---------------------------------------------------------
 //   set_ifelm
 //    Set, reset or toggle a stop.
@@ -338,6 +374,8 @@ void Model::recalc (int g, int i)
       _count++;
       _ready = false;
       proc_rank (g, i, MT_CALC_RANK);
+      proc_jobs();
+      _ready = true;
       }
 
 #if 0
@@ -563,6 +601,7 @@ int Model::read_instr ()
                         A->_del = d;
 			R = D->_ranks + D->_nrank++;
                         R->_count = 0;
+                        R->_key = 0;
                         R->_sdef = A;
                         R->_wave = 0;
 		    }
@@ -43,10 +43,30 @@ class Rank
 public:
 
     int         _count;
+    uint32_t    _key;     // cache key of _wave
     Addsynth   *_sdef;
     Rankwave   *_wave;
 };
 
+//---------------------------------------------------------
+//   RankJob
+//    a rank wave to be loaded from the wave cache or
+//    generated on a worker thread
+//---------------------------------------------------------
+
+struct RankJob
+      {
+      int         _divis;
+      int         _rank;
+      uint32_t    _key;
+      Addsynth*   _sdef;
+      Rankwave*   _wave;
+      const char* _path;
+      float       _fsamp;
+      float       _fbase;
+      float*      _scale;
+      };
+
 
 class Divis
       {
@@ -165,11 +185,13 @@ class Model
       int             _sc_group; // stop control group number
       Chconf          _chconf [8];
       Preset*         _preset [NBANK][NPRES];
+      QList<RankJob>  _jobs;
 
       void init_audio();
       void init_iface();
       void init_ranks(int comm);
       void proc_rank(int g, int i, int comm);
+      void proc_jobs();
       void set_mconf(int i, uint16_t *d);
       void get_state(uint32_t *bits);
       void set_state(int bank, int pres);
@@ -24,17 +24,22 @@ extern float exp2ap (float);
 
 
 Rngen   Pipewave::_rgen;
-float  *Pipewave::_arg = 0;
-float  *Pipewave::_att = 0;
 
-void Pipewave::initstatic(float fsamp)
+//---------------------------------------------------------
+//   Wavegen
+//---------------------------------------------------------
+
+Wavegen::Wavegen(float fsamp, uint32_t seed)
       {
-      if (_arg)
-            return;
-      int k = (int)(fsamp);
-      _arg  = new float [k];
-      k     = (int)(0.5f * fsamp);
-      _att  = new float [k];
+      _arg = new float [(int)(fsamp)];
+      _att = new float [(int)(0.5f * fsamp)];
+      _rgen.init(seed ? seed : 1);
+      }
+
+Wavegen::~Wavegen()
+      {
+      delete[] _arg;
+      delete[] _att;
       }
 
 //---------------------------------------------------------
@@ -179,10 +184,12 @@ void Pipewave::play()
 }
 
 
-void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
+void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe, Wavegen *W)
 {
     int    h, i, k, nc;
     float  f0, f1, f, m, t, v, v0;
+    float  *arg = W->_arg;
+    float  *att = W->_att;
 
     m = D->_n_att.vi (n);
     for (h = 0; h < N_HARM; h++)
@@ -193,7 +200,7 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
     _l0 = (int)(fsamp * m + 0.5);
     _l0 = (_l0 + PERIOD - 1) & ~(PERIOD - 1);
 
-    f1 = (fpipe + D->_n_off.vi (n) + D->_n_ran.vi (n) * (2 * _rgen.urand () - 1)) / fsamp;
+    f1 = (fpipe + D->_n_off.vi (n) + D->_n_ran.vi (n) * (2 * W->_rgen.urand () - 1)) / fsamp;
     f0 = f1 * exp2ap (D->_n_atd.vi (n) / 1200.0f);
 
     for (h = N_HARM - 1; h >= 0; h--)
@@ -230,14 +237,14 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
     k = (int)(fsamp * D->_n_att.vi (n) + 0.5);
     for (i = 0; i <= _l0; i++)
     {
-        _arg [i] = t - floorf (t + 0.5);
+        arg [i] = t - floorf (t + 0.5);
 	t += (i < k) ? (((k - i) * f0 + i * f1) / k) : f1;
     }
 
     for (i = 1; i < _l1; i++)
     {
-	t = _arg [_l0]+ (float) i * nc / _l1;
-        _arg [i + _l0] = t - floorf (t + 0.5);
+	t = arg [_l0]+ (float) i * nc / _l1;
+        arg [i + _l0] = t - floorf (t + 0.5);
     }
 
     v0 = exp2ap (0.1661 * D->_n_vol.vi (n));
@@ -247,16 +254,16 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
         v = D->_h_lev.vi (h, n);
         if (v < -80.0) continue;
 
-        v = v0 * exp2ap (0.1661 * (v + D->_h_ran.vi (h, n) * (2 * _rgen.urand () - 1)));
+        v = v0 * exp2ap (0.1661 * (v + D->_h_ran.vi (h, n) * (2 * W->_rgen.urand () - 1)));
         k = (int)(fsamp * D->_h_att.vi (h, n) + 0.5);
-        attgain (k, D->_h_atp.vi (h, n));
+        attgain (k, D->_h_atp.vi (h, n), att);
 
         for (i = 0; i < _l0 + _l1; i++)
         {
-	    t = _arg [i] * (h + 1);
+	    t = arg [i] * (h + 1);
             t -= floorf (t);
             m = v * sinf (2 * M_PI * t);
-            if (i < k) m *= _att [i];
+            if (i < k) m *= att [i];
             _p0 [i] += m;
         }
     }
@@ -307,7 +314,7 @@ void Pipewave::looplen (float f, float fsamp, int lmax, int *aa, int *bb)
 }
 
 
-void Pipewave::attgain (int n, float p)
+void Pipewave::attgain (int n, float p, float *att)
 {
     int    i, j, k;
     float  d, m, w, x, y, z;
@@ -327,7 +334,7 @@ void Pipewave::attgain (int n, float p)
         while (j < k)
 	{
             m = (double) j / n;
-            _att [j++] = (1.0 - m) * z + m;
+            att [j++] = (1.0 - m) * z + m;
             z += d;
 	}
     }
@@ -398,14 +405,20 @@ Rankwave::~Rankwave (void)
 }
 
 
-void Rankwave::gen_waves (Addsynth *D, float fsamp, float fbase, float *scale)
+//---------------------------------------------------------
+//   gen_waves
+//    reentrant; the random generator is seeded from the
+//    cache key so that the same key yields the same waves
+//---------------------------------------------------------
+
+void Rankwave::gen_waves (Addsynth *D, float fsamp, float fbase, float *scale, uint32_t key)
 {
-    Pipewave::initstatic (fsamp);
+    Wavegen W (fsamp, key);
 
     fbase *=  D->_fn / (D->_fd * scale [9]);
     for (int i = _n0; i <= _n1; i++)
     {
-	_pipes [i - _n0].genwave (D, i - _n0, fsamp, ldexpf (fbase * scale [i % 12], i / 12 - 5));
+	_pipes [i - _n0].genwave (D, i - _n0, fsamp, ldexpf (fbase * scale [i % 12], i / 12 - 5), &W);
     }
     _modif = true;
 }
@@ -446,18 +459,123 @@ void Rankwave::play (int shift)
 }
 
 
-int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, float *scale)
+//---------------------------------------------------------
+//   hash
+//    FNV-1a
+//---------------------------------------------------------
+
+static uint32_t hash (uint32_t h, const void *p, int n)
+      {
+      const unsigned char* c = (const unsigned char*) p;
+      while (n--) {
+            h ^= *c++;
+            h *= 16777619u;
+            }
+      return h;
+      }
+
+static uint32_t hash (uint32_t h, const N_func& f)
+      {
+      for (int i = 0; i < N_NOTE; i++) {
+            float v = f.vs (i);
+            int   s = f.st (i);
+            h = hash (h, &v, sizeof (v));
+            h = hash (h, &s, sizeof (s));
+            }
+      return h;
+      }
+
+static uint32_t hash (uint32_t h, const HN_func& f)
+      {
+      for (int k = 0; k < N_HARM; k++) {
+            for (int i = 0; i < N_NOTE; i++) {
+                  float v = f.vs (k, i);
+                  int   s = f.st (k, i);
+                  h = hash (h, &v, sizeof (v));
+                  h = hash (h, &s, sizeof (s));
+                  }
+            }
+      return h;
+      }
+
+//---------------------------------------------------------
+//   cacheKey
+//    identifies the waves generated for a stop definition,
+//    sample rate, tuning and temperament
+//---------------------------------------------------------
+
+uint32_t Rankwave::cacheKey (const Addsynth *D, float fsamp, float fbase, const float *scale)
+      {
+      int32_t version = WAVE_CACHE_VERSION;
+      uint32_t h = 2166136261u;
+      h = hash (h, &version, sizeof (version));
+      h = hash (h, &fsamp, sizeof (fsamp));
+      h = hash (h, &fbase, sizeof (fbase));
+      h = hash (h, scale, 12 * sizeof (float));
+      h = hash (h, &D->_n0, sizeof (D->_n0));
+      h = hash (h, &D->_n1, sizeof (D->_n1));
+      h = hash (h, &D->_fn, sizeof (D->_fn));
+      h = hash (h, &D->_fd, sizeof (D->_fd));
+      h = hash (h, D->_n_vol);
+      h = hash (h, D->_n_off);
+      h = hash (h, D->_n_ran);
+      h = hash (h, D->_n_ins);
+      h = hash (h, D->_n_att);
+      h = hash (h, D->_n_atd);
+      h = hash (h, D->_n_dct);
+      h = hash (h, D->_n_dcd);
+      h = hash (h, D->_h_lev);
+      h = hash (h, D->_h_ran);
+      h = hash (h, D->_h_att);
+      h = hash (h, D->_h_atp);
+      return h;
+      }
+
+//---------------------------------------------------------
+//   cacheName
+//    path of the wave cache file for key
+//---------------------------------------------------------
+
+static void cacheName (char *name, const char *path, Addsynth *D, uint32_t key)
+      {
+      char *p;
+
+      sprintf (name, "%s/%s", path, D->_filename);
+      if ((p = strrchr (name, '.'))) *p = 0;
+      sprintf (name + strlen (name), "-%08x.ae1", key);
+      }
+
+//---------------------------------------------------------
+//   pruneCache
+//    remove the cache files of the same stop written for
+//    other keys or before the files were keyed; name is
+//    the file to keep
+//---------------------------------------------------------
+
+static void pruneCache (const char *name)
+      {
+      QFileInfo fi (QString::fromLocal8Bit (name));
+      QString file = fi.fileName ();
+      QString stop = file.left (file.lastIndexOf ('-'));
+      QDir dir (fi.absolutePath ());
+      QStringList filter;
+      filter << stop + "-????????.ae1" << stop + ".ae1";
+      QStringList fl = dir.entryList (filter, QDir::Files);
+      foreach (const QString& f, fl) {
+            if (f != file)
+                  dir.remove (f);
+            }
+      }
+
+int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, float *scale, uint32_t key)
 {
     FILE      *F;
     Pipewave  *P;
     int        i;
     char       name [1024];
     char       data [64];
-    char      *p;
 
-    sprintf (name, "%s/%s", path, D->_filename);
-    if ((p = strrchr (name, '.'))) strcpy (p, ".ae1");
-    else strcat (name, ".ae1");
+    cacheName (name, path, D, key);
 
     F = fopen (name, "wb");
     if (F == NULL)
@@ -468,7 +586,8 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
 
     memset (data, 0, 16);
     strcpy (data, "ae1");
-    data [4] = 1;
+    data [4] = WAVE_CACHE_VERSION;
+    memcpy (data + 8, &key, sizeof (key));
     fwrite (data, 1, 16, F);
 
     memset (data, 0, 64);
@@ -488,25 +607,23 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
     for (i = _n0, P = _pipes; i <= _n1; i++, P++) P->save (F);
 
     fclose (F);
+    pruneCache (name);
 
     _modif = false;
     return 0;
 }
 
 
-int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, float *scale)
+int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, float *scale, uint32_t key)
 {
     FILE      *F;
     Pipewave  *P;
     int        i;
     char       name [1024];
     char       data [64];
-    char      *p;
     float      f;
 
-    sprintf (name, "%s/%s", path, D->_filename);
-    if ((p = strrchr (name, '.'))) strcpy (p, ".ae1");
-    else strcat (name, ".ae1");
+    cacheName (name, path, D, key);
 
     F = fopen (name, "rb");
     if (F == NULL)
@@ -527,7 +644,7 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
         return 1;
     }
 
-    if (data [4] != 1)
+    if (data [4] != WAVE_CACHE_VERSION)
     {
 #ifdef DEBUG
 	fprintf (stderr, "File '%s' has an incompatible version tag (%d)\n", name, data [4]);
@@ -536,6 +653,17 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
         return 1;
     }
 
+    uint32_t k;
+    memcpy (&k, data + 8, sizeof (k));
+    if (k != key)
+    {
+#ifdef DEBUG
+	fprintf (stderr, "File '%s' was generated for a different stop definition\n", name);
+#endif
+        fclose (F);
+        return 1;
+    }
+
     fread (data, 1, 64, F);
     if (_n0 != data [4] || _n1 != data [5])
     {
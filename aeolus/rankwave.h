@@ -26,6 +26,27 @@
 
 
 #define PERIOD 64
+#define WAVE_CACHE_VERSION 2
+
+//---------------------------------------------------------
+//   Wavegen
+//    scratch space for Pipewave::genwave(); every thread
+//    generating waves uses its own instance
+//---------------------------------------------------------
+
+class Wavegen
+      {
+      Wavegen (const Wavegen&);
+      Wavegen& operator=(const Wavegen&);
+
+   public:
+      Wavegen (float fsamp, uint32_t seed);
+      ~Wavegen ();
+
+      float* _arg;
+      float* _att;
+      Rngen  _rgen;
+      };
 
 
 class Pipewave
@@ -42,13 +63,13 @@ private:
 
     friend class Rankwave;
 
-    void genwave (Addsynth *D, int n, float fsamp, float fpipe);
+    void genwave (Addsynth *D, int n, float fsamp, float fpipe, Wavegen *W);
     void save (FILE *F);
     void load (FILE *F);
     void play (void);
 
     static void looplen (float f, float fsamp, int lmax, int *aa, int *bb);
-    static void attgain (int n, float p);
+    static void attgain (int n, float p, float *att);
 
     float     *_p0;    // attack start
     float     *_p1;    // loop start
@@ -73,12 +94,7 @@ private:
     float      _g_r;   // release gain
     int16_t    _i_r;   // release count
 
-
-    static void initstatic (float fsamp);
-
     static   Rngen   _rgen;
-    static   float  *_arg;
-    static   float  *_att;
 };
 
 //---------------------------------------------------------
@@ -134,9 +150,10 @@ public:
     int  n1 (void) const { return _n1; }
     void play (int shift);
     void set_param (float *out, int del, int pan);
-    void gen_waves (Addsynth *D, float fsamp, float fbase, float *scale);
-    int  save (const char *path, Addsynth *D, float fsamp, float fbase, float *scale);
-    int  load (const char *path, Addsynth *D, float fsamp, float fbase, float *scale);
+    void gen_waves (Addsynth *D, float fsamp, float fbase, float *scale, uint32_t key);
+    int  save (const char *path, Addsynth *D, float fsamp, float fbase, float *scale, uint32_t key);
+    int  load (const char *path, Addsynth *D, float fsamp, float fbase, float *scale, uint32_t key);
+    static uint32_t cacheKey (const Addsynth *D, float fsamp, float fbase, const float *scale);
     bool modif (void) const { return _modif; }
 
     int  _cmask;  // used by division logic
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Compare the wall clock time of one conversion with mscore-converter
+# and with "mscore -o". Run in the build directory:
+#
+#     compare_startup.sh score.mscx out.pdf [runs]
+#
+# For cold start numbers set COLD=1: before every run the executable,
+# the shared libraries it loads, the score and any files listed in
+# EVICT are dropped from the page cache. This needs GNU dd
+# (iflag=nocache) but no root rights. Pages which other processes
+# still map (libc, for example) stay in memory.
+
+if [ $# -lt 2 ]; then
+      echo "usage: $0 score out [runs]"
+      exit 1
+fi
+SCORE=$1
+OUT=$2
+RUNS=${3:-10}
+CONVERTER=${CONVERTER:-./converter/mscore-converter}
+MSCORE=${MSCORE:-./mscore/mscore}
+
+# files used by executable $1
+files() {
+      echo "$1"
+      ldd "$1" 2>/dev/null | sed -n 's/.*=> \(\/[^ ]*\).*/\1/p; t; s/^[[:space:]]*\(\/[^ ]*\).*/\1/p'
+      echo "$SCORE"
+      for f in $EVICT; do
+            echo "$f"
+      done
+}
+
+evict() {
+      sync
+      files "$1" | while read -r f; do
+            dd if="$f" iflag=nocache count=0 status=none 2>/dev/null
+      done
+}
+
+run() {
+      total=0
+      i=0
+      while [ $i -lt $RUNS ]; do
+            if [ -n "$COLD" ]; then
+                  evict "$1"
+            fi
+            start=$(date +%s%N)
+            "$@" > /dev/null 2>&1 || { echo "failed: $*"; exit 1; }
+            end=$(date +%s%N)
+            total=$((total + (end - start) / 1000000))
+            i=$((i + 1))
+      done
+      echo "$((total / RUNS)) ms"
+}
+
+echo "mscore-converter: $(run $CONVERTER "$SCORE" "$OUT")"
+echo "mscore -o:        $(run $MSCORE -o "$OUT" "$SCORE")"
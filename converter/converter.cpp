@@ -0,0 +1,371 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+//
+//    mscore-converter: convert scores without the MuseScore
+//    application; only libmscore, the importers/exporters and
+//    a QGuiApplication (needed for fonts) are initialized
+//
+
+#include "config.h"
+#include "libmscore/score.h"
+#include "libmscore/page.h"
+#include "libmscore/style.h"
+#include "libmscore/instrtemplate.h"
+#include "libmscore/chordlist.h"
+#include "mscore/preferences.h"
+#include "mscore/exportmidi.h"
+#include "mscore/svggenerator.h"
+
+namespace Ms {
+
+extern Score::FileError importMidi(Score*, const QString&);
+extern Score::FileError importBB(Score*, const QString&);
+extern Score::FileError importCapella(Score*, const QString&);
+extern Score::FileError importCapXml(Score*, const QString&);
+extern Score::FileError importMusicXml(Score*, const QString&);
+extern Score::FileError importCompressedMusicXml(Score*, const QString&);
+extern bool saveXml(Score*, const QString&);
+extern bool saveMxl(Score*, const QString&);
+extern bool savePositions(Score*, const QString&);
+
+bool noGui = true;
+bool converterMode = true;
+double converterDpi = 0;
+bool enableTestMode = false;
+QString revision;
+QString dataPath;
+
+//---------------------------------------------------------
+//   Preferences
+//    the converter never reads the user settings; only
+//    the values used by importers and exporters are set
+//---------------------------------------------------------
+
+Preferences preferences;
+
+Preferences::Preferences()
+      {
+      }
+
+static void initPreferences()
+      {
+      preferences.midiExpandRepeats    = true;
+      preferences.musicxmlImportLayout = true;
+      preferences.musicxmlImportBreaks = true;
+      preferences.musicxmlExportLayout = true;
+      preferences.musicxmlExportBreaks = ALL_BREAKS;
+      preferences.pngResolution        = 300.0;
+      preferences.shortestNote         = MScore::division / 4;
+      }
+
+//---------------------------------------------------------
+//   usage
+//---------------------------------------------------------
+
+static void usage()
+      {
+      printf("usage: mscore-converter [options] infile outfile\n"
+             "   -S file   load style file\n"
+             "   -r dpi    png/svg resolution\n"
+             "   -t        print startup and conversion time\n"
+             "   -d        debug mode\n");
+      exit(-1);
+      }
+
+//---------------------------------------------------------
+//   readScore
+//---------------------------------------------------------
+
+static Score* readScore(const QString& name)
+      {
+      Score* score = new Score(MScore::defaultStyle());
+      score->setName(name);
+      QString csl = score->fileInfo()->suffix().toLower();
+
+      Score::FileError rv;
+      if (csl == "mscz" || csl == "mscx")
+            rv = score->loadMsc(name, true);
+      else {
+            typedef Score::FileError (*ImportFunction)(Score*, const QString&);
+            struct ImportDef {
+                  const char* extension;
+                  ImportFunction importF;
+                  };
+            static const ImportDef imports[] = {
+                  { "xml",  &importMusicXml           },
+                  { "mxl",  &importCompressedMusicXml },
+                  { "mid",  &importMidi               },
+                  { "midi", &importMidi               },
+                  { "kar",  &importMidi               },
+                  { "mgu",  &importBB                 },
+                  { "sgu",  &importBB                 },
+                  { "cap",  &importCapella            },
+                  { "capx", &importCapXml             },
+                  };
+            if (score->style()->value(ST_chordsXmlFile).toBool())
+                  score->style()->chordList()->read("chords.xml");
+            score->style()->chordList()->read(score->style()->valueSt(ST_chordDescriptionFile));
+
+            rv = Score::FILE_UNKNOWN_TYPE;
+            for (const ImportDef& i : imports) {
+                  if (i.extension == csl) {
+                        rv = (*i.importF)(score, name);
+                        break;
+                        }
+                  }
+            if (rv == Score::FILE_NO_ERROR)
+                  score->connectTies();
+            }
+      if (rv != Score::FILE_NO_ERROR) {
+            fprintf(stderr, "cannot read <%s>: %s\n", qPrintable(name), qPrintable(MScore::lastError));
+            delete score;
+            return 0;
+            }
+      score->rebuildMidiMapping();
+      score->updateNotes();
+      return score;
+      }
+
+//---------------------------------------------------------
+//   savePdf
+//---------------------------------------------------------
+
+static bool savePdf(Score* score, const QString& name)
+      {
+      const PageFormat* pf = score->pageFormat();
+      QPdfWriter writer(name);
+      writer.setResolution(1200);
+      writer.setPageSizeMM(QSizeF(pf->size()) * INCH);
+      writer.setPageMargins(QMarginsF());
+      writer.setCreator("MuseScore Version: " VERSION);
+      writer.setTitle(score->name());
+
+      score->setPrinting(true);
+      QPainter p(&writer);
+      p.setRenderHint(QPainter::Antialiasing, true);
+      p.setRenderHint(QPainter::TextAntialiasing, true);
+      double mag = writer.logicalDpiX() / MScore::DPI;
+      p.scale(mag, mag);
+
+      for (int n = 0; n < score->pages().size(); ++n) {
+            if (n)
+                  writer.newPage();
+            score->print(&p, n);
+            }
+      p.end();
+      score->setPrinting(false);
+      return true;
+      }
+
+//---------------------------------------------------------
+//   savePng
+//    one file per page: name-<page>.png
+//---------------------------------------------------------
+
+static bool savePng(Score* score, const QString& name)
+      {
+      score->setPrinting(true);
+      const QList<Page*>& pl = score->pages();
+      int pages   = pl.size();
+      int padding = QString("%1").arg(pages).size();
+      QString base(name.left(name.size() - 4));
+      double mag  = converterDpi / MScore::DPI;
+      bool rv     = true;
+
+      for (int pageNumber = 0; pageNumber < pages; ++pageNumber) {
+            Page* page = pl.at(pageNumber);
+            QRectF r   = page->abbox();
+            QImage image(lrint(r.width() * mag), lrint(r.height() * mag), QImage::Format_ARGB32_Premultiplied);
+            image.setDotsPerMeterX(lrint((converterDpi * 1000) / INCH));
+            image.setDotsPerMeterY(lrint((converterDpi * 1000) / INCH));
+            image.fill(0);
+
+            QPainter p(&image);
+            p.setRenderHint(QPainter::Antialiasing, true);
+            p.setRenderHint(QPainter::TextAntialiasing, true);
+            p.scale(mag, mag);
+            score->print(&p, pageNumber);
+            p.end();
+
+            QString fileName = base + QString("-%1.png").arg(pageNumber+1, padding, 10, QLatin1Char('0'));
+            rv = image.save(fileName, "png");
+            if (!rv)
+                  break;
+            }
+      score->setPrinting(false);
+      return rv;
+      }
+
+//---------------------------------------------------------
+//   saveSvg
+//---------------------------------------------------------
+
+static bool saveSvg(Score* score, const QString& name)
+      {
+      SvgGenerator printer;
+      printer.setResolution(converterDpi);
+      QString title(score->metaTag("workTitle"));
+      if (title.isEmpty())
+            title = "MuseScore";
+      printer.setTitle(title);
+      printer.setDescription(QString("Generated by MuseScore %1").arg(VERSION));
+      printer.setFileName(name);
+      const PageFormat* pf = score->pageFormat();
+      double mag = converterDpi / MScore::DPI;
+
+      qreal w = pf->width() * MScore::DPI * score->pages().size();
+      qreal h = pf->height() * MScore::DPI;
+      printer.setSize(QSize(w * mag, h * mag));
+      printer.setViewBox(QRectF(0.0, 0.0, w * mag, h * mag));
+
+      score->setPrinting(true);
+      QPainter p(&printer);
+      p.setRenderHint(QPainter::Antialiasing, true);
+      p.setRenderHint(QPainter::TextAntialiasing, true);
+      p.scale(mag, mag);
+      for (int n = 0; n < score->pages().size(); ++n) {
+            score->print(&p, n);
+            p.translate(QPointF(pf->width() * MScore::DPI, 0.0));
+            }
+      p.end();
+      score->setPrinting(false);
+      return true;
+      }
+
+//---------------------------------------------------------
+//   convert
+//---------------------------------------------------------
+
+static bool convert(Score* cs, const QString& fn)
+      {
+      cs->ensureLayout();
+      QFileInfo fi(fn);
+      QString suffix = fi.suffix().toLower();
+      try {
+            if (suffix == "mscx")
+                  return cs->saveFile(fi);
+            if (suffix == "mscz") {
+                  cs->saveCompressedFile(fi, false);
+                  return true;
+                  }
+            }
+      catch (QString s) {
+            fprintf(stderr, "save failed: %s\n", qPrintable(s));
+            return false;
+            }
+      if (suffix == "xml")
+            return saveXml(cs, fn);
+      if (suffix == "mxl")
+            return saveMxl(cs, fn);
+      if (suffix == "mid") {
+            ExportMidi em(cs);
+            return em.write(fn, preferences.midiExpandRepeats);
+            }
+      if (suffix == "pdf")
+            return savePdf(cs, fn);
+      if (suffix == "png")
+            return savePng(cs, fn);
+      if (suffix == "svg")
+            return saveSvg(cs, fn);
+      if (suffix == "pos")
+            return savePositions(cs, fn);
+      fprintf(stderr, "dont know how to convert to %s\n", qPrintable(fn));
+      return false;
+      }
+
+}
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   main
+//---------------------------------------------------------
+
+int main(int argc, char* argv[])
+      {
+      QElapsedTimer timer;
+      timer.start();
+
+      // no window system is needed; fonts and painting work
+      // with the offscreen platform
+      if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+      QGuiApplication app(argc, argv);
+      QCoreApplication::setOrganizationName("MuseScore");
+      QCoreApplication::setOrganizationDomain("musescore.org");
+      QCoreApplication::setApplicationName("MuseScoreConverter");
+
+      QStringList args = QCoreApplication::arguments();
+      args.removeFirst();
+
+      bool timing = false;
+      QString styleFile;
+      while (!args.isEmpty() && args[0].startsWith("-") && args[0].size() == 2) {
+            QString s = args.takeFirst();
+            switch (s[1].toLatin1()) {
+                  case 'S':
+                        if (args.isEmpty())
+                              usage();
+                        styleFile = args.takeFirst();
+                        break;
+                  case 'r':
+                        if (args.isEmpty())
+                              usage();
+                        converterDpi = args.takeFirst().toDouble();
+                        break;
+                  case 't':
+                        timing = true;
+                        break;
+                  case 'd':
+                        MScore::debugMode = true;
+                        break;
+                  default:
+                        usage();
+                  }
+            }
+      if (args.size() != 2)
+            usage();
+
+#ifndef Q_OS_WIN
+      setenv("LANG", "C", 1);
+#endif
+      QLocale::setDefault(QLocale(QLocale::C));
+
+      MScore::PDPI = 120;
+      MScore::DPI  = MScore::PDPI;
+      MScore::DPMM = MScore::DPI / INCH;
+      MScore::init();
+      initPreferences();
+      if (converterDpi == 0)
+            converterDpi = preferences.pngResolution;
+      loadInstrumentTemplates(":/data/instruments.xml");
+
+      qint64 startup = timer.elapsed();
+
+      Score* score = readScore(args[0]);
+      if (score == 0)
+            return -1;
+      if (!styleFile.isEmpty()) {
+            QFile f(styleFile);
+            if (f.open(QIODevice::ReadOnly))
+                  score->style()->load(&f);
+            }
+      score->doLayout();
+      bool rv = convert(score, args[1]);
+
+      if (timing)
+            fprintf(stderr, "startup %lld ms, conversion %lld ms\n", startup, timer.elapsed() - startup);
+      delete score;
+      return rv ? 0 : -1;
+      }
+
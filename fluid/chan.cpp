@@ -222,6 +222,8 @@ void Channel::setPreset(Preset* p)
       if (_preset != p) {
             if (p)
                   p->loadSamples();
+            if (_preset)
+                  _preset->releaseSamples();
             _preset = p;
             }
       }
@@ -69,7 +69,7 @@ static const Mod defaultMod[] = {
 //---------------------------------------------------------
 
 Fluid::Fluid()
-   : Synthesizer()
+   : Synthesizer(), voiceAlloc(FLUID_MAX_VOICES, FLUID_MAX_CHANNEL)
       {
       }
 
@@ -96,8 +96,11 @@ void Fluid::init(float sampleRate)
             _tuning[i] = i * 100.0;
       _masterTuning = 440.0;
 
-      for (int i = 0; i < 512; i++)
-            freeVoices.append(new Voice(this));
+      for (int i = 0; i < FLUID_MAX_VOICES; i++) {
+            Voice* v = new Voice(this, i);
+            voices.append(v);
+            freeVoices.append(v);
+            }
       }
 
 //---------------------------------------------------------
@@ -125,8 +128,11 @@ Fluid::~Fluid()
 
 void Fluid::freeVoice(Voice* v)
       {
-      if (activeVoices.removeOne(v))
+      if (activeVoices.removeOne(v)) {
+            voiceAlloc.remove(v->index);
+            v->sample->release();
             freeVoices.append(v);
+            }
       }
 
 //---------------------------------------------------------
@@ -340,6 +346,21 @@ Preset* Fluid::find_preset(unsigned banknum, unsigned prognum)
       return preset;
       }
 
+//---------------------------------------------------------
+//   loadProgram
+//    decode the compressed samples of the preset now, so
+//    that the program change in the audio thread finds
+//    them ready; sound fonts are only loaded and removed
+//    from the gui thread, too
+//---------------------------------------------------------
+
+void Fluid::loadProgram(int bank, int program)
+      {
+      Preset* preset = find_preset(bank, program);
+      if (preset)
+            preset->prefetchSamples();
+      }
+
 //---------------------------------------------------------
 //   program_change
 //---------------------------------------------------------
@@ -451,75 +472,86 @@ void Fluid::process(unsigned len, float* out, float* effect1, float* effect2)
                   v->write(len, out, effect1, effect2);
             mutex.unlock();
             }
+      voiceAlloc.endBlock();
       }
 
-/*
- * fluid_synth_free_voice_by_kill
- *
- * selects a voice for killing. the selection algorithm is a refinement
- * of the algorithm previously in fluid_synth_alloc_voice.
- */
+//---------------------------------------------------------
+//   voicePriority
+//    Determine, how 'important' a voice is. The voice with
+//    the lowest priority is killed first.
+//---------------------------------------------------------
 
-void Fluid::free_voice_by_kill()
+double Fluid::voicePriority(const Voice* v) const
       {
-      float best_prio = 999999.;
-      float this_voice_prio;
-      Voice* best_voice = 0;
-
-      foreach(Voice* v, activeVoices) {
-            /* Determine, how 'important' a voice is.
-             * Start with an arbitrary number */
-            this_voice_prio = 10000.;
-
-            /* Is this voice on the drum channel?
-             * Then it is very important.
-             * Also, forget about the released-note condition:
-             * Typically, drum notes are triggered only very briefly, they run most
-             * of the time in release phase.
+      /* Start with an arbitrary number */
+      double prio = 10000.;
+
+      /* Is this voice on the drum channel?
+       * Then it is very important.
+       * Also, forget about the released-note condition:
+       * Typically, drum notes are triggered only very briefly, they run most
+       * of the time in release phase.
+       */
+      if (v->chan == 9)
+            prio += 4000;
+      else if (v->RELEASED()) {
+            /* The key for this voice has been released. Consider it much less important
+             * than a voice, which is still held.
              */
-            if (v->chan == 9) {
-                  this_voice_prio += 4000;
+            prio -= 2000.;
+            }
 
-                  }
-            else if (v->RELEASED()) {
-                  /* The key for this voice has been released. Consider it much less important
-                  * than a voice, which is still held.
-                  */
-                  this_voice_prio -= 2000.;
-                  }
+      if (v->SUSTAINED()) {
+            /* The sustain pedal is held down on this channel.
+             * Consider it less important than non-sustained channels.
+             * This decision is somehow subjective. But usually the sustain pedal
+             * is used to play 'more-voices-than-fingers', so it shouldn't hurt
+             * if we kill one voice.
+             */
+            prio -= 1000;
+            }
 
-            if (v->SUSTAINED()) {
-              /* The sustain pedal is held down on this channel.
-               * Consider it less important than non-sustained channels.
-               * This decision is somehow subjective. But usually the sustain pedal
-               * is used to play 'more-voices-than-fingers', so it shouldn't hurt
-               * if we kill one voice.
-               */
-                  this_voice_prio -= 1000;
-                  }
+      /* We are not enthusiastic about releasing voices, which have just been started.
+       * Otherwise hitting a chord may result in killing notes belonging to that very same
+       * chord.
+       * An older voice is just a little bit less important than a younger voice.
+       * The original algorithm subtracts the age (noteid - id); noteid is the same
+       * for all voices, so adding the id gives the same order and the priority
+       * does not change when other notes are started.
+       */
+      prio += v->get_id();
+
+      /* take a rough estimate of loudness into account. Louder voices are more important.
+       * The value is taken when the envelope section changes.
+       */
+      if (v->volenv_section != FLUID_VOICE_ENVATTACK)
+            prio += v->volenv_val * 1000.;
+      return prio;
+      }
 
-            /* We are not enthusiastic about releasing voices, which have just been started.
-             * Otherwise hitting a chord may result in killing notes belonging to that very same
-             * chord.
-             * So subtract the age of the voice from the priority - an older voice is just a little
-             * bit less important than a younger voice.
-             * This is a number between roughly 0 and 100.*/
+//---------------------------------------------------------
+//   updateVoice
+//    called when the state of an active voice changes
+//---------------------------------------------------------
 
-            this_voice_prio -= (noteid - v->get_id());
+void Fluid::updateVoice(Voice* v)
+      {
+      voiceAlloc.update(v->index, voicePriority(v));
+      }
 
-            /* take a rough estimate of loudness into account. Louder voices are more important. */
-            if (v->volenv_section != FLUID_VOICE_ENVATTACK) {
-                  this_voice_prio += v->volenv_val * 1000.;
-                  }
+//---------------------------------------------------------
+//   free_voice_by_kill
+//    kill the least important voice if chan has reached
+//    its polyphony limit or all voices are in use
+//---------------------------------------------------------
 
-            /* check if this voice has less priority than the previous candidate. */
-            if (this_voice_prio < best_prio) {
-                  best_voice = v;
-                  best_prio = this_voice_prio;
-                  }
-            }
-      if (best_voice)
-            best_voice->off();
+void Fluid::free_voice_by_kill(int chan)
+      {
+      int idx = voiceAlloc.victim(chan);
+      if (idx == -1)
+            return;
+      voices[idx]->off();
+      voiceAlloc.stolen();
       }
 
 //---------------------------------------------------------
@@ -531,8 +563,7 @@ Voice* Fluid::alloc_voice(unsigned id, Sample* sample, int chan, int key, int ve
       Channel* c = 0;
 
       /* check if there's an available synthesis process */
-      if (freeVoices.isEmpty())
-            free_voice_by_kill();
+      free_voice_by_kill(chan);
 
       if (freeVoices.isEmpty()) {
             qDebug("Failed to allocate a synthesis process. (chan=%d,key=%d)", chan, key);
@@ -546,6 +577,8 @@ Voice* Fluid::alloc_voice(unsigned id, Sample* sample, int chan, int key, int ve
             c = channel[chan];
 
       v->init(sample, c, key, vel, id, vt);
+      sample->acquire();
+      voiceAlloc.add(v->index, v->chan, voicePriority(v));
 
       /* add the default modulators to the synthesis process. */
       for (unsigned i = 0; i < sizeof(defaultMod)/sizeof(*defaultMod); ++i)
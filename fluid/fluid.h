@@ -24,6 +24,7 @@
 
 #include "synthesizer/synthesizer.h"
 #include "synthesizer/midipatch.h"
+#include "synthesizer/voicealloc.h"
 
 namespace FluidS {
 
@@ -294,13 +295,18 @@ enum {
 //   Fluid
 //---------------------------------------------------------
 
+static const int FLUID_MAX_VOICES  = 512;
+static const int FLUID_MAX_CHANNEL = 256;       // Voice::chan is an unsigned char
+
 class Fluid : public Synthesizer {
       QList<SFont*> sfonts;               // the loaded soundfonts
       QList<BankOffset*> bank_offsets;    // the offsets of the soundfont banks
       QList<MidiPatch*> patches;
 
+      QVector<Voice*> voices;             // all synthesis processes, by Voice::index
       QList<Voice*> freeVoices;           // unused synthesis processes
       QList<Voice*> activeVoices;         // active synthesis processes
+      VoiceAllocator voiceAlloc;          // active voices ordered by priority for stealing
       QString _error;                     // last error message
 
       static bool initialized;
@@ -311,6 +317,7 @@ class Fluid : public Synthesizer {
 
       QMutex mutex;
       void updatePatchList();
+      double voicePriority(const Voice*) const;
 
    protected:
       int _state;                         // the synthesizer state
@@ -338,6 +345,7 @@ class Fluid : public Synthesizer {
       virtual const char* name() const { return "Fluid"; }
 
       virtual void play(const PlayEvent&);
+      virtual void loadProgram(int bank, int program);
       virtual const QList<MidiPatch*>& getPatchInfo() const { return patches; }
 
       // get/set synthesizer state (parameter set)
@@ -384,7 +392,10 @@ class Fluid : public Synthesizer {
 
       void start_voice(Voice* voice);
       Voice* alloc_voice(unsigned id, Sample* sample, int chan, int key, int vel, double vt);
-      void free_voice_by_kill();
+      void free_voice_by_kill(int chan);
+      void updateVoice(Voice*);
+      void setPolyphony(int chan, int voices) { voiceAlloc.setPolyphony(chan, voices); }
+      virtual int stolenVoices() const        { return voiceAlloc.blockSteals(); }
 
       virtual void process(unsigned len, float* out, float* effect1, float* effect2);
 
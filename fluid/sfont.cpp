@@ -49,9 +49,10 @@ SFVersion::SFVersion()
 
 SFont::SFont(Fluid* f)
       {
-      synth      = f;
-      samplepos  = 0;
-      samplesize = 0;
+      synth       = f;
+      samplepos   = 0;
+      samplesize  = 0;
+      _sampleData = 0;
       }
 
 SFont::~SFont()
@@ -78,6 +79,7 @@ bool SFont::read(const QString& s)
       f.setFileName(s);
       if (!load())
             return false;
+      mapSamples();
 
       foreach(Instrument* i, instruments) {
             if (!i->import_sfont())
@@ -91,6 +93,34 @@ bool SFont::read(const QString& s)
       return true;
       }
 
+//---------------------------------------------------------
+//   mapSamples
+//    compressed samples are decoded on demand straight from
+//    the mapped sample chunk
+//---------------------------------------------------------
+
+void SFont::mapSamples()
+      {
+#ifdef SOUNDFONT3
+      bool compressed = false;
+      foreach (Sample* s, sample) {
+            if (s->compressed()) {
+                  compressed = true;
+                  break;
+                  }
+            }
+      if (!compressed || samplesize == 0)
+            return;
+      if (f.open(QIODevice::ReadOnly))
+            _sampleData = f.map(samplepos, samplesize);
+      if (!_sampleData) {
+            qDebug("fluid: cannot map samples of <%s>, reading them on demand", qPrintable(f.fileName()));
+            f.close();
+            }
+      SampleCache::instance();      // start the decoder outside of the audio thread
+#endif
+      }
+
 //---------------------------------------------------------
 //   get_preset
 //---------------------------------------------------------
@@ -128,30 +158,58 @@ Preset::~Preset()
       }
 
 //---------------------------------------------------------
-//   loadSamples
-//    this is called if the preset is associated with a
-//    channel
+//   visitSamples
+//    call fn for every sample of the preset
 //---------------------------------------------------------
 
-void Preset::loadSamples()
+void Preset::visitSamples(void (Sample::*fn)())
       {
-//      sfont->synth->mutex.lock();
       if (_global_zone && _global_zone->instrument) {
             Instrument* i = _global_zone->instrument;
             if (i->global_zone && i->global_zone->sample)
-                  i->global_zone->sample->load();
+                  (i->global_zone->sample->*fn)();
             foreach(Zone* iz, i->zones)
-                  iz->sample->load();
+                  (iz->sample->*fn)();
             }
 
       foreach(Zone* z, zones) {
             Instrument* i = z->instrument;
             if (i->global_zone && i->global_zone->sample)
-                  i->global_zone->sample->load();
+                  (i->global_zone->sample->*fn)();
             foreach(Zone* iz, i->zones)
-                  iz->sample->load();
+                  (iz->sample->*fn)();
             }
-//      sfont->synth->mutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   loadSamples
+//    this is called if the preset is associated with a
+//    channel; compressed samples are prefetched
+//---------------------------------------------------------
+
+void Preset::loadSamples()
+      {
+      visitSamples(&Sample::acquire);
+      }
+
+//---------------------------------------------------------
+//   releaseSamples
+//    the preset is no longer associated with a channel
+//---------------------------------------------------------
+
+void Preset::releaseSamples()
+      {
+      visitSamples(&Sample::release);
+      }
+
+//---------------------------------------------------------
+//   prefetchSamples
+//    decode compressed samples ahead of a program change
+//---------------------------------------------------------
+
+void Preset::prefetchSamples()
+      {
+      visitSamples(&Sample::prefetch);
       }
 
 //---------------------------------------------------------
@@ -180,6 +238,13 @@ bool Preset::noteon(Fluid* synth, unsigned id, int chan, int key, int vel, doubl
                         Sample* sample = inst_zone->get_sample();
                         if (sample == 0 || sample->inRom())
                               continue;
+                        if (!sample->ready()) {
+                              // still being decoded; playback does not wait for it
+#ifdef SOUNDFONT3
+                              ++SampleCache::misses;
+#endif
+                              continue;
+                              }
                         /* check if the note falls into the key and velocity range of this
                            instrument */
                         if (inst_zone->inside_range(key, vel) && (sample != 0)) {
@@ -584,6 +649,13 @@ Sample::Sample(SFont* s)
       pitchadj    = 0;
       sampletype  = 0;
       data        = 0;
+      ostart      = 0;
+      oend        = 0;
+      oloopstart  = 0;
+      oloopend    = 0;
+      nextQueued  = 0;
+      _state      = PCM_NONE;
+      _lastUse    = 0;
       amplitude_that_reaches_noise_floor_is_valid = false;
       amplitude_that_reaches_noise_floor = 0.0;
       }
@@ -594,66 +666,166 @@ Sample::Sample(SFont* s)
 
 Sample::~Sample()
       {
+#ifdef SOUNDFONT3
+      if (compressed())
+            SampleCache::instance()->remove(this);
+#endif
       delete[] data;
       }
 
 //---------------------------------------------------------
-//   load
+//   setPcm
 //---------------------------------------------------------
 
-void Sample::load()
+void Sample::setPcm(int pcm)
       {
-      if (!_valid || data)
+      int s = _state;
+      while (!_state.compare_exchange_weak(s, (s & ~PCM_MASK) | pcm))
+            ;
+      }
+
+//---------------------------------------------------------
+//   acquire
+//    called for the samples of the preset of a channel and
+//    for every voice which plays the sample
+//---------------------------------------------------------
+
+static std::atomic<unsigned> useClock(0);
+
+void Sample::acquire()
+      {
+      int s = _state.fetch_add(USER) + USER;
+      _lastUse = ++useClock;
+      if ((s & PCM_MASK) == PCM_READY || !_valid)
             return;
-      QFile fd(sf->get_name());
-      if (!fd.open(QIODevice::ReadOnly))
+      if (!compressed()) {
+            load();
             return;
-      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
-            if (!fd.seek(sf->samplePos() + start))
-                  return;
             }
-      else {
-            if (!fd.seek(sf->samplePos() + start * sizeof(short)))
-                  return;
+#ifdef SOUNDFONT3
+      if (Ms::AudioCallback::active()) {
+            // never decode inside the audio callback
+            while ((s & PCM_MASK) == PCM_NONE) {
+                  if (_state.compare_exchange_weak(s, (s & ~PCM_MASK) | PCM_QUEUED)) {
+                        SampleCache::instance()->request(this);
+                        break;
+                        }
+                  }
             }
-      unsigned int size = end - start;
+      else
+            SampleCache::instance()->load(this);
+#endif
+      }
+
+//---------------------------------------------------------
+//   release
+//---------------------------------------------------------
+
+void Sample::release()
+      {
+      _lastUse = ++useClock;
+      _state -= USER;
+      }
 
-      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
+//---------------------------------------------------------
+//   prefetch
+//    decode a compressed sample without becoming a user;
+//    never called inside the audio callback
+//---------------------------------------------------------
+
+void Sample::prefetch()
+      {
 #ifdef SOUNDFONT3
-            char* p = new char[size];
-            if (fd.read(p, size) != size) {
-                  printf("  read %d failed\n", size);
-                  return;
+      if (!compressed() || !_valid || ready())
+            return;
+      _lastUse = ++useClock;
+      SampleCache::instance()->load(this);
+#endif
+      }
+
+//---------------------------------------------------------
+//   evict
+//    free the pcm if the sample has no users; called
+//    by the SampleCache only
+//---------------------------------------------------------
+
+bool Sample::evict()
+      {
+      int s = PCM_READY;
+      if (!_state.compare_exchange_strong(s, PCM_NONE))
+            return false;
+      delete[] data;
+      data = 0;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   load
+//---------------------------------------------------------
+
+void Sample::load()
+      {
+      if (!_valid || data)
+            return;
+      if (compressed()) {
+#ifdef SOUNDFONT3
+            // a sample is decoded again after it was evicted
+            start     = ostart;
+            end       = oend;
+            loopstart = oloopstart;
+            loopend   = oloopend;
+            unsigned int size = end - start;
+            if (sf->sampleData())
+                  decompressOggVorbis((const char*)sf->sampleData() + start, size);
+            else {
+                  QFile fd(sf->get_name());
+                  if (!fd.open(QIODevice::ReadOnly) || !fd.seek(sf->samplePos() + start))
+                        return;
+                  QByteArray ba = fd.read(size);
+                  if (unsigned(ba.size()) != size) {
+                        printf("  read %d failed\n", size);
+                        return;
+                        }
+                  decompressOggVorbis(ba.constData(), size);
+                  }
+            if (data) {
+                  optimize();
+                  setPcm(PCM_READY);
                   }
-            decompressOggVorbis(p, size);
-            delete[] p;
 #endif
+            return;
             }
-      else {
-            data = new short[size];
-            size *= sizeof(short);
-
-            if (fd.read((char*)data, size) != size)
-                  return;
-
-            if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
-                  unsigned char hi, lo;
-                  unsigned int i, j;
-                  short s;
-                  uchar* cbuf = (uchar*) data;
-                  for (i = 0, j = 0; j < size; i++) {
-                        lo = cbuf[j++];
-                        hi = cbuf[j++];
-                        s = (hi << 8) | lo;
-                        data[i] = s;
-                        }
+      QFile fd(sf->get_name());
+      if (!fd.open(QIODevice::ReadOnly))
+            return;
+      if (!fd.seek(sf->samplePos() + start * sizeof(short)))
+            return;
+      unsigned int size = end - start;
+
+      data = new short[size];
+      size *= sizeof(short);
+
+      if (fd.read((char*)data, size) != size)
+            return;
+
+      if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
+            unsigned char hi, lo;
+            unsigned int i, j;
+            short s;
+            uchar* cbuf = (uchar*) data;
+            for (i = 0, j = 0; j < size; i++) {
+                  lo = cbuf[j++];
+                  hi = cbuf[j++];
+                  s = (hi << 8) | lo;
+                  data[i] = s;
                   }
-            end       -= (start + 1);       // marks last sample, contrary to SF spec.
-            loopstart -= start;
-            loopend   -= start;
-            start      = 0;
             }
+      end       -= (start + 1);       // marks last sample, contrary to SF spec.
+      loopstart -= start;
+      loopend   -= start;
+      start      = 0;
       optimize();
+      setPcm(PCM_READY);
       }
 
 //---------------------------------------------------------
@@ -1615,6 +1787,10 @@ void SFont::load_shdr (int size)
                   }
             p->setValid(true);
             if (p->sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
+                  p->ostart     = p->start;
+                  p->oend       = p->end;
+                  p->oloopstart = p->loopstart;
+                  p->oloopend   = p->loopend;
                   }
             else {
                   // loop is fowled?? (cluck cluck :)
@@ -25,6 +25,7 @@
 
 #include "config.h"
 #include "fluid.h"
+#include <atomic>
 
 namespace FluidS {
 
@@ -54,6 +55,7 @@ class SFont {
       QFile f;
       unsigned samplepos;           // the position in the file at which the sample data starts
       unsigned samplesize;          // the size of the sample data
+      const uchar* _sampleData;     // sample data mapped into memory (sf3) or 0
 
       QList<Instrument*> instruments;
       QList<Preset*> presets;
@@ -96,6 +98,7 @@ class SFont {
       void safe_fread(void *buf, int count);
       void safe_fseek(long ofs);
       bool load();
+      void mapSamples();
 
    public:
       SFont(Fluid* f);
@@ -113,6 +116,7 @@ class SFont {
       void setSamplepos(unsigned v)             { samplepos = v; }
       void setSamplesize(unsigned v)            { samplesize = v; }
       unsigned getSamplesize() const            { return samplesize; }
+      const uchar* sampleData() const           { return _sampleData; }
       const QList<Preset*> getPresets() const   { return presets; }
       SFVersion version() const                 { return _version; }
       friend class Preset;
@@ -123,9 +127,23 @@ class SFont {
 //---------------------------------------------------------
 
 class Sample {
-      bool _valid;
+      std::atomic<bool> _valid;     // cleared by the decoder thread
+
+      // users (channel presets and voices) << 2 | pcm state; the
+      // pcm of a compressed sample is only freed without users
+      std::atomic<int> _state;
+      std::atomic<unsigned> _lastUse;
+
+      void setPcm(int);
 
    public:
+      enum { PCM_NONE, PCM_QUEUED, PCM_READY, PCM_MASK = 3, USER = 4 };
+
+      // position of a compressed sample in the sound font; start,
+      // end and the loop are pcm positions once it is decoded
+      unsigned int ostart, oend, oloopstart, oloopend;
+      Sample* nextQueued;           // SampleCache request stack
+
       SFont* sf;
       unsigned int start;
       unsigned int end;
@@ -154,11 +172,59 @@ class Sample {
       void load();
       bool valid() const    { return _valid; }
       void setValid(bool v) { _valid = v; }
+
+      bool compressed() const  { return sampletype & FLUID_SAMPLETYPE_OGG_VORBIS; }
+      bool ready() const       { return (_state & PCM_MASK) == PCM_READY; }
+      int users() const        { return _state >> 2; }
+      unsigned lastUse() const { return _lastUse; }
+      void acquire();
+      void release();
+      void prefetch();
+      bool evict();
 #ifdef SOUNDFONT3
-      bool decompressOggVorbis(char* p, int size);
+      bool decompressOggVorbis(const char* p, int size);
 #endif
       };
 
+#ifdef SOUNDFONT3
+//---------------------------------------------------------
+//   SampleCache
+//    Decoded pcm of compressed (sf3) samples, shared by all
+//    Fluid instances. A sample is decoded when the preset of
+//    a channel first uses it; inside an audio callback the
+//    request is pushed lock free for the polling decoder
+//    thread.
+//    Samples without users are freed least recently used
+//    first once the cache exceeds its limit.
+//---------------------------------------------------------
+
+class SampleCache : public QThread {
+      std::atomic<Sample*> requests;      // lock free stack, pushed by any thread
+      QMutex mutex;                       // serializes decoding and removal
+      QList<Sample*> pending;
+      QList<Sample*> decoded;
+      qint64 _size;                       // bytes of decoded pcm
+      qint64 _limit;
+
+      SampleCache();
+      virtual void run();
+      void takeRequests();
+      void decode(Sample*);
+      void evict();
+
+   public:
+      static SampleCache* instance();
+      static std::atomic<int> misses;     // notes not played because the pcm was not ready
+
+      void request(Sample*);
+      void load(Sample*);
+      void remove(Sample*);
+      void setLimit(qint64 bytes);
+      qint64 limit() const                { return _limit; }
+      qint64 size() const                 { return _size;  }
+      };
+#endif
+
 //---------------------------------------------------------
 //   Zone
 //---------------------------------------------------------
@@ -232,7 +298,10 @@ class Preset {
       bool importSfont();
 
       Zone* global_zone()                       { return _global_zone; }
+      void visitSamples(void (Sample::*)());
       void loadSamples();
+      void releaseSamples();
+      void prefetchSamples();
       QList<Zone*> getZones()                   { return zones; }
       };
 
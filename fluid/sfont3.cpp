@@ -10,10 +10,10 @@ namespace FluidS {
 //   decompressOggVorbis
 //---------------------------------------------------------
 
-bool Sample::decompressOggVorbis(char* src, int size)
+bool Sample::decompressOggVorbis(const char* src, int size)
       {
       AudioFile af;
-      QByteArray ba(src, size);
+      QByteArray ba = QByteArray::fromRawData(src, size);
 
       start = 0;
       end   = 0;
@@ -48,4 +48,164 @@ bool Sample::decompressOggVorbis(char* src, int size)
 
       return true;
       }
+
+//---------------------------------------------------------
+//   SampleCache
+//---------------------------------------------------------
+
+static const qint64 DEFAULT_CACHE_LIMIT = 256 * 1024 * 1024;
+
+std::atomic<int> SampleCache::misses(0);
+
+SampleCache::SampleCache()
+      {
+      requests = 0;
+      _size    = 0;
+      _limit   = DEFAULT_CACHE_LIMIT;
+      start(QThread::LowPriority);
+      }
+
+//---------------------------------------------------------
+//   instance
+//    the cache lives until the program ends
+//---------------------------------------------------------
+
+SampleCache* SampleCache::instance()
+      {
+      static SampleCache* cache = new SampleCache;
+      return cache;
+      }
+
+//---------------------------------------------------------
+//   request
+//    queue s for decoding; called from the audio thread,
+//    so it only pushes onto the lock free stack, which
+//    the decoder thread polls
+//---------------------------------------------------------
+
+void SampleCache::request(Sample* s)
+      {
+      Sample* head = requests;
+      do {
+            s->nextQueued = head;
+            } while (!requests.compare_exchange_weak(head, s));
+      }
+
+//---------------------------------------------------------
+//   takeRequests
+//    move the request stack to pending in request order;
+//    mutex must be locked
+//---------------------------------------------------------
+
+void SampleCache::takeRequests()
+      {
+      Sample* s = requests.exchange(0);
+      int n = pending.size();
+      for (; s; s = s->nextQueued)
+            pending.insert(n, s);
+      }
+
+//---------------------------------------------------------
+//   decode
+//    mutex must be locked
+//---------------------------------------------------------
+
+void SampleCache::decode(Sample* s)
+      {
+      if (s->ready())
+            return;
+      s->load();
+      if (s->ready()) {
+            _size += (s->end + 1) * sizeof(short);
+            decoded.append(s);
+            }
+      }
+
+//---------------------------------------------------------
+//   load
+//    decode s now; called outside of the audio thread
+//---------------------------------------------------------
+
+void SampleCache::load(Sample* s)
+      {
+      QMutexLocker locker(&mutex);
+      decode(s);
+      evict();
+      }
+
+//---------------------------------------------------------
+//   remove
+//    forget s before it is deleted
+//---------------------------------------------------------
+
+void SampleCache::remove(Sample* s)
+      {
+      QMutexLocker locker(&mutex);
+      takeRequests();
+      pending.removeAll(s);
+      if (decoded.removeOne(s))
+            _size -= (s->end + 1) * sizeof(short);
+      }
+
+//---------------------------------------------------------
+//   setLimit
+//---------------------------------------------------------
+
+void SampleCache::setLimit(qint64 bytes)
+      {
+      QMutexLocker locker(&mutex);
+      _limit = bytes;
+      evict();
+      }
+
+//---------------------------------------------------------
+//   evict
+//    free samples without users, least recently used
+//    first, until the cache fits its limit;
+//    mutex must be locked
+//---------------------------------------------------------
+
+void SampleCache::evict()
+      {
+      if (_size <= _limit)
+            return;
+      QList<QPair<unsigned, Sample*> > lru;
+      foreach (Sample* s, decoded) {
+            if (s->users() == 0)
+                  lru.append(qMakePair(s->lastUse(), s));
+            }
+      qSort(lru);
+      for (int i = 0; i < lru.size() && _size > _limit; ++i) {
+            Sample* s = lru[i].second;
+            qint64 bytes = (s->end + 1) * sizeof(short);
+            if (s->evict()) {
+                  decoded.removeOne(s);
+                  _size -= bytes;
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   run
+//    decoder thread; polls the request stack, since
+//    waking a wait condition would lock a mutex in the
+//    audio thread
+//---------------------------------------------------------
+
+void SampleCache::run()
+      {
+      static const int POLL_INTERVAL = 5;  // ms
+
+      for (;;) {
+            mutex.lock();
+            takeRequests();
+            while (!pending.isEmpty())
+                  decode(pending.takeFirst());
+            evict();
+            mutex.unlock();
+            if (requests == 0)
+                  msleep(POLL_INTERVAL);
+            }
+      }
+
 } // namespace
@@ -54,9 +54,10 @@ namespace FluidS {
 //   Voice
 //---------------------------------------------------------
 
-Voice::Voice(Fluid* f)
+Voice::Voice(Fluid* f, int idx)
       {
       _fluid  = f;
+      index   = idx;
       status  = FLUID_VOICE_OFF;
       chan    = NO_CHANNEL;
       key     = 0;
@@ -227,6 +228,7 @@ void Voice::write(unsigned n, float* out, float* reverb, float* chorus)
 
       /******************* vol env **********************/
 
+      int section = volenv_section;
       env_data = &volenv_data[volenv_section];
 
       /* skip to the next section of the envelope if necessary */
@@ -259,6 +261,8 @@ void Voice::write(unsigned n, float* out, float* reverb, float* chorus)
             off();
             return;
             }
+      if (volenv_section != section)
+            _fluid->updateVoice(this);
 
       fluid_check_fpe ("voice_write vol env");
 
@@ -1284,6 +1288,7 @@ void Voice::noteoff()
             modenv_section = FLUID_VOICE_ENVRELEASE;
             modenv_count = 0;
             }
+      _fluid->updateVoice(this);
       }
 
 /*
@@ -1324,6 +1329,7 @@ void Voice::kill_excl()
       /* Speed up the modulation envelope */
       gen_set(GEN_MODENVRELEASE, -200);
       update_param(GEN_MODENVRELEASE);
+      _fluid->updateVoice(this);
       }
 
 //---------------------------------------------------------
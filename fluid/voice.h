@@ -73,6 +73,7 @@ class Voice
       void effects(int count, float* out, float* effect1, float* effect2);
 
    public:
+	int index;                      // position in Fluid::voices
 	unsigned int id;                // the id is incremented for every new noteon.
 					        // it's used for noteoff's
 	unsigned char status;
@@ -188,7 +189,7 @@ class Voice
 	double ref;
 
    public:
-      Voice(Fluid*);
+      Voice(Fluid*, int index);
       Channel* get_channel() const    { return channel; }
       void voice_start();
       void off();
@@ -25,14 +25,17 @@ class XmlReader;
 class Audio {
       QString _path;
       QByteArray _data;
+      QByteArray _peaks;      // cached waveform peaks, format owned by WaveView
 
    public:
       Audio();
-      const QString& path() const        { return _path; }
-      void setPath(const QString& s)     { _path = s;    }
-      const QByteArray& data() const     { return _data; }
-      QByteArray data()                  { return _data; }
-      void setData(const QByteArray& ba) { _data = ba;   }
+      const QString& path() const         { return _path;  }
+      void setPath(const QString& s)      { _path = s;     }
+      const QByteArray& data() const      { return _data;  }
+      QByteArray data()                   { return _data;  }
+      void setData(const QByteArray& ba)  { _data = ba; _peaks.clear(); }
+      const QByteArray& peaks() const     { return _peaks; }
+      void setPeaks(const QByteArray& ba) { _peaks = ba;   }
 
       void read(XmlReader&);
       void write(Xml&) const;
@@ -43,6 +43,8 @@ namespace Ms {
 struct BeamFragment {
       qreal py1[2];
       qreal py2[2];
+      QVector<qreal> key;     // inputs and result of last
+      char l, s;              // stem length search
       };
 
 //---------------------------------------------------------
@@ -1101,27 +1103,23 @@ static int* slantTable(uint interval)
       }
 
 //---------------------------------------------------------
-//   computeStemLen
+//   searchBeamMetric
+//    find stem length of the first chord and slant of a
+//    beam which satisfy the beam placement rules
 //---------------------------------------------------------
 
-void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevels)
+static Bm searchBeamMetric(const QList<ChordRest*>& cl, bool up, bool zeroSlant, int beamLevels, qreal _spStaff4)
       {
-      qreal _spatium      = spatium();
-      qreal _spatium4     = _spatium * .25;
-      qreal _spStaff4     = _spatium4 * staff()->lineDistance();  // scaled to staff line distance for vert. pos. within a staff
       const ChordRest* c1 = cl.front();
       const ChordRest* c2 = cl.back();
-      qreal dx            = c2->pagePos().x() - c1->pagePos().x();
       bool grace          = c1->isGrace();
 
-      bool zeroSlant  = noSlope(cl);
-
       int l1 = c1->line() * 2;
       int l2 = c2->line() * 2;
 
       Bm bm;
       if (beamLevels == 1) {
-            bm = beamMetric1(_up, l1 / 2, l2 / 2);
+            bm = beamMetric1(up, l1 / 2, l2 / 2);
 
             if (grace && bm.l) {
                   if (bm.l > 0)
@@ -1132,7 +1130,7 @@ void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevel
 
             if (bm.l && !(zeroSlant && cl.size() > 2)) {
                   if (cl.size() > 2) {
-                        if (_up)
+                        if (up)
                               bm.l = -12 - adjust(_spStaff4, bm.s, cl);
                         else
                               bm.l = 12 + adjust(_spStaff4, bm.s, cl);
@@ -1142,7 +1140,7 @@ void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevel
             else {
                   int* st = slantTable(zeroSlant ? 0 : qAbs((l2 - l1) / 2));
                   int ll1;
-                  if (_up) {
+                  if (up) {
                         ll1 = l1 - ((l1 & 3) ? 11 : 12);
                         int ll1m = l1 - 10;
                         int rll1 = ll1;
@@ -1225,7 +1223,7 @@ void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevel
                   maxS          = maxSlant(interval);
                   }
             int ll1;
-            if (_up) {
+            if (up) {
                   ll1 = l1 - 12;     // sp minimum to primary beam
                   int rll1 = ll1;
                   if ((l1 > 20) && (l2 > 20)) {
@@ -1302,13 +1300,13 @@ void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevel
             int slant;
             bool outside;
             if (zeroSlant) {
-                  outside = (_up && qMin(l1, l2) <= 10) ||
-                     (!_up && qMax(l1, l2) >= 6);
+                  outside = (up && qMin(l1, l2) <= 10) ||
+                     (!up && qMax(l1, l2) >= 6);
                   slant = 0;
                   }
             else {
-                  outside = (_up && (l1 <= 10) && (l2 <= 10)) ||
-                     (!_up && (l1 >= 6) && (l2 >= 6));
+                  outside = (up && (l1 <= 10) && (l2 <= 10)) ||
+                     (!up && (l1 >= 6) && (l2 >= 6));
                   if (outside)
                         slant = *slantTable(qAbs(l1-l2) / 2);
                   else
@@ -1317,7 +1315,7 @@ void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevel
                         slant = -slant;
                   }
             int ll1;
-            if (_up) {
+            if (up) {
                   static const int t[4] = { 3, 0, 1, 2 };
                   ll1 = l1 - 15 - adjust(_spStaff4, slant, cl);
                   ll1 = qMin(ll1, 5);
@@ -1336,7 +1334,7 @@ void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevel
       else if (beamLevels == 4) {
             int slant = zeroSlant ? 0 : (l2 > l1 ? 4 : -4);
             int ll1;
-            if (_up) {
+            if (up) {
                   ll1 = l1 - 17 - adjust(_spStaff4, slant, cl);
                   ll1 = qMin(ll1, 1);
                   static const int t[4] = { 3, 0, 1, 2 };
@@ -1354,7 +1352,7 @@ void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevel
             static const int t[] = { 0, 0, 4, 4, 8, 12, 16 }; // spatium4 added to stem len
             int n = t[beamLevels] + 12;
             bm.s = 0;
-            if (_up) {
+            if (up) {
                   bm.l = -n;
                   bm.l -= adjust(_spStaff4, bm.s, cl);
                   }
@@ -1363,6 +1361,66 @@ void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevel
                   bm.l += adjust(_spStaff4, bm.s, cl);
                   }
             }
+      return bm;
+      }
+
+//---------------------------------------------------------
+//   beamCacheKey
+//    all inputs of searchBeamMetric(); positions are
+//    relative to the first chord rest of the beam
+//---------------------------------------------------------
+
+static void beamCacheKey(QVector<qreal>& key, const QList<ChordRest*>& cl, bool up, int beamLevels, qreal spStaff4)
+      {
+      key.clear();
+      key.reserve(4 + cl.size() * 7);
+      key << up << beamLevels << spStaff4 << cl.front()->isGrace();
+      QPointF p1(cl.front()->pagePos());
+      foreach (const ChordRest* cr, cl) {
+            key << cr->type() << cr->up() << cr->upLine() << cr->downLine()
+                << cr->durationType().hooks();
+            if (cr->type() == Element::CHORD) {
+                  QPointF p(static_cast<const Chord*>(cr)->stemPosBeam() - p1);
+                  key << p.x() << p.y();
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   computeStemLen
+//    the result of the search is kept in the fragment and
+//    reused as long as its inputs do not change
+//---------------------------------------------------------
+
+void Beam::computeStemLen(const QList<ChordRest*>& cl, qreal& py1, int beamLevels, BeamFragment* f)
+      {
+      qreal _spatium      = spatium();
+      qreal _spatium4     = _spatium * .25;
+      qreal _spStaff4     = _spatium4 * staff()->lineDistance();  // scaled to staff line distance for vert. pos. within a staff
+      const ChordRest* c1 = cl.front();
+      const ChordRest* c2 = cl.back();
+      qreal dx            = c2->pagePos().x() - c1->pagePos().x();
+
+      QVector<qreal> key;
+      beamCacheKey(key, cl, _up, beamLevels, _spStaff4);
+      Bm bm;
+      if (key == f->key) {
+            bm.l = f->l;
+            bm.s = f->s;
+            if (MScore::debugMode) {
+                  Bm nbm = searchBeamMetric(cl, _up, noSlope(cl), beamLevels, _spStaff4);
+                  if (nbm.l != bm.l || nbm.s != bm.s) {
+                        qDebug("Beam: cached stem len %d slant %d, computed %d %d at tick %d",
+                           bm.l, bm.s, nbm.l, nbm.s, c1->tick());
+                        }
+                  }
+            }
+      else {
+            bm     = searchBeamMetric(cl, _up, noSlope(cl), beamLevels, _spStaff4);
+            f->key = key;
+            f->l   = bm.l;
+            f->s   = bm.s;
+            }
       if (dx == 0.0)
             slope = 0.0;
       else
@@ -1516,7 +1574,7 @@ void Beam::layout2(QList<ChordRest*>crl, SpannerSegmentType, int frag)
             else {
                   py1 = c1->stemPos().y();
                   py2 = c2->stemPos().y();
-                  computeStemLen(crl, py1, beamLevels);
+                  computeStemLen(crl, py1, beamLevels, f);
                   }
             py2 = (px2 - px1) * slope + py1;
             py1 -= _pagePos.y();
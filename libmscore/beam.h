@@ -60,7 +60,7 @@ class Beam : public Element {
 
       void layout2(QList<ChordRest*>, SpannerSegmentType, int frag);
       bool twoBeamedNotes();
-      void computeStemLen(const QList<ChordRest*>& crl, qreal& py1, int beamLevels);
+      void computeStemLen(const QList<ChordRest*>& crl, qreal& py1, int beamLevels, BeamFragment*);
       bool noSlope(const QList<ChordRest*>& crl);
 
    public:
@@ -1189,6 +1189,19 @@ void Chord::layoutStem1()
             score()->undoRemoveElement(_stemSlash);
       }
 
+//---------------------------------------------------------
+//   stemChanged
+//    return true if layoutStem1() has to add or remove
+//    a stem or stem slash
+//---------------------------------------------------------
+
+bool Chord::stemChanged() const
+      {
+      bool hasStem  = durationType().hasStem() && !(_noStem || measure()->slashStyle(staffIdx()));
+      bool hasSlash = hasStem && (_noteType == NOTE_ACCIACCATURA);
+      return hasStem != (_stem != 0) || hasSlash != (_stemSlash != 0);
+      }
+
 //---------------------------------------------------------
 //   layoutHook1
 ///   Layout hook
@@ -419,6 +419,7 @@ ParsedChord::ParsedChord()
       {
       _parseable = false;
       _understandable = false;
+      _renderListGeneration = -1;
       }
 
 //---------------------------------------------------------
@@ -1362,14 +1363,17 @@ QString ParsedChord::fromXml(const QString& rawKind, const QString& rawKindText,
 
 //---------------------------------------------------------
 //   renderList
+//    generated once per chord list generation; a chord
+//    list which is read again or unloaded gets a new one
 //---------------------------------------------------------
 
 const QList<RenderAction>& ParsedChord::renderList(const ChordList* cl)
       {
-      // generate anew on each call,
-      // in case chord list has changed since last time
-      if (!_renderList.isEmpty())
-            _renderList.clear();
+      int generation = cl ? cl->generation() : 0;
+      if (generation == _renderListGeneration)
+            return _renderList;
+      _renderList.clear();
+      _renderListGeneration = generation;
       foreach (ChordToken tok, _tokenList) {
             QString n = tok.names.first();
             QList<RenderAction> rl;
@@ -1420,6 +1424,7 @@ void ParsedChord::addToken(QString s, ChordTokenClass tc)
       tok.names += s;
       tok.tokenClass = tc;
       _tokenList += tok;
+      _renderListGeneration = -1;
       }
 
 //---------------------------------------------------------
@@ -1547,9 +1552,13 @@ void ChordDescription::write(Xml& xml) const
 //---------------------------------------------------------
 
 int ChordList::privateID = -1000;
+int ChordList::_nextGeneration = 1;
 
 ChordList::ChordList()
       {
+      _parseHits   = 0;
+      _parseMisses = 0;
+      _generation  = _nextGeneration++;
       }
 
 //---------------------------------------------------------
@@ -1573,6 +1582,7 @@ ChordList::~ChordList()
 
 void ChordList::read(XmlReader& e)
       {
+      clearParseCache();
       int fontIdx = 0;
       while (e.readNextStartElement()) {
             const QStringRef& tag(e.name());
@@ -1645,6 +1655,8 @@ void ChordList::read(XmlReader& e)
             else
                   e.unknown();
             }
+      // render lists made while reading may miss tokens read later
+      _generation = _nextGeneration++;
       }
 
 //---------------------------------------------------------
@@ -1794,6 +1806,49 @@ void ChordList::unload()
       renderListRoot.clear();
       renderListBase.clear();
       chordTokenList.clear();
+      clearParseCache();
+      }
+
+//---------------------------------------------------------
+//   parse
+//    return the parsed form of chord name s (without
+//    root and base) together with its render list;
+//    identical names are parsed only once; the
+//    reference is valid until the next call
+//---------------------------------------------------------
+
+const ParsedChord& ChordList::parse(const QString& s, bool syntaxOnly, bool preferMinor) const
+      {
+      QString key = s;
+      key += QChar(syntaxOnly ? '1' : '0');
+      key += QChar(preferMinor ? '1' : '0');
+      QHash<QString, ParsedChord>::const_iterator i = parseCache.constFind(key);
+      if (i != parseCache.constEnd()) {
+            ++_parseHits;
+            return i.value();
+            }
+      ++_parseMisses;
+      ParsedChord pc;
+      pc.parse(s, this, syntaxOnly, preferMinor);
+      pc.renderList(this);
+      return parseCache.insert(key, pc).value();
+      }
+
+//---------------------------------------------------------
+//   clearParseCache
+//---------------------------------------------------------
+
+void ChordList::clearParseCache()
+      {
+      if (MScore::debugMode && (_parseHits || _parseMisses)) {
+            qDebug("ChordList: %d parsed chords, %d hits, %d misses (%.1f%% hit rate)",
+               parseCache.size(), _parseHits, _parseMisses,
+               100.0 * _parseHits / (_parseHits + _parseMisses));
+            }
+      parseCache.clear();
+      _parseHits   = 0;
+      _parseMisses = 0;
+      _generation  = _nextGeneration++;
       }
 
 
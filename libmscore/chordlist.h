@@ -151,6 +151,7 @@ class ParsedChord {
       QStringList _modifierList;
       QList<ChordToken> _tokenList;
       QList<RenderAction> _renderList;
+      int _renderListGeneration;    // ChordList::generation() _renderList was made for, -1 if none
       QString _xmlKind;
       QString _xmlText;
       QString _xmlSymbols;
@@ -221,10 +222,19 @@ struct ChordFont {
 
 //---------------------------------------------------------
 //   ChordList
+//    parse() interns parsed chords by text and parse
+//    options; the cache is dropped whenever the chord
+//    list is read or unloaded, which also starts a new
+//    generation for the render lists of parsed chords
 //---------------------------------------------------------
 
 class ChordList : public QMap<int, ChordDescription*> {
       QHash<QString, ChordSymbol> symbols;
+      mutable QHash<QString, ParsedChord> parseCache;
+      mutable int _parseHits;
+      mutable int _parseMisses;
+      int _generation;
+      static int _nextGeneration;
 
    public:
       QList<ChordFont> fonts;
@@ -243,6 +253,13 @@ class ChordList : public QMap<int, ChordDescription*> {
       bool loaded() const;
       void unload();
       ChordSymbol symbol(const QString& s) const { return symbols.value(s); }
+
+      const ParsedChord& parse(const QString&, bool syntaxOnly = false, bool preferMinor = false) const;
+      void clearParseCache();
+      int parseCacheSize() const    { return parseCache.size(); }
+      int parseHits() const         { return _parseHits;   }
+      int parseMisses() const       { return _parseMisses; }
+      int generation() const        { return _generation;  }
       };
 
 
@@ -114,10 +114,8 @@ void Score::endCmd()
             }
 
       foreach(Score* s, scoreList()) {
-            if (s->layoutAll()) {
+            if (s->doLayoutIfNeeded())
                   s->_updateAll  = true;
-                  s->doLayout();
-                  }
             }
 
       bool noUndo = undo()->current()->childCount() <= 1;
@@ -136,6 +134,7 @@ void Score::end()
       {
       foreach(Score* s, scoreList())
             s->end1();
+      undo()->clearChangedTicks();
       }
 
 //---------------------------------------------------------
@@ -146,12 +145,54 @@ void Score::end()
 void Score::update()
       {
       foreach(Score* s, scoreList()) {
-            if (s->layoutAll()) {
+            if (s->doLayoutIfNeeded())
                   s->setUpdateAll(true);
-                  s->doLayout();
-                  }
             s->end1();
             }
+      undo()->clearChangedTicks();
+      }
+
+//---------------------------------------------------------
+//   doLayoutIfNeeded
+//    Layout the score after a change. A part score
+//    without a view is only marked stale; it is laid
+//    out by ensureLayout() when it is shown or exported.
+//    Return true if the score was laid out.
+//---------------------------------------------------------
+
+bool Score::doLayoutIfNeeded()
+      {
+      if (!_layoutAll && !_layoutDeferred)
+            return false;
+      if (parentScore() && viewer.isEmpty()) {
+            updateLayoutData();
+            _layoutAll      = false;
+            _layoutDeferred = true;
+            return false;
+            }
+      doLayout();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   ensureLayout
+//    catch up on a deferred layout before the score is
+//    shown, printed or exported. Layout may change the
+//    score through the undo stack; outside of a command
+//    these changes are appended to the last command,
+//    which made the layout stale, so they are undone
+//    with it and do not change the dirty state.
+//---------------------------------------------------------
+
+void Score::ensureLayout()
+      {
+      if (!_layoutAll && !_layoutDeferred)
+            return;
+      bool reopened = !undo()->active() && undo()->reopenMacro();
+      doLayout();
+      _updateAll = true;
+      if (reopened)
+            undo()->endMacro(false);
       }
 
 //---------------------------------------------------------
@@ -184,12 +225,14 @@ void Score::endUndoRedo()
       {
       updateSelection();
       foreach (Score* score, scoreList()) {
-            if (score->layoutAll()) {
-                  score->setUndoRedo(true);
+            score->setUndoRedo(true);
+            // no deferred layout here: it has to run in
+            // the undo/redo state
+            if (score->_layoutAll || score->_layoutDeferred) {
                   score->doLayout();
-                  score->setUndoRedo(false);
                   score->setUpdateAll(true);
                   }
+            score->setUndoRedo(false);
             score->setPlaylistDirty(true);
             }
       end();
@@ -1582,11 +1625,13 @@ bool Score::processMidiInput()
             return false;
 
       bool cmdActive = false;
+      bool previewed = true;
       Note* n = 0;
       while (!midiInputQueue.isEmpty()) {
             MidiInputEvent ev = midiInputQueue.dequeue();
             if (MScore::debugMode)
                   qDebug("<-- !noteentry dequeue %i", ev.pitch);
+            previewed = previewed && ev.previewed;
             if (!noteEntryMode()) {
                   int staffIdx = selection().staffStart();
                   Part* p;
@@ -1594,7 +1639,7 @@ bool Score::processMidiInput()
                         p = staff(0)->part();
                   else
                         p = staff(staffIdx)->part();
-                  if (p)
+                  if (p && !ev.previewed)
                         MScore::seq->startNote(p->instr()->channel(0).channel, ev.pitch, 80,
                            MScore::defaultPlayDuration, 0.0);
                   }
@@ -1611,6 +1656,8 @@ bool Score::processMidiInput()
       if (cmdActive) {
             _layoutAll = true;
             endCmd();
+            if (previewed)
+                  setPlayNote(false);
             //after relayout
             if (n) {
                   foreach(MuseScoreView* v, viewer)
@@ -21,6 +21,9 @@
 #include "libmscore/page.h"
 #include "libmscore/system.h"
 #include "libmscore/segment.h"
+#include "libmscore/staff.h"
+#include "libmscore/undo.h"
+#include "libmscore/pitchspelling.h"
 #include "cursor.h"
 
 namespace Ms {
@@ -254,5 +257,217 @@ inline void Cursor::firstChordRestInTrack()
             _segment = _segment->next1(Segment::SegChordRest);
       }
 
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void NoteTable::clear()
+      {
+      tick.clear();
+      track.clear();
+      pitch.clear();
+      tpc.clear();
+      duration.clear();
+      voice.clear();
+      notes.clear();
+      }
+
+//---------------------------------------------------------
+//   collect
+//    collect all notes of chords starting in the tick range
+//    [tick1, tick2) on staves [staff1, staff2)
+//---------------------------------------------------------
+
+void NoteTable::collect(Score* score, int tick1, int tick2, int staff1, int staff2)
+      {
+      clear();
+      int strack = staff1 * VOICES;
+      int etrack = staff2 * VOICES;
+      // tick1 needs not be the start of a segment: begin with
+      // the measure containing it and skip earlier segments
+      Measure* m = score->tick2measure(qMax(tick1, 0));
+      Segment* s = m ? m->first(Segment::SegChordRest) : 0;
+      for (; s && s->tick() < tick2; s = s->next1(Segment::SegChordRest)) {
+            if (s->tick() < tick1)
+                  continue;
+            for (int t = strack; t < etrack; ++t) {
+                  Element* e = s->element(t);
+                  if (e == 0 || e->type() != Element::CHORD)
+                        continue;
+                  Chord* chord = static_cast<Chord*>(e);
+                  int ticks = chord->actualTicks();
+                  foreach(Note* n, chord->notes()) {
+                        tick.append(s->tick());
+                        track.append(t);
+                        pitch.append(n->pitch());
+                        tpc.append(n->tpc());
+                        duration.append(ticks);
+                        voice.append(t % VOICES);
+                        notes.append(n);
+                        }
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   toVariantMap
+//---------------------------------------------------------
+
+static QVariantList toVariantList(const QVector<int>& v)
+      {
+      QVariantList l;
+      l.reserve(v.size());
+      foreach(int i, v)
+            l.append(i);
+      return l;
+      }
+
+QVariantMap NoteTable::toVariantMap() const
+      {
+      QVariantMap m;
+      m["tick"]     = toVariantList(tick);
+      m["track"]    = toVariantList(track);
+      m["pitch"]    = toVariantList(pitch);
+      m["tpc"]      = toVariantList(tpc);
+      m["duration"] = toVariantList(duration);
+      m["voice"]    = toVariantList(voice);
+      return m;
+      }
+
+//---------------------------------------------------------
+//   noteTable
+//---------------------------------------------------------
+
+QVariantMap Cursor::noteTable(bool selection)
+      {
+      if (!_score)
+            return QVariantMap();
+      const Selection& sel = _score->selection();
+      if (selection) {
+            if (sel.state() != SEL_RANGE)
+                  return QVariantMap();
+            return noteTableRange(sel.tickStart(), sel.tickEnd(), sel.staffStart(), sel.staffEnd());
+            }
+      Measure* lm = _score->lastMeasure();
+      return noteTableRange(0, lm ? lm->endTick() : 0, 0, _score->nstaves());
+      }
+
+//---------------------------------------------------------
+//   noteTableRange
+//---------------------------------------------------------
+
+QVariantMap Cursor::noteTableRange(int tick1, int tick2, int staff1, int staff2)
+      {
+      if (!_score)
+            return QVariantMap();
+      staff1 = qMax(staff1, 0);
+      staff2 = qMin(staff2, _score->nstaves());
+      NoteTable table;
+      table.collect(_score, tick1, tick2, staff1, staff2);
+      return table.toVariantMap();
+      }
+
+//---------------------------------------------------------
+//   setPitches
+//    change pitch (and spelling if tpc[i] is valid) of
+//    notes[i] to pitch[i]; all changes are collected in
+//    one undo command
+//---------------------------------------------------------
+
+int Cursor::setPitches(Score* score, const QList<Note*>& notes, const QVector<int>& pitch, const QVector<int>& tpc)
+      {
+      bool ownCmd = !score->undo()->active();
+      if (ownCmd)
+            score->startCmd();
+      int n = 0;
+      for (int i = 0; i < notes.size() && i < pitch.size(); ++i) {
+            Note* note = notes[i];
+            int p      = pitch[i];
+            if (p < 0 || p > 127)
+                  continue;
+            int t = i < tpc.size() ? tpc[i] : INVALID_TPC;
+            if (t < TPC_MIN || t > TPC_MAX) {
+                  if (p == note->pitch())
+                        continue;
+                  int key = note->staff()->key(note->chord()->tick()).accidentalType();
+                  t = pitch2tpc(p, key, PREFER_NEAREST);
+                  }
+            else if (p == note->pitch() && t == note->tpc())
+                  continue;
+            score->undoChangePitch(note, p, t, note->line());
+            ++n;
+            }
+      if (ownCmd)
+            score->endCmd();
+      return n;
+      }
+
+static QVector<int> toIntVector(const QVariant& v)
+      {
+      QVector<int> l;
+      QVariantList vl = v.toList();
+      l.reserve(vl.size());
+      foreach(const QVariant& i, vl)
+            l.append(i.toInt());
+      return l;
+      }
+
+int Cursor::setPitches(const QVariantMap& m)
+      {
+      if (!_score)
+            return 0;
+      QVector<int> tick     = toIntVector(m.value("tick"));
+      QVector<int> track    = toIntVector(m.value("track"));
+      QVector<int> pitch    = toIntVector(m.value("pitch"));
+      QVector<int> newPitch = toIntVector(m.value("newPitch"));
+      QVector<int> newTpc   = toIntVector(m.value("newTpc"));
+      int rows = tick.size();
+      if (track.size() != rows || pitch.size() != rows || newPitch.size() != rows
+         || (!newTpc.isEmpty() && newTpc.size() != rows)) {
+            qDebug("Cursor::setPitches: column size mismatch");
+            return 0;
+            }
+      if (rows == 0)
+            return 0;
+
+      // resolve all rows with a single scan over the affected range
+      int tick1 = tick[0];
+      int tick2 = tick[0];
+      foreach(int t, tick) {
+            tick1 = qMin(tick1, t);
+            tick2 = qMax(tick2, t);
+            }
+      NoteTable table;
+      table.collect(_score, tick1, tick2 + 1, 0, _score->nstaves());
+      QHash<QPair<int, int>, int> index;        // (tick, track) -> first row in table
+      for (int i = table.size() - 1; i >= 0; --i)
+            index.insert(qMakePair(table.tick[i], table.track[i]), i);
+
+      QList<Note*> notes;
+      QVector<int> pitches;
+      QVector<int> tpcs;
+      for (int i = 0; i < rows; ++i) {
+            Note* note = 0;
+            int k = index.value(qMakePair(tick[i], track[i]), -1);
+            if (k >= 0) {
+                  for (; k < table.size() && table.tick[k] == tick[i] && table.track[k] == track[i]; ++k) {
+                        if (table.pitch[k] == pitch[i]) {
+                              note = table.notes[k];
+                              break;
+                              }
+                        }
+                  }
+            if (note == 0) {
+                  qDebug("Cursor::setPitches: no note %d at tick %d track %d", pitch[i], tick[i], track[i]);
+                  continue;
+                  }
+            notes.append(note);
+            pitches.append(newPitch[i]);
+            tpcs.append(newTpc.isEmpty() ? int(INVALID_TPC) : newTpc[i]);
+            }
+      return setPitches(_score, notes, pitches, tpcs);
+      }
+
 }
 
@@ -26,6 +26,27 @@ class ChordRest;
 class StaffText;
 class Measure;
 
+//---------------------------------------------------------
+//   NoteTable
+//    columnar snapshot of all notes in a range of the
+//    score; row i describes notes[i]
+//---------------------------------------------------------
+
+struct NoteTable {
+      QVector<int> tick;
+      QVector<int> track;
+      QVector<int> pitch;
+      QVector<int> tpc;
+      QVector<int> duration;
+      QVector<int> voice;
+      QList<Note*> notes;
+
+      void clear();
+      void collect(Score*, int tick1, int tick2, int staff1, int staff2);
+      int size() const                  { return notes.size(); }
+      QVariantMap toVariantMap() const;
+      };
+
 //---------------------------------------------------------
 //   @@ Cursor
 //   @P track    int          current track
@@ -100,6 +121,25 @@ class Cursor : public QObject {
       //@   n: denominator
       //@   Quarter, if n == 0
       Q_INVOKABLE void setDuration(int z, int n);
+
+      //@ return all notes of the score (selection == false) or of the
+      //@ current range selection (selection == true) as a map of
+      //@ columns: tick, track, pitch, tpc, duration, voice;
+      //@ every column is a list with one entry per note
+      Q_INVOKABLE QVariantMap noteTable(bool selection = false);
+
+      //@ return all notes in the tick range [tick1, tick2) of
+      //@ staves [staff1, staff2) in the same format as noteTable()
+      Q_INVOKABLE QVariantMap noteTableRange(int tick1, int tick2, int staff1, int staff2);
+
+      //@ change the pitch of many notes as a single undoable command
+      //@   table: columns tick, track, pitch identify the notes,
+      //@          column newPitch holds the new pitch and the optional
+      //@          column newTpc the new spelling
+      //@ returns the number of changed notes
+      Q_INVOKABLE int setPitches(const QVariantMap& table);
+
+      static int setPitches(Score*, const QList<Note*>&, const QVector<int>& pitch, const QVector<int>& tpc);
       };
 
 
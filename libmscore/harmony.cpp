@@ -530,8 +530,7 @@ const ChordDescription* Harmony::parseHarmony(const QString& ss, int* root, int*
       if (useLiteral)
             cd = descr(s);
       else {
-            _parsedForm = new ParsedChord();
-            _parsedForm->parse(s, cl, syntaxOnly, preferMinor);
+            _parsedForm = new ParsedChord(cl->parse(s, syntaxOnly, preferMinor));
             if (preferMinor)
                   s = _parsedForm->name();
             cd = descr(s, _parsedForm);
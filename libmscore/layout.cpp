@@ -292,8 +292,8 @@ void Score::layoutChords1(QList<Note*>& notes, int voices, Staff* staff, Segment
       int nAcc = aclist.size();
       if (nAcc == 0)
             return;
-      qreal pd  = point(styleS(ST_accidentalDistance));
-      qreal pnd = point(styleS(ST_accidentalNoteDistance));
+      qreal pd  = _layoutStyle.accidentalDistance;
+      qreal pnd = _layoutStyle.accidentalNoteDistance;
 
       //
       // layout top accidental
@@ -396,6 +396,48 @@ void Score::beamGraceNotes(Chord* mainNote)
       b->layoutGraceNotes();
       }
 
+//---------------------------------------------------------
+//   Stage1Job
+//---------------------------------------------------------
+
+struct Stage1Job {
+      Measure* measure;
+      QList<Chord*> stemChords;
+      };
+
+static void layoutStage1Job(Stage1Job& job)
+      {
+      job.measure->layoutStage1(&job.stemChords);
+      }
+
+//---------------------------------------------------------
+//   layoutStage1
+//    Measures are independent in this stage: key map,
+//    accidentals and ties are computed before. Only stems
+//    are created or removed through the undo stack; this is
+//    done after the parallel pass in measure order.
+//---------------------------------------------------------
+
+void Score::layoutStage1()
+      {
+      QList<Stage1Job> jobs;
+      for (Measure* m = firstMeasure(); m; m = m->nextMeasure()) {
+            Stage1Job job;
+            job.measure = m;
+            jobs.append(job);
+            }
+      if (jobs.size() < MScore::parallelLayoutMeasures) {
+            foreach(const Stage1Job& job, jobs)
+                  job.measure->layoutStage1();
+            return;
+            }
+      QtConcurrent::blockingMap(jobs, layoutStage1Job);
+      foreach(const Stage1Job& job, jobs) {
+            foreach(Chord* c, job.stemChords)
+                  c->layoutStem1();
+            }
+      }
+
 //---------------------------------------------------------
 //   layoutStage2
 //    auto - beamer
@@ -530,33 +572,21 @@ void Score::layoutStage3()
       }
 
 //---------------------------------------------------------
-//   layout
-//    - measures are akkumulated into systems
-//    - systems are akkumulated into pages
-//   already existent systems and pages are reused
+//   updateLayoutData
+//    Update ticks, velocities, play events and key maps.
+//    Commands on linked scores depend on this data, so
+//    it is kept current even if the layout of a part
+//    score is deferred.
 //---------------------------------------------------------
 
-void Score::doLayout()
+void Score::updateLayoutData()
       {
-      int idx = _style.valueSt(ST_MusicalSymbolFont) == "Gonville" ? 1 : 0;
-
-      initSymbols(idx);
-
-      if (idx != _symIdx) {
-            _symIdx = idx;
-            _noteHeadWidth  = symbols[_symIdx][quartheadSym].width(spatium() / (MScore::DPI * SPATIUM20));
-            }
-
       if (layoutFlags & LAYOUT_FIX_TICKS)
             fixTicks();
       if (layoutFlags & LAYOUT_FIX_PITCH_VELO)
             updateVelo();
       if (layoutFlags & LAYOUT_PLAY_EVENTS)
             createPlayEvents();
-
-      for (MeasureBase* m = first(); m; m = m->next())
-            m->layout0();
-
       layoutFlags = 0;
 
       int nstaves = _staves.size();
@@ -585,6 +615,38 @@ void Score::doLayout()
                   }
             st->setUpdateKeymap(false);
             }
+      }
+
+//---------------------------------------------------------
+//   layout
+//    - measures are akkumulated into systems
+//    - systems are akkumulated into pages
+//   already existent systems and pages are reused
+//---------------------------------------------------------
+
+void Score::doLayout()
+      {
+      foreach(MuseScoreView* v, viewer)
+            v->layoutStarted();
+
+      int idx = _style.valueSt(ST_MusicalSymbolFont) == "Gonville" ? 1 : 0;
+
+      initSymbols(idx);
+
+      if (idx != _symIdx) {
+            _symIdx = idx;
+            _noteHeadWidth  = symbols[_symIdx][quartheadSym].width(spatium() / (MScore::DPI * SPATIUM20));
+            }
+
+      updateLayoutData();
+      _layoutDeferred = false;
+      _layoutStyle.init(_style);
+      MStyle::resetLookups();
+
+      for (MeasureBase* m = first(); m; m = m->next())
+            m->layout0();
+
+      int nstaves = _staves.size();
       if (_staves.isEmpty() || first() == 0) {
             // score is empty
             qDeleteAll(_pages);
@@ -599,8 +661,7 @@ void Score::doLayout()
             }
 
       // compute note head lines and accidentals:
-      for (Measure* m = firstMeasure(); m; m = m->nextMeasure())
-            m->layoutStage1();
+      layoutStage1();
 
       layoutStage2();   // beam notes, finally decide if chord is up/down
       layoutStage3();   // compute note head horizontal positions
@@ -680,6 +741,8 @@ void Score::doLayout()
 
       rebuildBspTree();
 
+      if (MScore::debugMode)
+            qDebug("layout: %d style lookups", MStyle::lookups());
       int n = viewer.size();
       for (int i = 0; i < n; ++i)
             viewer.at(i)->layoutChanged();
@@ -982,7 +1045,7 @@ bool Score::layoutSystem(qreal& minWidth, qreal w, bool isFirstSystem, bool long
       system->setInstrumentNames(longName);
       system->layout(xo);
 
-      qreal minMeasureWidth = point(styleS(ST_minMeasureWidth));
+      qreal minMeasureWidth = _layoutStyle.minMeasureWidth;
       minWidth              = system->leftMargin();
       qreal systemWidth     = w;
       bool continueFlag     = false;
@@ -990,7 +1053,7 @@ bool Score::layoutSystem(qreal& minWidth, qreal w, bool isFirstSystem, bool long
       Measure* firstMeasure = 0;
       Measure* lastMeasure  = 0;
 
-      qreal measureSpacing = styleD(ST_measureSpacing);
+      qreal measureSpacing = _layoutStyle.measureSpacing;
 
       for (; curMeasure;) {
             MeasureBase* nextMeasure;
@@ -1221,7 +1284,7 @@ bool Score::layoutSystem1(qreal& minWidth, bool isFirstSystem, bool longName)
       system->setInstrumentNames(longName);
       system->layout(xo);
 
-      qreal minMeasureWidth = point(styleS(ST_minMeasureWidth));
+      qreal minMeasureWidth = _layoutStyle.minMeasureWidth;
       minWidth              = system->leftMargin();
       bool continueFlag     = false;
       bool isFirstMeasure   = true;
@@ -1271,7 +1334,7 @@ bool Score::layoutSystem1(qreal& minWidth, bool isFirstSystem, bool longName)
                   else
                         ww = m->minWidth1();
 
-                  ww *= m->userStretch() * styleD(ST_measureSpacing);
+                  ww *= m->userStretch() * _layoutStyle.measureSpacing;
                   if (ww < minMeasureWidth)
                         ww = minMeasureWidth;
                   isFirstMeasure = false;
@@ -1991,7 +2054,7 @@ void Score::layoutLinear()
             if (mb->type() == Element::MEASURE) {
                   Measure* m = static_cast<Measure*>(mb);
                   m->createEndBarLines();       // TODO: not set here
-                  w = m->minWidth1() * styleD(ST_linearStretch);
+                  w = m->minWidth1() * _layoutStyle.linearStretch;
                   m->layout(w);
                   }
             else
@@ -2435,10 +2498,58 @@ void Score::respace(QList<ChordRest*>* elements)
             }
       }
 
+//---------------------------------------------------------
+//   layoutMinWidthElements
+//    layout the elements of all segments starting at fs
+//    which are measured by computeMinWidth()
+//---------------------------------------------------------
+
+void Score::layoutMinWidthElements(Segment* fs)
+      {
+      int _nstaves = nstaves();
+      for (Segment* s = fs; s; s = s->next()) {
+            Segment::SegmentType segType = s->segmentType();
+            for (int staffIdx = 0; staffIdx < _nstaves; ++staffIdx) {
+                  if (!staff(staffIdx)->show())
+                        continue;
+                  int track = staffIdx * VOICES;
+                  if (segType & Segment::SegChordRest) {
+                        for (int voice = 0; voice < VOICES; ++voice) {
+                              ChordRest* cr = static_cast<ChordRest*>(s->element(track+voice));
+                              if (!cr)
+                                    continue;
+                              cr->layout();
+                              foreach(Lyrics* l, cr->lyricsList()) {
+                                    if (l && !l->isEmpty())
+                                          l->layout();
+                                    }
+                              }
+                        foreach (Element* e, s->annotations()) {
+                              if (e->type() == Element::HARMONY && e->track() >= track && e->track() < track+VOICES)
+                                    e->layout();
+                              }
+                        continue;
+                        }
+                  Element* e = s->element(track);
+                  if (e == 0 && segType == Segment::SegEndBarLine && s != fs) {
+                        // look for barline
+                        for (int i = track - VOICES; i >= 0; i -= VOICES) {
+                              e = s->element(i);
+                              if (e)
+                                    break;
+                              }
+                        }
+                  if (e)
+                        e->layout();
+                  }
+            }
+      }
+
 //---------------------------------------------------------
 //   computeMinWidth
 ///    compute the minimum width of a measure with
-///    segment list fs
+///    segment list fs; the elements must have been laid
+///    out by layoutMinWidthElements()
 //---------------------------------------------------------
 
 qreal Score::computeMinWidth(Segment* fs)
@@ -2448,9 +2559,7 @@ qreal Score::computeMinWidth(Segment* fs)
             return 1.0;
 
       qreal _spatium           = spatium();
-      qreal clefKeyRightMargin = styleS(ST_clefKeyRightMargin).val() * _spatium;
-      qreal minNoteDistance    = styleS(ST_minNoteDistance).val()    * _spatium;
-      qreal minHarmonyDistance = styleS(ST_minHarmonyDistance).val() * _spatium;
+      const LayoutStyle& ls    = _layoutStyle;
 
       qreal rest[_nstaves];    // fixed space needed from previous segment
       memset(rest, 0, _nstaves * sizeof(qreal));
@@ -2478,10 +2587,8 @@ qreal Score::computeMinWidth(Segment* fs)
                               continue;
                         int track  = staffIdx * VOICES;
                         Element* e = s->element(track);
-                        if (e) {
-                              e->layout();
+                        if (e)
                               clefWidth[staffIdx] = e->width() + _spatium + elsp;
-                              }
                         }
                   continue;
                   }
@@ -2528,28 +2635,25 @@ qreal Score::computeMinWidth(Segment* fs)
                                                       }
                                                 }
                                           }
-                                    StyleIdx si = accidental ? ST_barAccidentalDistance : ST_barNoteDistance;
-                                    qreal sp    = styleS(si).val() * _spatium;
-                                    sp         += elsp;
+                                    qreal sp = accidental ? ls.barAccidentalDistance : ls.barNoteDistance;
+                                    sp      += elsp;
                                     minDistance = qMax(minDistance, sp);
                                     stretchDistance = sp * .7;
                                     }
                               else if (pt & (Segment::SegChordRest)) {
-                                    minDistance = qMax(minDistance, minNoteDistance);
+                                    minDistance = qMax(minDistance, ls.minNoteDistance);
                                     }
                               else {
                                     // if (pt & (Segment::SegKeySig | Segment::SegClef))
                                     bool firstClef = (segmentIdx == 1) && (pt == Segment::SegClef);
                                     if ((pt & (Segment::SegKeySig | Segment::SegTimeSig)) || firstClef)
-                                          minDistance = qMax(minDistance, clefKeyRightMargin);
+                                          minDistance = qMax(minDistance, ls.clefKeyRightMargin);
                                     }
-                              cr->layout();
                               space.max(cr->space());
                               foreach(Lyrics* l, cr->lyricsList()) {
                                     if (!l)
                                           continue;
                                     if (!l->isEmpty()) {
-                                          l->layout();
                                           lyrics = l;
                                           if (!lyrics->isMelisma()) {
                                                 QRectF b(l->bbox().translated(l->pos()));
@@ -2567,7 +2671,6 @@ qreal Score::computeMinWidth(Segment* fs)
                               if (e->type() != Element::HARMONY || e->track() < track || e->track() >= track+VOICES)
                                     continue;
                               Harmony* h = static_cast<Harmony*>(e);
-                              h->layout();
                               QRectF b(h->bboxtight().translated(h->pos()));
                               if (hFound)
                                     hBbox |= b;
@@ -2581,14 +2684,14 @@ qreal Score::computeMinWidth(Segment* fs)
                   else {
                         Element* e = s->element(track);
                         if ((segType == Segment::SegClef) && (pt != Segment::SegChordRest))
-                              minDistance = styleP(ST_clefLeftMargin);
+                              minDistance = ls.clefLeftMargin;
                         else if (segType == Segment::SegStartRepeatBarLine)
                               minDistance = .5 * _spatium;
                         else if ((segType == Segment::SegEndBarLine) && segmentIdx) {
                               if (pt == Segment::SegClef)
-                                    minDistance = styleP(ST_clefBarlineDistance);
+                                    minDistance = ls.clefBarlineDistance;
                               else
-                                    stretchDistance = styleP(ST_noteBarDistance);
+                                    stretchDistance = ls.noteBarDistance;
                               if (e == 0) {
                                     // look for barline
                                     for (int i = track - VOICES; i >= 0; i -= VOICES) {
@@ -2600,7 +2703,6 @@ qreal Score::computeMinWidth(Segment* fs)
                               }
                         if (e) {
                               eFound = true;
-                              e->layout();
                               space.max(e->space());
                               }
                         }
@@ -2622,7 +2724,7 @@ qreal Score::computeMinWidth(Segment* fs)
 
                         // space chord symbols unless they miss each other vertically
                         if (eFound || (hBbox.top() < hLastBbox[staffIdx].bottom() && hBbox.bottom() > hLastBbox[staffIdx].top()))
-                              sp = hRest[staffIdx] + minHarmonyDistance + hSpace.lw();
+                              sp = hRest[staffIdx] + ls.minHarmonyDistance + hSpace.lw();
                         hLastBbox[staffIdx] = hBbox;
 
                         hRest[staffIdx] = hSpace.rw();
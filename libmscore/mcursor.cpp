@@ -162,7 +162,7 @@ void MCursor::addPart(const QString& instrument)
             }
       part->initFromInstrTemplate(it);
       _score->appendPart(part);
-      _score->insertStaff(staff, 0);
+      _score->insertStaff(staff, _score->nstaves());
       }
 
 //---------------------------------------------------------
@@ -140,6 +140,8 @@ Measure::Measure(Score* s)
 
       _minWidth1             = 0.0;
       _minWidth2             = 0.0;
+      _minWidthKey           = 0;
+      _layoutPending         = true;
 
       _no                    = 0;
       _noOffset              = 0;
@@ -175,6 +177,8 @@ Measure::Measure(const Measure& m)
 
       _minWidth1             = m._minWidth1;
       _minWidth2             = m._minWidth2;
+      _minWidthKey           = 0;
+      _layoutPending         = true;
 
       _no                    = m._no;
       _noOffset              = m._noOffset;
@@ -291,7 +295,7 @@ struct AcEl {
 //   layoutChords0
 //---------------------------------------------------------
 
-void Measure::layoutChords0(Segment* segment, int startTrack)
+void Measure::layoutChords0(Segment* segment, int startTrack, QList<Chord*>* stemChords)
       {
       int staffIdx     = startTrack/VOICES;
       Staff* staff     = score()->staff(staffIdx);
@@ -302,15 +306,18 @@ void Measure::layoutChords0(Segment* segment, int startTrack)
             ChordRest* cr = static_cast<ChordRest*>(segment->element(track));
             if (!cr)
                  continue;
-            layoutCR0(cr, staffMag);
+            layoutCR0(cr, staffMag, stemChords);
             }
       }
 
 //---------------------------------------------------------
 //   layoutCR0
+//    if stemChords is set, chords which need a stem added
+//    or removed are collected there instead of calling
+//    the (undoable) layoutStem1()
 //---------------------------------------------------------
 
-void Measure::layoutCR0(ChordRest* cr, qreal mm)
+void Measure::layoutCR0(ChordRest* cr, qreal mm, QList<Chord*>* stemChords)
       {
       Drumset* drumset = 0;
       if (cr->staff()->part()->instr()->useDrumset())
@@ -323,7 +330,7 @@ void Measure::layoutCR0(ChordRest* cr, qreal mm)
       if (cr->type() == CHORD) {
             Chord* chord = static_cast<Chord*>(cr);
             for (Chord* c : chord->graceNotes())
-                  layoutCR0(c, mm);
+                  layoutCR0(c, mm, stemChords);
 
             if (chord->noteType() != NOTE_NORMAL)
                   m *= score()->styleD(ST_graceNoteMag);
@@ -341,7 +348,10 @@ void Measure::layoutCR0(ChordRest* cr, qreal mm)
                         }
                   }
             chord->computeUp();
-            chord->layoutStem1();
+            if (stemChords == 0)
+                  chord->layoutStem1();
+            else if (chord->stemChanged())
+                  stemChords->append(chord);
             }
       if (m != mag()) {
             cr->setMag(m);
@@ -2729,8 +2739,136 @@ void Space::max(const Space& s)
 
 void Measure::setDirty()
       {
-      _minWidth1 = 0.0;
-      _minWidth2 = 0.0;
+      _minWidth1     = 0.0;
+      _minWidth2     = 0.0;
+      _layoutPending = true;
+      }
+
+//---------------------------------------------------------
+//   layoutElements
+//    lay out the elements measured by computeMinWidth();
+//    done once per layout pass on the first width query,
+//    after stage 2 has decided the stem directions. The
+//    cached widths are only kept if the content signature
+//    is unchanged.
+//---------------------------------------------------------
+
+void Measure::layoutElements() const
+      {
+      if (!_layoutPending)
+            return;
+      _layoutPending = false;
+      score()->layoutMinWidthElements(first());
+      quint64 key = minWidthKey();
+      if (key != _minWidthKey) {
+            _minWidthKey = key;
+            _minWidth1   = 0.0;
+            _minWidth2   = 0.0;
+            }
+      }
+
+//---------------------------------------------------------
+//   minWidthKey
+//    signature of the input of computeMinWidth(): the
+//    laid out space of every element, the lyrics and chord
+//    symbol boxes and the relevant style values. It is
+//    computed after layoutMinWidthElements(), so in place
+//    changes of an element (key signature naturals, clef
+//    type, accidental and dot positions) change the key.
+//---------------------------------------------------------
+
+static inline void hashCombine(quint64& h, quint64 v)
+      {
+      h ^= v + Q_UINT64_C(0x9e3779b97f4a7c15) + (h << 6) + (h >> 2);
+      }
+
+static inline void hashCombine(quint64& h, qreal v)
+      {
+      double d = v;
+      quint64 bits;
+      memcpy(&bits, &d, sizeof(bits));
+      hashCombine(h, bits);
+      }
+
+static inline void hashCombine(quint64& h, const Space& sp)
+      {
+      hashCombine(h, sp.lw());
+      hashCombine(h, sp.rw());
+      }
+
+static inline void hashCombine(quint64& h, const QRectF& r)
+      {
+      hashCombine(h, r.left());
+      hashCombine(h, r.top());
+      hashCombine(h, r.right());
+      hashCombine(h, r.bottom());
+      }
+
+static void hashChordRest(quint64& h, const ChordRest* cr)
+      {
+      hashCombine(h, cr->space());
+      foreach(const Lyrics* l, cr->lyricsList()) {
+            if (!l || l->isEmpty())
+                  continue;
+            hashCombine(h, quint64(l->isMelisma()));
+            hashCombine(h, l->bbox().translated(l->pos()));
+            }
+      if (cr->type() != Element::CHORD)
+            return;
+      const Chord* c = static_cast<const Chord*>(cr);
+      bool accidental = !c->graceNotes().empty();
+      foreach(const Note* n, c->notes())
+            accidental |= n->accidental() != 0;
+      hashCombine(h, quint64(accidental));
+      }
+
+quint64 Measure::minWidthKey() const
+      {
+      quint64 h = 0;
+      const LayoutStyle& ls = score()->layoutStyle();
+      hashCombine(h, score()->spatium());
+      hashCombine(h, ls.minNoteDistance);
+      hashCombine(h, ls.barNoteDistance);
+      hashCombine(h, ls.barAccidentalDistance);
+      hashCombine(h, ls.noteBarDistance);
+      hashCombine(h, ls.clefLeftMargin);
+      hashCombine(h, ls.clefKeyRightMargin);
+      hashCombine(h, ls.clefBarlineDistance);
+      hashCombine(h, ls.minHarmonyDistance);
+      int nstaves = score()->nstaves();
+      hashCombine(h, quint64(nstaves));
+      for (int staffIdx = 0; staffIdx < nstaves; ++staffIdx)
+            hashCombine(h, quint64(score()->staff(staffIdx)->show()));
+
+      for (const Segment* s = first(); s; s = s->next()) {
+            hashCombine(h, quint64(s->segmentType()));
+            hashCombine(h, quint64(s->rtick() != 0));
+            hashCombine(h, s->extraLeadingSpace().val());
+            hashCombine(h, s->extraTrailingSpace().val());
+            foreach(const Element* e, s->elist()) {
+                  if (!e) {
+                        hashCombine(h, quint64(0));
+                        continue;
+                        }
+                  hashCombine(h, quint64(e->type()));
+                  if (e->isChordRest())
+                        hashChordRest(h, static_cast<const ChordRest*>(e));
+                  else {
+                        hashCombine(h, quint64(e->generated()));
+                        hashCombine(h, e->space());
+                        hashCombine(h, e->width());
+                        }
+                  }
+            foreach(const Element* e, s->annotations()) {
+                  if (e->type() != Element::HARMONY)
+                        continue;
+                  const Harmony* hm = static_cast<const Harmony*>(e);
+                  hashCombine(h, quint64(hm->track()));
+                  hashCombine(h, hm->bboxtight().translated(hm->pos()));
+                  }
+            }
+      // never use 0, it marks an invalid key
+      return h ? h : 1;
       }
 
 //---------------------------------------------------------
@@ -2754,6 +2892,7 @@ bool Measure::systemHeader() const
 
 qreal Measure::minWidth1() const
       {
+      layoutElements();
       if (_minWidth1 == 0.0) {
             Segment* s = first();
             Segment::SegmentTypes st = Segment::SegClef | Segment::SegKeySig | Segment::SegStartRepeatBarLine;
@@ -2775,6 +2914,7 @@ qreal Measure::minWidth1() const
 
 qreal Measure::minWidth2() const
       {
+      layoutElements();
       if (_minWidth2 == 0.0)
             _minWidth2 = score()->computeMinWidth(first());
       return _minWidth2;
@@ -2849,8 +2989,7 @@ void Measure::layoutX(qreal stretch)
 
       qreal _spatium           = spatium();
       int tracks               = nstaves * VOICES;
-      qreal clefKeyRightMargin = score()->styleS(ST_clefKeyRightMargin).val() * _spatium;
-      qreal minHarmonyDistance = score()->styleS(ST_minHarmonyDistance).val() * _spatium;
+      const LayoutStyle& ls    = score()->layoutStyle();
 
       qreal rest[nstaves];    // fixed space needed from previous segment
       memset(rest, 0, nstaves * sizeof(qreal));
@@ -2878,8 +3017,6 @@ void Measure::layoutX(qreal stretch)
             x += BarLine::layoutWidth(score(), bl->barLineType(), bl->magS());
             }
 
-      qreal minNoteDistance = score()->styleS(ST_minNoteDistance).val() * _spatium;
-
       qreal clefWidth[nstaves];
       memset(clefWidth, 0, nstaves * sizeof(qreal));
 
@@ -2951,19 +3088,18 @@ void Measure::layoutX(qreal stretch)
                                           }
                                     // no distance to full measure rest
                                     if (!(cr->type() == REST && static_cast<Rest*>(cr)->durationType() == TDuration::V_MEASURE)) {
-                                          StyleIdx si = accidental ? ST_barAccidentalDistance : ST_barNoteDistance;
-                                          qreal sp    = score()->styleS(si).val() * _spatium;
-                                          sp          += elsp;
+                                          qreal sp = accidental ? ls.barAccidentalDistance : ls.barNoteDistance;
+                                          sp      += elsp;
                                           minDistance = qMax(minDistance, sp);
                                           }
                                     }
                               else if (pt & (Segment::SegChordRest)) {
-                                    minDistance = qMax(minDistance, minNoteDistance);
+                                    minDistance = qMax(minDistance, ls.minNoteDistance);
                                     }
                               else {
                                     bool firstClef = (segmentIdx == 1) && (pt == Segment::SegClef);
                                     if ((pt & (Segment::SegKeySig | Segment::SegTimeSig)) || firstClef)
-                                          minDistance = qMax(minDistance, clefKeyRightMargin);
+                                          minDistance = qMax(minDistance, ls.clefKeyRightMargin);
                                     }
                               space.max(cr->space());
                               int n = cr->lyricsList().size();
@@ -2980,7 +3116,7 @@ void Measure::layoutX(qreal stretch)
                                     }
                               }
                         if (lyrics) {
-                              qreal y = lyrics->ipos().y() + score()->styleS(ST_lyricsMinBottomDistance).val() * _spatium;
+                              qreal y = lyrics->ipos().y() + ls.lyricsMinBottomDistance;
                               if (y > staves[staffIdx]->distanceDown)
                                  staves[staffIdx]->distanceDown = y;
                               space.max(Space(llw, rrw));
@@ -3005,14 +3141,14 @@ void Measure::layoutX(qreal stretch)
                   else {
                         Element* e = s->element(track);
                         if ((segType == Segment::SegClef) && (pt != Segment::SegChordRest))
-                              minDistance = score()->styleS(ST_clefLeftMargin).val() * _spatium;
+                              minDistance = ls.clefLeftMargin;
                         else if (segType == Segment::SegStartRepeatBarLine)
                               minDistance = .5 * _spatium;
                         else if ((segType == Segment::SegEndBarLine) && segmentIdx) {
                               if (pt == Segment::SegClef)
-                                    minDistance = score()->styleS(ST_clefBarlineDistance).val() * _spatium;
+                                    minDistance = ls.clefBarlineDistance;
                               else
-                                    stretchDistance = score()->styleS(ST_noteBarDistance).val() * _spatium;
+                                    stretchDistance = ls.noteBarDistance;
                               if (e == 0) {
                                     // look for barline
                                     for (int i = track - VOICES; i >= 0; i -= VOICES) {
@@ -3048,7 +3184,7 @@ void Measure::layoutX(qreal stretch)
 
                         // space chord symbols unless they miss each other vertically
                         if (eFound || (hBbox.top() < hLastBbox[staffIdx].bottom() && hBbox.bottom() > hLastBbox[staffIdx].top()))
-                              sp = hRest[staffIdx] + minHarmonyDistance + hSpace.lw();
+                              sp = hRest[staffIdx] + ls.minHarmonyDistance + hSpace.lw();
                         hLastBbox[staffIdx] = hBbox;
 
                         hRest[staffIdx] = hSpace.rw();
@@ -3277,7 +3413,7 @@ void Measure::layoutX(qreal stretch)
                   else if (t == REST)
                         e->rxpos() = 0;
                   else if (t == REPEAT_MEASURE) {
-                        qreal x1 = seg == 0 ? 0.0 : xpos[seg] - clefKeyRightMargin;
+                        qreal x1 = seg == 0 ? 0.0 : xpos[seg] - ls.clefKeyRightMargin;
                         qreal w  = xpos[segs-1] - x1;
                         e->rxpos() = (w - e->width()) * .5 + x1 - s->x();
                         }
@@ -3306,10 +3442,8 @@ void Measure::layoutX(qreal stretch)
 //   layoutStage1
 //---------------------------------------------------------
 
-void Measure::layoutStage1()
+void Measure::layoutStage1(QList<Chord*>* stemChords)
       {
-      setDirty();
-
       for (int staffIdx = 0; staffIdx < score()->nstaves(); ++staffIdx) {
             setBreakMMRest(false);
             if (score()->styleB(ST_createMultiMeasureRests)) {
@@ -3342,10 +3476,14 @@ void Measure::layoutStage1()
                         }
 
                   if (segment->segmentType() & Segment::SegChordRest)
-                        layoutChords0(segment, staffIdx * VOICES);
+                        layoutChords0(segment, staffIdx * VOICES, stemChords);
                   }
             }
 
+      // elements are laid out and the cached min widths
+      // checked on the first width query after stage 2
+      _layoutPending = true;
+
       if (!breakMMRest()) {
             for (auto i = score()->spanner().lower_bound(tick()); i != score()->spanner().upper_bound(tick()); ++i) {
                Spanner* sp = i->second;
@@ -115,6 +115,8 @@ class Measure : public MeasureBase {
 
       mutable qreal _minWidth1;     ///< minimal measure width without system header
       mutable qreal _minWidth2;     ///< minimal measure width with system header
+      mutable quint64 _minWidthKey; ///< signature of the input of cached min widths
+      mutable bool _layoutPending;  ///< elements not laid out in this layout pass
 
       bool _irregular;              ///< Irregular measure, do not count
       bool _breakMultiMeasureRest;  ///< set by user
@@ -139,7 +141,9 @@ class Measure : public MeasureBase {
 
       void push_back(Segment* e);
       void push_front(Segment* e);
-      void layoutCR0(ChordRest* cr, qreal m);
+      void layoutCR0(ChordRest* cr, qreal m, QList<Chord*>* stemChords);
+      quint64 minWidthKey() const;
+      void layoutElements() const;
 
    public:
       Measure(Score* = 0);
@@ -281,10 +285,10 @@ class Measure : public MeasureBase {
 
       bool isEmpty() const;
 
-      void layoutChords0(Segment* segment, int startTrack);
+      void layoutChords0(Segment* segment, int startTrack, QList<Chord*>* stemChords = 0);
       void layoutChords10(Segment* segment, int startTrack, AccidentalState*);
       void updateAccidentals(Segment* segment, int staffIdx, AccidentalState*);
-      void layoutStage1();
+      void layoutStage1(QList<Chord*>* stemChords = 0);
       int playbackCount() const      { return _playbackCount; }
       void setPlaybackCount(int val) { _playbackCount = val; }
       QRectF staffabbox(int staffIdx) const;
@@ -55,6 +55,7 @@ int     MScore::defaultPlayDuration;
 QString MScore::partStyle;
 QString MScore::lastError;
 bool    MScore::layoutDebug = false;
+int     MScore::parallelLayoutMeasures = 32;
 int     MScore::division    = 480;   // pulses per quarter note (PPQ) // ticks per beat
 int     MScore::sampleRate  = 44100;
 int     MScore::mtcType;
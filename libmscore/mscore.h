@@ -396,6 +396,7 @@ class MScore : public QObject {
       static QString partStyle;
       static QString lastError;
       static bool layoutDebug;
+      static int parallelLayoutMeasures;  // run layout stage 1 in parallel from this many measures
 
       static int division;
       static int sampleRate;
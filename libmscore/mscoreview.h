@@ -36,6 +36,7 @@ class MuseScoreView {
       const QList<Element*> elementsAt(const QPointF&);
       virtual Element* elementNear(QPointF) = 0;
 
+      virtual void layoutStarted() {}
       virtual void layoutChanged() {}
       virtual void dataChanged(const QRectF&) = 0;
       virtual void updateAll() = 0;
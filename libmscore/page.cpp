@@ -130,7 +130,8 @@ Page::Page(Score* s)
    : Element(s),
    _no(0)
       {
-      bspTreeValid = false;
+      bspTreeValid     = false;
+      displayListValid = false;
       }
 
 Page::~Page()
@@ -886,6 +887,58 @@ QList<const Element*> Page::elements()
       return el;
       }
 
+//---------------------------------------------------------
+//   displayList
+//    all elements of the page in paint order; built on
+//    first use after the page was laid out and shared by
+//    screen painting, printing and all graphic exports
+//---------------------------------------------------------
+
+const QList<const Element*>& Page::displayList()
+      {
+      if (!displayListValid) {
+            _displayList.clear();
+            foreach (System* s, _systems) {
+                  foreach(MeasureBase* m, s->measures())
+                        m->scanElements(&_displayList, collectElements, false);
+                  }
+            scanElements(&_displayList, collectElements, false);
+            qStableSort(_displayList.begin(), _displayList.end(), elementLessThan);
+            _displayIndex.clear();
+            _displayIndex.reserve(_displayList.size());
+            for (int i = 0; i < _displayList.size(); ++i)
+                  _displayIndex.insert(_displayList[i], i);
+            displayListValid = true;
+            }
+      return _displayList;
+      }
+
+//---------------------------------------------------------
+//   displayItems
+//    elements of the page which intersect r in paint
+//    order; they are found through the bsp tree and
+//    only ordered by their display list position
+//---------------------------------------------------------
+
+QList<const Element*> Page::displayItems(const QRectF& r)
+      {
+      const QList<const Element*>& dl = displayList();
+      QList<Element*> el = items(r);
+      QVector<int> idx;
+      idx.reserve(el.size());
+      foreach (const Element* e, el) {
+            QHash<const Element*, int>::const_iterator i = _displayIndex.find(e);
+            if (i != _displayIndex.end())
+                  idx.append(i.value());
+            }
+      qSort(idx);
+      QList<const Element*> l;
+      l.reserve(idx.size());
+      foreach (int i, idx)
+            l.append(dl[i]);
+      return l;
+      }
+
 //---------------------------------------------------------
 //   tm
 //---------------------------------------------------------
@@ -129,6 +129,9 @@ class Page : public Element {
       void doRebuildBspTree();
 #endif
       bool bspTreeValid;
+      QList<const Element*> _displayList;
+      QHash<const Element*, int> _displayIndex;     // position in _displayList
+      bool displayListValid;
 
       QString replaceTextMacros(const QString&) const;
       void drawStyledHeaderFooter(QPainter*, int area, const QPointF&, const QString&) const;
@@ -160,13 +163,15 @@ class Page : public Element {
 
       QList<Element*> items(const QRectF& r);
       QList<Element*> items(const QPointF& p);
-      void rebuildBspTree()   { bspTreeValid = false; }
+      void rebuildBspTree()   { bspTreeValid = false; displayListValid = false; }
       QPointF pagePos() const { return QPointF(); }     ///< position in page coordinates
       QList<System*> searchSystem(const QPointF& pos) const;
       Measure* searchMeasure(const QPointF& p) const;
       MeasureBase* pos2measure(const QPointF&, int* staffIdx, int* pitch,
          Segment**, QPointF* offset) const;
       QList<const Element*> elements();         ///< list of visible elements
+      const QList<const Element*>& displayList();
+      QList<const Element*> displayItems(const QRectF& r);
       };
 
 extern const PaperSize paperSizes[];
@@ -703,58 +703,194 @@ void spell(QList<Event>& notes, int key)
       }
 
 //---------------------------------------------------------
-//   spell
+//   spellWindow
+//    the spelling of a window of ten notes (padded like
+//    in computeWindow()) as a shortest path over the two
+//    spellings of every note of tab1 and of tab2. The
+//    result is the one of computeWindow(): of equal
+//    penalties the lowest combination wins, and tab2 if
+//    both tables have the same one.
+//---------------------------------------------------------
+
+static int spellWindow(const int* pitch, const int* key)
+      {
+      const int* tabs[2] = { tab1, tab2 };
+      int best[2];
+      int bestIdx[2];
+      for (int t = 0; t < 2; ++t) {
+            const int* tab = tabs[t];
+            int cost[10][2];
+            cost[0][0] = 0;
+            cost[0][1] = 0;
+            for (int k = 1; k < 10; ++k) {
+                  for (int b = 0; b < 2; ++b) {
+                        int lof = tab[pitch[k] * 2 + b];
+                        int c0  = cost[k-1][0] + penalty(tab[pitch[k-1] * 2], lof, key[k]);
+                        int c1  = cost[k-1][1] + penalty(tab[pitch[k-1] * 2 + 1], lof, key[k]);
+                        cost[k][b] = qMin(c0, c1);
+                        }
+                  }
+            // the last note is always bit 0 (i < 512 in
+            // computeWindow()); going back, prefer bit 0
+            // for the higher notes to get the lowest index
+            int idx = 0;
+            int b   = 0;
+            for (int k = 8; k >= 0; --k) {
+                  int lof = tab[pitch[k+1] * 2 + b];
+                  if (cost[k][0] + penalty(tab[pitch[k] * 2], lof, key[k+1]) == cost[k+1][b])
+                        b = 0;
+                  else
+                        b = 1;
+                  idx |= b << k;
+                  }
+            best[t]    = cost[9][0];
+            bestIdx[t] = idx;
+            }
+      if (best[0] < best[1] || (best[0] == best[1] && bestIdx[0] < bestIdx[1]))
+            return bestIdx[0];
+      return -bestIdx[1];
+      }
+
+//---------------------------------------------------------
+//   spellNotes
+//    Compute the spelling of a note sequence like the
+//    sliding window of Score::spellNotelist() always did,
+//    but every window is solved by spellWindow() instead
+//    of trying all 2^9 combinations.
+//    key[i] is the key of note i (0 - 14, 7 = C).
+//    Returns the tpc of every note. Does not touch the
+//    score and is safe to call from worker threads.
 //---------------------------------------------------------
 
-void Score::spellNotelist(QList<Note*>& notes)
+QVector<int> spellNotes(const QVector<int>& pitch, const QVector<int>& key)
       {
-      int n = notes.size();
-
+      int n = pitch.size();
+      QVector<int> tpcs(n);
       int start = 0;
       while (start < n) {
-            int end = start + WINDOW;
-            if (end > n)
-                  end = n;
-            int opt = computeWindow(notes, start, end);
-            const int* tab;
-            if (opt < 0) {
-                  tab = tab2;
-                  opt *= -1;
+            int end = qMin(start + WINDOW, n);
+            int p[10];
+            int k[10];
+            int i = 0;
+            for (; i < end - start; ++i) {
+                  p[i] = pitch[start + i] % 12;
+                  k[i] = key[start + i];
                   }
-            else
-                  tab = tab1;
-
-            if (start == 0) {
-                  undoChangeTpc(notes[0], tab[(notes[0]->pitch() % 12) * 2 + (opt & 1)]);
-                  if (n > 1)
-                        undoChangeTpc(notes[1], tab[(notes[1]->pitch() % 12) * 2 + ((opt & 2)>>1)]);
-                  if (n > 2)
-                        undoChangeTpc(notes[2], tab[(notes[2]->pitch() % 12) * 2 + ((opt & 4)>>2)]);
-                  }
-            if ((end - start) >= 6) {
-                  undoChangeTpc(notes[start+3], tab[(notes[start+3]->pitch() % 12) * 2 + ((opt &  8) >> 3)]);
-                  undoChangeTpc(notes[start+4], tab[(notes[start+4]->pitch() % 12) * 2 + ((opt & 16) >> 4)]);
-                  undoChangeTpc(notes[start+5], tab[(notes[start+5]->pitch() % 12) * 2 + ((opt & 32) >> 5)]);
+            for (; i < 10; ++i) {
+                  p[i] = p[i-1];
+                  k[i] = k[i-1];
                   }
-            if (end == n) {
-                  int n = end - start;
-                  int k;
-                  switch(n - 6) {
-                        case 3:
-                              k = end - start - 3;
-                              undoChangeTpc(notes[end-3], tab[(notes[end-3]->pitch() % 12) * 2 + ((opt & (1<<k)) >> k)]);
-                        case 2:
-                              k = end - start - 2;
-                              undoChangeTpc(notes[end-2], tab[(notes[end-2]->pitch() % 12) * 2 + ((opt & (1<<k)) >> k)]);
-                        case 1:
-                              k = end - start - 1;
-                              undoChangeTpc(notes[end-1], tab[(notes[end-1]->pitch() % 12) * 2 + ((opt & (1<<k)) >> k)]);
-                        }
+            int opt = spellWindow(p, k);
+
+            // the first window sets its first six notes, every
+            // window notes 3 - 5 and the last one the rest
+            int from = start == 0 ? 0 : start + 3;
+            int to   = end == n ? end : start + 6;
+            for (int i = from; i < to; ++i)
+                  tpcs[i] = tpc(i - start, pitch[i], opt);
+            if (end == n)
                   break;
+            start += WINDOW_SHIFT;
+            }
+      return tpcs;
+      }
+
+//---------------------------------------------------------
+//   SpellJob
+//    notes of one staff to be spelled on a worker thread
+//---------------------------------------------------------
+
+struct SpellJob {
+      QList<Note*> notes;
+      QVector<int> pitch;
+      QVector<int> key;
+      QVector<int> tpc;
+
+      void append(Note* note);
+      };
+
+void SpellJob::append(Note* note)
+      {
+      int tick = note->chord()->tick();
+      int k    = note->staff()->keymap()->key(tick).accidentalType() + 7;
+      if (k < 0 || k > 14) {
+            qDebug("illegal key at tick %d: %d", tick, k - 7);
+            k = 7;
+            }
+      notes.append(note);
+      pitch.append(note->pitch());
+      key.append(k);
+      }
+
+static void spellJob(SpellJob& job)
+      {
+      job.tpc = spellNotes(job.pitch, job.key);
+      }
+
+//---------------------------------------------------------
+//   spellJobs
+//    spell all jobs in parallel and apply the result as
+//    one undo command
+//---------------------------------------------------------
+
+static void spellJobs(Score* score, QList<SpellJob>& jobs)
+      {
+      if (jobs.size() > 1)
+            QtConcurrent::blockingMap(jobs, spellJob);
+      else if (jobs.size() == 1)
+            spellJob(jobs[0]);
+      QList<Note*> notes;
+      QList<int> tpcs;
+      foreach(const SpellJob& job, jobs) {
+            notes.append(job.notes);
+            for (int i = 0; i < job.tpc.size(); ++i)
+                  tpcs.append(job.tpc[i]);
+            }
+      score->undoChangeTpcs(notes, tpcs);
+      }
+
+//---------------------------------------------------------
+//   spellNotelist
+//---------------------------------------------------------
+
+void Score::spellNotelist(QList<Note*>& notes)
+      {
+      QList<SpellJob> jobs;
+      jobs.append(SpellJob());
+      foreach(Note* note, notes)
+            jobs[0].append(note);
+      spellJobs(this, jobs);
+      }
+
+//---------------------------------------------------------
+//   spell
+//    respell all staves, one worker thread per staff
+//---------------------------------------------------------
+
+void Score::spell()
+      {
+      spell(0, nstaves(), firstSegment(), 0);
+      }
+
+void Score::spell(int startStaff, int endStaff, Segment* startSegment, Segment* endSegment)
+      {
+      QList<SpellJob> jobs;
+      for (int i = startStaff; i < endStaff; ++i) {
+            jobs.append(SpellJob());
+            SpellJob& job = jobs.last();
+            int strack = i * VOICES;
+            int etrack = strack + VOICES;
+            for (Segment* s = startSegment; s && s != endSegment; s = s->next1()) {
+                  for (int track = strack; track < etrack; ++track) {
+                        Element* e = s->element(track);
+                        if (e && e->type() == Element::CHORD) {
+                              foreach(Note* note, static_cast<Chord*>(e)->notes())
+                                    job.append(note);
+                              }
+                        }
                   }
-            // advance to next window
-            start += 3;
             }
+      spellJobs(this, jobs);
       }
 
 //---------------------------------------------------------
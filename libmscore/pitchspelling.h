@@ -56,6 +56,7 @@ extern int pitch2tpc(int pitch, int key, int prefer);
 extern void spell(QList<Event>& notes, int);
 extern void spell(QList<Note*>& notes);
 extern int computeWindow(const QList<Note*>& notes, int start, int end);
+extern QVector<int> spellNotes(const QVector<int>& pitch, const QVector<int>& key);
 extern int tpc(int idx, int pitch, int opt);
 extern QString tpc2name(int tpc, NoteSpellingType spelling, bool lowerCase);
 extern void tpc2name(int tpc, NoteSpellingType spelling, bool lowerCase, QString& s, QString& acc);
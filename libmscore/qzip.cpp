@@ -452,7 +452,8 @@ public:
         : QZipPrivate(device, ownDev),
         status(QZipWriter::NoError),
         permissions(QFile::ReadOwner | QFile::WriteOwner),
-        compressionPolicy(QZipWriter::AlwaysCompress)
+        compressionPolicy(QZipWriter::AlwaysCompress),
+        inEntry(false)
     {
     }
 
@@ -463,6 +464,19 @@ public:
     enum EntryType { Directory, File, Symlink };
 
     void addEntry(EntryType type, const QString &fileName, const QByteArray &contents);
+
+    // file entry written in pieces by startFile()/writeFileData()/endFile()
+    bool inEntry;
+    bool entryCompressed;
+    FileHeader entry;
+    z_stream entryStream;
+    uint entryCrc;
+    uint entrySize;
+    uint entryCompressedSize;
+
+    bool startEntry(const QString &fileName);
+    void writeEntry(const char *data, qint64 len, int flush);
+    void endEntry();
 };
 
 LocalFileHeader CentralFileHeader::toLocalHeader() const
@@ -580,6 +594,8 @@ void QZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
     ZDEBUG() << "adding" << entryTypes[type] <<":" << fileName.toUtf8().data() << (type == 2 ? QByteArray(" -> " + contents).constData() : "");
 #endif
 
+    if (inEntry)
+        endEntry();
     if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
         status = QZipWriter::FileOpenError;
         return;
@@ -665,6 +681,115 @@ void QZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
     dirtyFileTree = true;
 }
 
+/*
+    Starts a file entry whose size is not known in advance. The local
+    header is written with zero sizes and crc and rewritten by endEntry().
+*/
+bool QZipWriterPrivate::startEntry(const QString &fileName)
+{
+    if (inEntry)
+        endEntry();
+    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
+        status = QZipWriter::FileOpenError;
+        return false;
+    }
+    device->seek(start_of_directory);
+
+    FileHeader header;
+    memset(&header.h, 0, sizeof(CentralFileHeader));
+    writeUInt(header.h.signature, 0x02014b50);
+    writeUShort(header.h.version_needed, 0x14);
+    writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
+
+    entryCompressed = compressionPolicy != QZipWriter::NeverCompress;
+    if (entryCompressed) {
+        memset(&entryStream, 0, sizeof(z_stream));
+        if (deflateInit2(&entryStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            qWarning("QZip: cannot initialize compression, storing file");
+            entryCompressed = false;
+        }
+    }
+    if (entryCompressed)
+        writeUShort(header.h.compression_method, 8);
+
+    header.file_name = fileName.toLocal8Bit();
+    if (header.file_name.size() > 0xffff) {
+        qWarning("QZip: Filename too long, chopping it to 65535 characters");
+        header.file_name = header.file_name.left(0xffff);
+    }
+    writeUShort(header.h.file_name_length, header.file_name.length());
+    writeUShort(header.h.version_made, 3 << 8);
+    quint32 mode = permissionsToMode(permissions) | S_IFREG;
+    writeUInt(header.h.external_file_attributes, mode << 16);
+    writeUInt(header.h.offset_local_header, start_of_directory);
+
+    LocalFileHeader h = header.h.toLocalHeader();
+    device->write((const char *)&h, sizeof(LocalFileHeader));
+    device->write(header.file_name);
+
+    entry = header;
+    entryCrc = ::crc32(0, 0, 0);
+    entrySize = 0;
+    entryCompressedSize = 0;
+    inEntry = true;
+    return true;
+}
+
+void QZipWriterPrivate::writeEntry(const char *data, qint64 len, int flush)
+{
+    if (len > 0) {
+        entryCrc = ::crc32(entryCrc, (const uchar *)data, len);
+        entrySize += len;
+    }
+    if (!entryCompressed) {
+        if (len > 0 && device->write(data, len) != len)
+            status = QZipWriter::FileWriteError;
+        entryCompressedSize += len;
+        return;
+    }
+    uchar out[16384];
+    entryStream.next_in = (Bytef *)data;
+    entryStream.avail_in = (uInt)len;
+    for (;;) {
+        entryStream.next_out = out;
+        entryStream.avail_out = sizeof(out);
+        int res = deflate(&entryStream, flush);
+        if (res == Z_STREAM_ERROR) {
+            qWarning("QZip: compression failed");
+            status = QZipWriter::FileError;
+            break;
+        }
+        qint64 n = sizeof(out) - entryStream.avail_out;
+        if (n && device->write((const char *)out, n) != n)
+            status = QZipWriter::FileWriteError;
+        entryCompressedSize += n;
+        if (flush == Z_FINISH ? res == Z_STREAM_END : entryStream.avail_out != 0)
+            break;
+    }
+}
+
+void QZipWriterPrivate::endEntry()
+{
+    if (!inEntry)
+        return;
+    if (entryCompressed) {
+        writeEntry(0, 0, Z_FINISH);
+        deflateEnd(&entryStream);
+    }
+    writeUInt(entry.h.crc_32, entryCrc);
+    writeUInt(entry.h.compressed_size, entryCompressedSize);
+    writeUInt(entry.h.uncompressed_size, entrySize);
+    fileHeaders.append(entry);
+
+    start_of_directory = device->pos();
+    device->seek(readUInt(entry.h.offset_local_header));
+    LocalFileHeader h = entry.h.toLocalHeader();
+    device->write((const char *)&h, sizeof(LocalFileHeader));
+    device->seek(start_of_directory);
+    dirtyFileTree = true;
+    inEntry = false;
+}
+
 //////////////////////////////  Reader
 
 /*!
@@ -1202,6 +1327,34 @@ void QZipWriter::addFile(const QString &fileName, QIODevice *device)
         device->close();
 }
 
+/*!
+    Start a file \a fileName in the archive whose contents are passed
+    in pieces to writeFileData(). The file is deflated while it is written,
+    so the contents never have to be held in memory. The file is complete
+    after endFile(). No other file can be added in between.
+*/
+bool QZipWriter::startFile(const QString &fileName)
+{
+    return d->startEntry(fileName);
+}
+
+/*!
+    Append \a len bytes from \a data to the file started by startFile().
+*/
+void QZipWriter::writeFileData(const char *data, qint64 len)
+{
+    if (d->inEntry)
+        d->writeEntry(data, len, Z_NO_FLUSH);
+}
+
+/*!
+    Finish the file started by startFile().
+*/
+void QZipWriter::endFile()
+{
+    d->endEntry();
+}
+
 /*!
     Create a new directory in the archive with the specified \a dirName and
     the \a permissions;
@@ -1230,6 +1383,7 @@ void QZipWriter::addSymLink(const QString &fileName, const QString &destination)
 */
 void QZipWriter::close()
 {
+    d->endEntry();
     if (!(d->device->openMode() & QIODevice::WriteOnly)) {
         d->device->close();
         return;
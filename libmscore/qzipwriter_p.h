@@ -100,6 +100,10 @@ public:
 
     void addFile(const QString &fileName, QIODevice *device);
 
+    bool startFile(const QString &fileName);
+    void writeFileData(const char *data, qint64 len);
+    void endFile();
+
     void addDirectory(const QString &dirName);
 
     void addSymLink(const QString &fileName, const QString &destination);
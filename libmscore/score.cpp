@@ -287,6 +287,7 @@ void Score::init()
 
       _updateAll      = true;
       _layoutAll      = true;
+      _layoutDeferred = false;
       layoutFlags     = 0;
       _undoRedo       = false;
       _playNote       = false;
@@ -332,6 +333,7 @@ Score::Score()
       _tempomap = new TempoMap;
       _sigmap   = new TimeSigMap();
       _style    = *(MScore::defaultStyle());
+      _layoutStyle.init(_style);
       }
 
 Score::Score(const MStyle* s)
@@ -342,6 +344,7 @@ Score::Score(const MStyle* s)
       _tempomap = new TempoMap;
       _sigmap   = new TimeSigMap();
       _style    = *s;
+      _layoutStyle.init(_style);
       }
 
 //
@@ -367,6 +370,7 @@ Score::Score(Score* parent)
             if (f.open(QIODevice::ReadOnly))
                   _style.load(&f);
             }
+      _layoutStyle.init(_style);
       _synthesizerState = parent->_synthesizerState;
       }
 
@@ -744,44 +748,6 @@ bool Score::playlistDirty()
       return val;
       }
 
-//---------------------------------------------------------
-//   spell
-//---------------------------------------------------------
-
-void Score::spell()
-      {
-      for (int i = 0; i < nstaves(); ++i) {
-            QList<Note*> notes;
-            for (Segment* s = firstSegment(); s; s = s->next1()) {
-                  int strack = i * VOICES;
-                  int etrack = strack + VOICES;
-                  for (int track = strack; track < etrack; ++track) {
-                        Element* e = s->element(track);
-                        if (e && e->type() == Element::CHORD)
-                              notes.append(static_cast<Chord*>(e)->notes());
-                        }
-                  }
-            spellNotelist(notes);
-            }
-      }
-
-void Score::spell(int startStaff, int endStaff, Segment* startSegment, Segment* endSegment)
-      {
-      for (int i = startStaff; i < endStaff; ++i) {
-            QList<Note*> notes;
-            for (Segment* s = startSegment; s && s != endSegment; s = s->next()) {
-                  int strack = i * VOICES;
-                  int etrack = strack + VOICES;
-                  for (int track = strack; track < etrack; ++track) {
-                        Element* e = s->element(track);
-                        if (e && e->type() == Element::CHORD)
-                              notes.append(static_cast<Chord*>(e)->notes());
-                        }
-                  }
-            spellNotelist(notes);
-            }
-      }
-
 //---------------------------------------------------------
 //   prevNote
 //---------------------------------------------------------
@@ -3421,10 +3387,14 @@ void Score::insertTime(int tick, int len)
       if (len == 0)
             return;
 
+      // changing the tick of a spanner moves it in the spanner map:
+      // collect the affected spanners before changing them
+      QList<Spanner*> sl;
       for (auto i : _spanner.map()) {
-            Spanner* s = i.second;
-            if (s->tick2() < tick)
-                  continue;
+            if (i.second->tick2() >= tick)
+                  sl.append(i.second);
+            }
+      foreach (Spanner* s, sl) {
             if (len > 0) {
                   if (tick > s->tick() && tick < s->tick2()) {
                         //
@@ -170,6 +170,7 @@ struct MidiMapping {
 struct MidiInputEvent {
       int pitch;
       bool chord;
+      bool previewed;         // already sounding, do not play again
       };
 
 //---------------------------------------------------------
@@ -286,6 +287,7 @@ class Score : public QObject {
 
       InputState _is;
       MStyle _style;
+      LayoutStyle _layoutStyle;     // typed copy of _style for layout
       QList<StaffType**> _staffTypes;
 
       QFileInfo info;
@@ -301,6 +303,7 @@ class Score : public QObject {
 
       bool _updateAll;
       bool _layoutAll;        ///< do a complete relayout
+      bool _layoutDeferred;   ///< part score not shown, layout is stale
 
       bool _undoRedo;         ///< true if in processing a undo/redo
       bool _playNote;         ///< play selected note after command
@@ -404,6 +407,7 @@ class Score : public QObject {
       bool doReLayout();
       Measure* skipEmptyMeasures(Measure*, System*);
 
+      void layoutStage1();
       void layoutStage2();
       void layoutStage3();
       void beamGraceNotes(Chord*);
@@ -490,6 +494,7 @@ class Score : public QObject {
       void undoChangePitch(Note* note, int pitch, int tpc, int line/*, int fret, int string*/);
       void spellNotelist(QList<Note*>& notes);
       void undoChangeTpc(Note* note, int tpc);
+      void undoChangeTpcs(const QList<Note*>& notes, const QList<int>& tpcs);
       void undoChangeChordRestLen(ChordRest* cr, const TDuration&);
       void undoChangeEndBarLineType(Measure*, BarLineType);
       void undoChangeBarLineSpan(Staff*, int span, int spanFrom, int spanTo);
@@ -570,6 +575,9 @@ class Score : public QObject {
       void setUpdateAll(bool v = true) { _updateAll = v;   }
       void setLayoutAll(bool val);
       bool layoutAll() const           { return _layoutAll; }
+      bool layoutDeferred() const      { return _layoutDeferred; }
+      bool doLayoutIfNeeded();
+      void ensureLayout();
       void addRefresh(const QRectF& r) { refresh |= r;     }
       const QRectF& getRefresh() const { return refresh;     }
 
@@ -658,7 +666,8 @@ class Score : public QObject {
 
       MStyle* style()                          { return &_style;                  }
       const MStyle* style() const              { return &_style;                  }
-      void setStyle(const MStyle& s)           { _style = s;                      }
+      void setStyle(const MStyle& s)           { _style = s; _layoutStyle.init(_style); }
+      const LayoutStyle& layoutStyle() const   { return _layoutStyle;             }
       bool loadStyle(const QString&);
       bool saveStyle(const QString&);
 
@@ -810,6 +819,7 @@ class Score : public QObject {
       void enqueueMidiEvent(MidiInputEvent ev) { midiInputQueue.enqueue(ev); }
 
       Q_INVOKABLE void doLayout();
+      void updateLayoutData();
       void layoutSystems();
       void layoutSystems2();
       void layoutLinear();
@@ -922,6 +932,7 @@ class Score : public QObject {
       Q_INVOKABLE void appendMeasures(int);
       Q_INVOKABLE void addText(const QString&, const QString&);
       Q_INVOKABLE Ms::Cursor* newCursor();
+      void layoutMinWidthElements(Segment* fs);
       qreal computeMinWidth(Segment* fs);
       void updateBarLineSpans(int idx, int linesOld, int linesNew);
       Sym& sym(int id) { return symbols[symIdx()][id]; }
@@ -929,6 +940,7 @@ class Score : public QObject {
       qreal noteHeadWidth() const            { return _noteHeadWidth; }
 
       const std::multimap<int, Spanner*>& spanner() const { return _spanner.map(); }
+      SpannerMap& spannerMap() { return _spanner; }
       Spanner* findSpanner(int id) const;
       bool isSpannerStartEnd(int tick, int track) const;
       void removeSpanner(Spanner*);
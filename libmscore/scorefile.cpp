@@ -43,6 +43,7 @@
 #include "imageStore.h"
 #include "audio.h"
 #include "barline.h"
+#include "symbatch.h"
 #include "libmscore/qzipreader_p.h"
 #include "libmscore/qzipwriter_p.h"
 #ifdef Q_OS_WIN
@@ -438,8 +439,11 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
       //
       // save audio
       //
-      if (_audio)
+      if (_audio) {
             uz.addFile("audio.ogg", _audio->data());
+            if (!_audio->peaks().isEmpty())
+                  uz.addFile("audio.peaks", _audio->peaks());
+            }
 
       QBuffer dbuf;
       dbuf.open(QIODevice::ReadWrite);
@@ -531,6 +535,11 @@ void Score::saveFile(QIODevice* f, bool msczFormat, bool onlySelection)
       {
       if(!MScore::testMode)
             MScore::testMode = enableTestMode;
+      if (!onlySelection) {
+            // part scores are written with their layout
+            foreach(Excerpt* excerpt, _excerpts)
+                  excerpt->score()->ensureLayout();
+            }
       Xml xml(f);
       xml.writeOmr = msczFormat;
       xml.header();
@@ -627,6 +636,7 @@ Score::FileError Score::loadCompressedMsc(QString name, bool ignoreVersionError)
       if (_audio) {
             QByteArray dbuf = uz.fileData("audio.ogg");
             _audio->setData(dbuf);
+            _audio->setPeaks(uz.fileData("audio.peaks"));
             }
       return retval;
       }
@@ -1020,14 +1030,12 @@ void Score::print(QPainter* painter, int pageNo)
       {
       _printing  = true;
       Page* page = pages().at(pageNo);
-      QRectF fr  = page->abbox();
 
-      QList<Element*> ell = page->items(fr);
-      qStableSort(ell.begin(), ell.end(), elementLessThan);
-      foreach(const Element* e, ell) {
-            e->itemDiscovered = 0;
+      SymBatch batch(painter);
+      foreach(const Element* e, page->displayList()) {
             if (!e->visible())
                   continue;
+            batch.setZ(e->z());
             painter->save();
             painter->translate(e->pagePos());
             e->draw(painter);
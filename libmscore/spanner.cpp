@@ -165,6 +165,34 @@ Spanner::~Spanner()
             delete ss;
       }
 
+//---------------------------------------------------------
+//   setTick
+//    keep the spanner map of the score in sync
+//---------------------------------------------------------
+
+void Spanner::setTick(int v)
+      {
+      if (_tick == v)
+            return;
+      int oldTick = _tick;
+      _tick = v;
+      if (score())
+            score()->spannerMap().changeTick(this, oldTick);
+      }
+
+//---------------------------------------------------------
+//   setTick2
+//---------------------------------------------------------
+
+void Spanner::setTick2(int v)
+      {
+      if (_tick2 == v)
+            return;
+      _tick2 = v;
+      if (score())
+            score()->spannerMap().changeTick(this, _tick);
+      }
+
 //---------------------------------------------------------
 //   add
 //---------------------------------------------------------
@@ -121,10 +121,10 @@ class Spanner : public Element {
       virtual void setScore(Score* s);
 
       int tick() const         { return _tick;          }
-      void setTick(int v)      { _tick = v;             }
+      void setTick(int v);
       int tickLen() const      { return _tick2 - _tick; }
       int tick2() const        { return _tick2;         }
-      void setTick2(int v)     { _tick2 = v;            }
+      void setTick2(int v);
 
       int id() const           { return _id; }
       void setId(int v)        { _id = v;    }
@@ -22,20 +22,245 @@ namespace Ms {
 SpannerMap::SpannerMap()
       : std::multimap<int, Spanner*>()
       {
-      dirty = true;
+      root = 0;
+      seed = 2463534242u;
+      }
+
+SpannerMap::~SpannerMap()
+      {
+      deleteTree(root);
+      }
+
+//---------------------------------------------------------
+//   random
+//    xorshift generator for node priorities
+//---------------------------------------------------------
+
+unsigned SpannerMap::random()
+      {
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+      return seed;
+      }
+
+//---------------------------------------------------------
+//   less
+//    tree order: start tick, then spanner address
+//---------------------------------------------------------
+
+bool SpannerMap::less(int start1, const Spanner* s1, int start2, const Spanner* s2)
+      {
+      if (start1 != start2)
+            return start1 < start2;
+      return std::less<const Spanner*>()(s1, s2);
       }
 
 //---------------------------------------------------------
 //   update
+//    recompute maxStop of n from its children
+//---------------------------------------------------------
+
+void SpannerMap::update(Node* n)
+      {
+      int m = n->stop;
+      if (n->left && n->left->maxStop > m)
+            m = n->left->maxStop;
+      if (n->right && n->right->maxStop > m)
+            m = n->right->maxStop;
+      n->maxStop = m;
+      }
+
+//---------------------------------------------------------
+//   rotateLeft
+//---------------------------------------------------------
+
+SpannerMap::Node* SpannerMap::rotateLeft(Node* n)
+      {
+      Node* r  = n->right;
+      n->right = r->left;
+      r->left  = n;
+      update(n);
+      update(r);
+      return r;
+      }
+
+//---------------------------------------------------------
+//   rotateRight
+//---------------------------------------------------------
+
+SpannerMap::Node* SpannerMap::rotateRight(Node* n)
+      {
+      Node* l  = n->left;
+      n->left  = l->right;
+      l->right = n;
+      update(n);
+      update(l);
+      return l;
+      }
+
+//---------------------------------------------------------
+//   treeInsert
+//    insert n into the subtree at root and return the
+//    new subtree root
+//---------------------------------------------------------
+
+SpannerMap::Node* SpannerMap::treeInsert(Node* root, Node* n)
+      {
+      if (!root)
+            return n;
+      if (less(n->start, n->value, root->start, root->value)) {
+            root->left = treeInsert(root->left, n);
+            if (root->left->priority > root->priority)
+                  return rotateRight(root);
+            }
+      else {
+            root->right = treeInsert(root->right, n);
+            if (root->right->priority > root->priority)
+                  return rotateLeft(root);
+            }
+      update(root);
+      return root;
+      }
+
+//---------------------------------------------------------
+//   merge
+//    join two subtrees; all keys in a are less than
+//    the keys in b
+//---------------------------------------------------------
+
+SpannerMap::Node* SpannerMap::merge(Node* a, Node* b)
+      {
+      if (!a)
+            return b;
+      if (!b)
+            return a;
+      if (a->priority > b->priority) {
+            a->right = merge(a->right, b);
+            update(a);
+            return a;
+            }
+      b->left = merge(a, b->left);
+      update(b);
+      return b;
+      }
+
+//---------------------------------------------------------
+//   treeRemove
+//    unlink the node for (start, s) from the subtree at
+//    root and return the new subtree root; the unlinked
+//    node is returned in *removed
+//---------------------------------------------------------
+
+SpannerMap::Node* SpannerMap::treeRemove(Node* root, int start, const Spanner* s, Node** removed)
+      {
+      if (!root)
+            return 0;
+      if (root->value == s && root->start == start) {
+            *removed = root;
+            return merge(root->left, root->right);
+            }
+      if (less(start, s, root->start, root->value))
+            root->left = treeRemove(root->left, start, s, removed);
+      else
+            root->right = treeRemove(root->right, start, s, removed);
+      update(root);
+      return root;
+      }
+
+//---------------------------------------------------------
+//   deleteTree
+//---------------------------------------------------------
+
+void SpannerMap::deleteTree(Node* n)
+      {
+      if (!n)
+            return;
+      deleteTree(n->left);
+      deleteTree(n->right);
+      delete n;
+      }
+
+//---------------------------------------------------------
+//   insertInterval
+//---------------------------------------------------------
+
+void SpannerMap::insertInterval(Spanner* s, int start, int stop)
+      {
+      Node* n     = new Node;
+      n->start    = start;
+      n->stop     = stop;
+      n->maxStop  = stop;
+      n->priority = random();
+      n->value    = s;
+      n->left     = 0;
+      n->right    = 0;
+      root = treeInsert(root, n);
+      }
+
+//---------------------------------------------------------
+//   removeInterval
+//---------------------------------------------------------
+
+bool SpannerMap::removeInterval(Spanner* s, int start)
+      {
+      Node* n = 0;
+      root = treeRemove(root, start, s, &n);
+      delete n;
+      return n != 0;
+      }
+
+//---------------------------------------------------------
+//   removeFromMap
+//---------------------------------------------------------
+
+bool SpannerMap::removeFromMap(Spanner* s, int tick)
+      {
+      auto range = equal_range(tick);
+      for (auto i = range.first; i != range.second; ++i) {
+            if (i->second == s) {
+                  erase(i);
+                  return true;
+                  }
+            }
+      return false;
+      }
+
+//---------------------------------------------------------
+//   findOverlapping
+//    collect intervals in subtree n which overlap
+//    (start, stop) in start tick order
+//---------------------------------------------------------
+
+void SpannerMap::findOverlapping(const Node* n, int start, int stop)
+      {
+      if (!n || n->maxStop < start)
+            return;
+      findOverlapping(n->left, start, stop);
+      if (n->start > stop)
+            return;
+      if (n->stop >= start)
+            results.push_back(Interval<Spanner*>(n->start, n->stop, n->value));
+      findOverlapping(n->right, start, stop);
+      }
+
+//---------------------------------------------------------
+//   findContained
+//    collect intervals in subtree n which are contained
+//    in (start, stop) in start tick order
 //---------------------------------------------------------
 
-void SpannerMap::update() const
+void SpannerMap::findContained(const Node* n, int start, int stop)
       {
-      std::vector< ::Interval<Spanner*> > intervals;
-      for (auto i : *this)
-            intervals.push_back(Interval<Spanner*>(i.second->tick(), i.second->tick2(), i.second));
-      tree = IntervalTree<Spanner*>(intervals);
-      dirty = false;
+      if (!n || n->maxStop < start)
+            return;
+      if (n->start >= start)
+            findContained(n->left, start, stop);
+      if (n->start > stop)
+            return;
+      if (n->start >= start && n->stop <= stop)
+            results.push_back(Interval<Spanner*>(n->start, n->stop, n->value));
+      findContained(n->right, start, stop);
       }
 
 //---------------------------------------------------------
@@ -44,9 +269,8 @@ void SpannerMap::update() const
 
 const std::vector<Interval<Spanner*>>& SpannerMap::findContained(int start, int stop)
       {
-      if (dirty)
-            update();
-      tree.findContained(start, stop, results);
+      results.clear();
+      findContained(root, start, stop);
       return results;
       }
 
@@ -56,9 +280,8 @@ const std::vector<Interval<Spanner*>>& SpannerMap::findContained(int start, int
 
 const std::vector<Interval<Spanner*>>& SpannerMap::findOverlapping(int start, int stop)
       {
-      if (dirty)
-            update();
-      tree.findOverlapping(start, stop, results);
+      results.clear();
+      findOverlapping(root, start, stop);
       return results;
       }
 
@@ -69,7 +292,7 @@ const std::vector<Interval<Spanner*>>& SpannerMap::findOverlapping(int start, in
 void SpannerMap::addSpanner(Spanner* s)
       {
       insert(std::pair<int,Spanner*>(s->tick(), s));
-      dirty = true;
+      insertInterval(s, s->tick(), s->tick2());
       }
 
 //---------------------------------------------------------
@@ -78,16 +301,31 @@ void SpannerMap::addSpanner(Spanner* s)
 
 bool SpannerMap::removeSpanner(Spanner* s)
       {
-      for (auto i = begin(); i != end(); ++i) {
-            if (i->second == s) {
-                  erase(i);
-                  dirty = true;
-                  return true;
-                  }
+      if (removeFromMap(s, s->tick())) {
+            removeInterval(s, s->tick());
+            return true;
             }
       qDebug("Score::removeSpanner: %s not found", s->name());
       return false;
       }
 
+//---------------------------------------------------------
+//   changeTick
+//    called by Spanner after tick() or tick2() changed;
+//    oldTick is the start tick the spanner was
+//    registered with
+//---------------------------------------------------------
+
+void SpannerMap::changeTick(Spanner* s, int oldTick)
+      {
+      if (!removeInterval(s, oldTick))
+            return;                 // not in this map
+      if (oldTick != s->tick()) {
+            removeFromMap(s, oldTick);
+            insert(std::pair<int,Spanner*>(s->tick(), s));
+            }
+      insertInterval(s, s->tick(), s->tick2());
+      }
+
 }     // namespace Ms
 
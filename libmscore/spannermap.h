@@ -22,17 +22,48 @@ class Spanner;
 
 //---------------------------------------------------------
 //   SpannerMap
+//    spanners sorted by start tick; the tick ranges are
+//    also kept in an interval tree (a treap augmented
+//    with the maximum stop tick of every subtree) which
+//    is updated incrementally on add and remove
 //---------------------------------------------------------
 
 class SpannerMap : std::multimap<int, Spanner*> {
-      mutable bool dirty;
-      mutable IntervalTree<Spanner*> tree;
+      struct Node {
+            int start;
+            int stop;
+            int maxStop;            // maximum stop tick in this subtree
+            unsigned priority;
+            Spanner* value;
+            Node* left;
+            Node* right;
+            };
+
+      Node* root;
+      unsigned seed;
       std::vector< ::Interval<Spanner*> > results;
 
-      void update() const;
+      unsigned random();
+      static bool less(int start1, const Spanner* s1, int start2, const Spanner* s2);
+      static void update(Node*);
+      static Node* rotateLeft(Node*);
+      static Node* rotateRight(Node*);
+      static Node* treeInsert(Node* root, Node* n);
+      static Node* merge(Node* a, Node* b);
+      static Node* treeRemove(Node* root, int start, const Spanner* s, Node** removed);
+      static void deleteTree(Node*);
+      void findOverlapping(const Node*, int start, int stop);
+      void findContained(const Node*, int start, int stop);
+      void insertInterval(Spanner*, int start, int stop);
+      bool removeInterval(Spanner*, int start);
+      bool removeFromMap(Spanner*, int tick);
+
+      SpannerMap(const SpannerMap&);
+      SpannerMap& operator=(const SpannerMap&);
 
    public:
       SpannerMap();
+      ~SpannerMap();
       const std::vector< ::Interval<Spanner*> >& findContained(int start, int stop);
       const std::vector< ::Interval<Spanner*> >& findOverlapping(int start, int stop);
       const std::multimap<int, Spanner*>& map() const { return *this; }
@@ -42,6 +73,7 @@ class SpannerMap : std::multimap<int, Spanner*> {
       std::multimap<int,Spanner*>::const_iterator cend() const  { return std::multimap<int, Spanner*>::cend(); }
       void addSpanner(Spanner* s);
       bool removeSpanner(Spanner* s);
+      void changeTick(Spanner* s, int oldTick);
       };
 
 }     // namespace Ms
@@ -11,6 +11,7 @@
 //=============================================================================
 
 #include <unordered_map>
+#include <atomic>
 #include "mscore.h"
 #include "style.h"
 #include "style_p.h"
@@ -1239,9 +1240,39 @@ StyleVal::StyleVal(const QString& name, const QString& val)
 
 StyleVal MStyle::value(StyleIdx idx) const
       {
+      return val(idx);
+      }
+
+//---------------------------------------------------------
+//   val
+//    access without copying the StyleVal
+//---------------------------------------------------------
+
+static std::atomic<int> styleLookups(0);
+
+const StyleVal& MStyle::val(StyleIdx idx) const
+      {
+      if (MScore::debugMode)
+            styleLookups.fetch_add(1, std::memory_order_relaxed);
       return d->_values[idx];
       }
 
+//---------------------------------------------------------
+//   lookups
+//    number of style values read since the last
+//    resetLookups(); only counted in debug mode
+//---------------------------------------------------------
+
+int MStyle::lookups()
+      {
+      return styleLookups;
+      }
+
+void MStyle::resetLookups()
+      {
+      styleLookups = 0;
+      }
+
 //---------------------------------------------------------
 //   isDefault
 //---------------------------------------------------------
@@ -1528,7 +1559,7 @@ void MStyle::set(StyleIdx t, MScore::Direction val)
 
 Spatium MStyle::valueS(StyleIdx idx) const
       {
-      return value(idx).toSpatium();
+      return val(idx).toSpatium();
       }
 
 //---------------------------------------------------------
@@ -1537,7 +1568,7 @@ Spatium MStyle::valueS(StyleIdx idx) const
 
 QString MStyle::valueSt(StyleIdx idx) const
       {
-      return value(idx).toString();
+      return val(idx).toString();
       }
 
 //---------------------------------------------------------
@@ -1546,7 +1577,7 @@ QString MStyle::valueSt(StyleIdx idx) const
 
 bool MStyle::valueB(StyleIdx idx) const
       {
-      return value(idx).toBool();
+      return val(idx).toBool();
       }
 
 //---------------------------------------------------------
@@ -1555,7 +1586,7 @@ bool MStyle::valueB(StyleIdx idx) const
 
 qreal MStyle::valueD(StyleIdx idx) const
       {
-      return value(idx).toDouble();
+      return val(idx).toDouble();
       }
 
 //---------------------------------------------------------
@@ -1564,7 +1595,30 @@ qreal MStyle::valueD(StyleIdx idx) const
 
 int MStyle::valueI(StyleIdx idx) const
       {
-      return value(idx).toInt();
+      return val(idx).toInt();
+      }
+
+//---------------------------------------------------------
+//   LayoutStyle::init
+//---------------------------------------------------------
+
+void LayoutStyle::init(const MStyle& s)
+      {
+      qreal sp = s.spatium();
+      minNoteDistance         = s.valueS(ST_minNoteDistance).val()         * sp;
+      barNoteDistance         = s.valueS(ST_barNoteDistance).val()         * sp;
+      barAccidentalDistance   = s.valueS(ST_barAccidentalDistance).val()   * sp;
+      noteBarDistance         = s.valueS(ST_noteBarDistance).val()         * sp;
+      clefLeftMargin          = s.valueS(ST_clefLeftMargin).val()          * sp;
+      clefKeyRightMargin      = s.valueS(ST_clefKeyRightMargin).val()      * sp;
+      clefBarlineDistance     = s.valueS(ST_clefBarlineDistance).val()     * sp;
+      minHarmonyDistance      = s.valueS(ST_minHarmonyDistance).val()      * sp;
+      lyricsMinBottomDistance = s.valueS(ST_lyricsMinBottomDistance).val() * sp;
+      accidentalDistance      = s.valueS(ST_accidentalDistance).val()      * sp;
+      accidentalNoteDistance  = s.valueS(ST_accidentalNoteDistance).val()  * sp;
+      minMeasureWidth         = s.valueS(ST_minMeasureWidth).val()         * sp;
+      measureSpacing          = s.valueD(ST_measureSpacing);
+      linearStretch           = s.valueD(ST_linearStretch);
       }
 
 //---------------------------------------------------------
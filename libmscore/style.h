@@ -383,6 +383,8 @@ class StyleData;
 class MStyle {
       QSharedDataPointer<StyleData> d;
 
+      const StyleVal& val(StyleIdx idx) const;
+
    public:
       MStyle();
       MStyle(const MStyle&);
@@ -425,6 +427,34 @@ class MStyle {
       void setSpatium(qreal v);
       ArticulationAnchor articulationAnchor(int id) const;
       void setArticulationAnchor(int id, ArticulationAnchor val);
+
+      static int lookups();
+      static void resetLookups();
+      };
+
+//---------------------------------------------------------
+//   LayoutStyle
+//    plain copy of the style values read in the inner
+//    loops of layout; distances are in pixels
+//---------------------------------------------------------
+
+struct LayoutStyle {
+      qreal minNoteDistance;
+      qreal barNoteDistance;
+      qreal barAccidentalDistance;
+      qreal noteBarDistance;
+      qreal clefLeftMargin;
+      qreal clefKeyRightMargin;
+      qreal clefBarlineDistance;
+      qreal minHarmonyDistance;
+      qreal lyricsMinBottomDistance;
+      qreal accidentalDistance;
+      qreal accidentalNoteDistance;
+      qreal minMeasureWidth;
+      qreal measureSpacing;
+      qreal linearStretch;
+
+      void init(const MStyle&);
       };
 
 extern QVector<TextStyle> defaultTextStyles;
@@ -12,6 +12,7 @@
 
 #include "style.h"
 #include "sym.h"
+#include "symbatch.h"
 #include "utils.h"
 #include "score.h"
 #include "xml.h"
@@ -395,7 +396,7 @@ void Sym::genGlyphs(const QRawFont& rfont)
 //---------------------------------------------------------
 
 Sym::Sym(int c, int fid, qreal ax, qreal ay)
-   : _code(c), fontId(fid), _attach(ax * MScore::DPI/PPI, ay * MScore::DPI/PPI)
+   : _code(c), fontId(fid), _attach(ax * MScore::DPI/PPI, ay * MScore::DPI/PPI), _glyph(0)
       {
       QFont _font(fontId2font(fontId));
       QFontMetricsF fm(_font);
@@ -411,7 +412,7 @@ Sym::Sym(int c, int fid, qreal ax, qreal ay)
       }
 
 Sym::Sym(int c, int fid, const QPointF& a, const QRectF& b)
-   : _code(c), fontId(fid)
+   : _code(c), fontId(fid), _glyph(0)
       {
       qreal ds = MScore::DPI/PPI;
       _bbox.setRect(b.x() * ds, b.y() * ds, b.width() * ds, b.height() * ds);
@@ -422,6 +423,19 @@ Sym::Sym(int c, int fid, const QPointF& a, const QRectF& b)
 #endif
       }
 
+//---------------------------------------------------------
+//   initGlyph
+//    look up the glyph index for SymBatch
+//---------------------------------------------------------
+
+void Sym::initGlyph()
+      {
+      QRawFont rfont(fontId2RawFont(fontId));
+      _glyph = 0;
+      if (_code > 0 && rfont.isValid())
+            _glyph = rfont.glyphIndexesForString(toString()).value(0);
+      }
+
 //---------------------------------------------------------
 //   bbox
 //---------------------------------------------------------
@@ -437,6 +451,9 @@ const QRectF Sym::bbox(qreal mag) const
 
 void Sym::draw(QPainter* painter, qreal mag, const QPointF& pos) const
       {
+      SymBatch* batch = SymBatch::current();
+      if (batch && batch->add(painter, *this, mag, pos))
+            return;
       qreal imag = 1.0 / mag;
       painter->scale(mag, mag);
 #ifdef USE_GLYPHS
@@ -454,6 +471,9 @@ void Sym::draw(QPainter* painter, qreal mag, const QPointF& pos) const
 
 void Sym::draw(QPainter* painter, qreal mag) const
       {
+      SymBatch* batch = SymBatch::current();
+      if (batch && batch->add(painter, *this, mag, QPointF()))
+            return;
       qreal imag = 1.0 / mag;
       painter->scale(mag, mag);
 #ifdef USE_GLYPHS
@@ -487,6 +507,9 @@ QString Sym::toString() const
 
 void Sym::draw(QPainter* painter, qreal mag, const QPointF& pos, int n) const
       {
+      SymBatch* batch = SymBatch::current();
+      if (batch && batch->add(painter, *this, mag, pos, n))
+            return;
 #ifdef USE_GLYPHS
       QVector<quint32> indexes(n);
       QVector<QPointF> positions(n);
@@ -701,6 +724,8 @@ void initSymbols(int idx)
                         }
                   }
             }
+      for (int i = 0; i < lastSym; ++i)
+            symbols[idx][i].initGlyph();
       }
 }
 
@@ -310,6 +310,7 @@ class Sym {
       qreal w;
       QRectF _bbox;
       QPointF _attach;
+      quint32 _glyph;         // glyph index in fontId2RawFont(fontId), 0 if unknown
 
 #ifdef USE_GLYPHS
       QGlyphRun glyphs;       // cached values
@@ -321,7 +322,7 @@ class Sym {
       static QHash<QString, SymId> lnhash;
 
    public:
-      Sym() { _code = -1; }
+      Sym() { _code = -1; _glyph = 0; }
       Sym(int c, int fid, qreal x=0.0, qreal y=0.0);
       Sym(int c, int fid, const QPointF&, const QRectF&);
 
@@ -341,6 +342,8 @@ class Sym {
       QRectF getBbox() const               { return _bbox; }
       QPointF getAttach() const            { return _attach; }
       QString toString() const;
+      quint32 glyphIndex() const           { return _glyph; }
+      void initGlyph();
 
       static SymId name2id(const QString& s) { return lnhash.value(s, noSym); }     // return noSym if not found
       static const char* id2name(SymId id)   { return symNames[id];     }
@@ -0,0 +1,131 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "symbatch.h"
+#include "sym.h"
+
+namespace Ms {
+
+SymBatch* SymBatch::_current = 0;
+
+//---------------------------------------------------------
+//   qHash
+//---------------------------------------------------------
+
+uint qHash(const SymBatch::Key& k)
+      {
+      return uint(k.fontId) ^ (uint(k.scale * 1000.0) << 4) ^ uint(k.color);
+      }
+
+//---------------------------------------------------------
+//   SymBatch
+//    batches nest; only the innermost one collects
+//---------------------------------------------------------
+
+SymBatch::SymBatch(QPainter* p)
+      {
+      _painter   = p;
+      _prev      = _current;
+      _current   = this;
+      _z         = 0;
+      _symbols   = 0;
+      _drawCalls = 0;
+      }
+
+SymBatch::~SymBatch()
+      {
+      flush();
+      _current = _prev;
+      }
+
+//---------------------------------------------------------
+//   setZ
+//    flush if the stacking level changes
+//---------------------------------------------------------
+
+void SymBatch::setZ(int z)
+      {
+      if (z != _z) {
+            flush();
+            _z = z;
+            }
+      }
+
+//---------------------------------------------------------
+//   add
+//    Collect n copies of sym drawn at pos with the
+//    current painter state. Return false if the symbol
+//    cannot be batched and must be drawn directly.
+//---------------------------------------------------------
+
+bool SymBatch::add(QPainter* painter, const Sym& sym, qreal mag, const QPointF& pos, int n)
+      {
+      if (painter != _painter || sym.glyphIndex() == 0)
+            return false;
+      const QTransform& t = painter->worldTransform();
+      if (t.type() > QTransform::TxScale || t.m11() != t.m22() || t.m11() <= 0.0)
+            return false;
+      if (painter->opacity() != 1.0 || painter->compositionMode() != QPainter::CompositionMode_SourceOver)
+            return false;
+
+      Key key;
+      key.fontId = sym.getFontId();
+      key.scale  = t.m11() * mag;
+      key.color  = painter->pen().color().rgba();
+
+      int idx = _index.value(key, -1);
+      if (idx == -1) {
+            idx = _runs.size();
+            _index.insert(key, idx);
+            _runs.append(Run());
+            _runs[idx].key = key;
+            }
+      Run& run   = _runs[idx];
+      qreal is   = 1.0 / key.scale;
+      qreal step = sym.width(mag);
+      for (int i = 0; i < n; ++i) {
+            run.glyphs.append(sym.glyphIndex());
+            run.positions.append(t.map(pos + QPointF(step * i, 0.0)) * is);
+            }
+      _symbols += n;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   flush
+//    draw all collected symbols; the glyph positions are
+//    in device coordinates divided by the scale of the
+//    run, so the painter is only scaled
+//---------------------------------------------------------
+
+void SymBatch::flush()
+      {
+      if (_runs.isEmpty())
+            return;
+      _painter->save();
+      foreach (const Run& run, _runs) {
+            QGlyphRun glyphRun;
+            glyphRun.setRawFont(fontId2RawFont(run.key.fontId));
+            glyphRun.setGlyphIndexes(run.glyphs);
+            glyphRun.setPositions(run.positions);
+            _painter->setWorldTransform(QTransform::fromScale(run.key.scale, run.key.scale));
+            _painter->setPen(QColor::fromRgba(run.key.color));
+            _painter->drawGlyphRun(QPointF(), glyphRun);
+            ++_drawCalls;
+            }
+      _painter->restore();
+      _runs.clear();
+      _index.clear();
+      }
+
+}     // namespace Ms
+
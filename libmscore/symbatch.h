@@ -0,0 +1,83 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __SYMBATCH_H__
+#define __SYMBATCH_H__
+
+class QPainter;
+
+namespace Ms {
+
+class Sym;
+
+//---------------------------------------------------------
+//   SymBatch
+//    Collects the symbols drawn by Sym::draw() on one
+//    painter and draws them as one glyph run per font,
+//    scale and color instead of one drawText() call per
+//    symbol.
+//
+//    Symbols are flushed when the stacking level changes
+//    (elements are painted sorted by z) and when the
+//    batch is destroyed, so symbols stay below elements
+//    with a higher z. Symbols drawn with a rotated or
+//    mirrored transform or with opacity are painted
+//    directly.
+//
+//      SymBatch batch(painter);
+//      foreach (Element* e, elements) {
+//            batch.setZ(e->z());
+//            ... e->draw(painter);
+//            }
+//---------------------------------------------------------
+
+class SymBatch {
+      struct Key {
+            int fontId;
+            qreal scale;
+            QRgb color;
+            bool operator==(const Key& k) const {
+                  return fontId == k.fontId && scale == k.scale && color == k.color;
+                  }
+            };
+      struct Run {
+            Key key;
+            QVector<quint32> glyphs;
+            QVector<QPointF> positions;   // device coordinates / scale
+            };
+      friend uint qHash(const Key&);
+
+      QPainter* _painter;
+      SymBatch* _prev;
+      int _z;
+      QHash<Key, int> _index;       // index into _runs
+      QVector<Run> _runs;
+      int _symbols;                 // statistics
+      int _drawCalls;
+
+      static SymBatch* _current;
+
+   public:
+      SymBatch(QPainter*);
+      ~SymBatch();
+      void setZ(int z);
+      void flush();
+      bool add(QPainter*, const Sym&, qreal mag, const QPointF& pos, int n = 1);
+      int symbols() const     { return _symbols;   }
+      int drawCalls() const   { return _drawCalls; }
+
+      static SymBatch* current()    { return _current; }
+      };
+
+}     // namespace Ms
+#endif
+
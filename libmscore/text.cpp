@@ -25,6 +25,7 @@
 #include "segment.h"
 #include "mscore.h"
 #include "textframe.h"
+#include "textcache.h"
 
 namespace Ms {
 
@@ -66,21 +67,139 @@ SymCode charReplaceMap[] = {
 QTextCursor* Text::_cursor;
 
 //---------------------------------------------------------
-//   createDoc
+//   createDocument
+//    create an empty text document configured for
+//    unstyled text
 //---------------------------------------------------------
 
-void Text::createDoc()
+QTextDocument* Text::createDocument() const
       {
-      _doc = new QTextDocument(0);
-      _doc->setDocumentMargin(0);
-      _doc->setUseDesignMetrics(true);
-      _doc->setUndoRedoEnabled(true);
-      _doc->documentLayout()->setProperty("cursorWidth", QVariant(2));
-      QTextOption to = _doc->defaultTextOption();
+      QTextDocument* doc = new QTextDocument(0);
+      doc->setDocumentMargin(0);
+      doc->setUseDesignMetrics(true);
+      doc->setUndoRedoEnabled(true);
+      doc->documentLayout()->setProperty("cursorWidth", QVariant(2));
+      QTextOption to = doc->defaultTextOption();
       to.setUseDesignMetrics(true);
       to.setWrapMode(QTextOption::NoWrap);
-      _doc->setDefaultTextOption(to);
-      _doc->setDefaultFont(textStyle().font(spatium()));
+      doc->setDefaultTextOption(to);
+      doc->setDefaultFont(textStyle().font(spatium()));
+      return doc;
+      }
+
+//---------------------------------------------------------
+//   toDocument
+//    create a text document from _blocks
+//---------------------------------------------------------
+
+QTextDocument* Text::toDocument() const
+      {
+      QTextDocument* doc = createDocument();
+      if (!_html.isNull()) {
+            doc->setHtml(_html);
+            return doc;
+            }
+      QTextCursor c(doc);
+      c.setVisualNavigation(true);
+      c.movePosition(QTextCursor::Start);
+      bool first = true;
+      foreach (const TBlock& b, _blocks) {
+            QTextBlockFormat bf = c.blockFormat();
+            bf.setAlignment(b.align);
+            if (first) {
+                  c.setBlockFormat(bf);
+                  first = false;
+                  }
+            else
+                  c.insertBlock(bf);
+            foreach (const TFragment& f, b.fragments) {
+                  QTextCharFormat tf;
+                  tf.setFont(f.font);
+                  if (f.color.isValid())
+                        tf.setForeground(f.color);
+                  tf.setVerticalAlignment(f.valign);
+                  if (c.atBlockStart())
+                        c.setBlockCharFormat(tf);
+                  c.insertText(f.text, tf);
+                  }
+            }
+      doc->setModified(false);
+      return doc;
+      }
+
+//---------------------------------------------------------
+//   fromDocument
+//    convert doc into _blocks; return false if doc
+//    contains rich text which cannot be represented
+//    as styled runs (lists, tables, images, indents...)
+//---------------------------------------------------------
+
+bool Text::fromDocument(const QTextDocument* doc)
+      {
+      if (!doc->rootFrame()->childFrames().isEmpty())
+            return false;
+      QList<TBlock> blocks;
+      for (QTextBlock tb = doc->begin(); tb.isValid(); tb = tb.next()) {
+            if (tb.textList())
+                  return false;
+            QTextBlockFormat bf = tb.blockFormat();
+            if (bf.indent() || bf.textIndent() != 0.0
+               || bf.leftMargin() != 0.0 || bf.rightMargin() != 0.0
+               || bf.hasProperty(QTextFormat::BackgroundBrush))
+                  return false;
+            TBlock b;
+            b.align = bf.alignment() & Qt::AlignHorizontal_Mask;
+            for (QTextBlock::iterator i = tb.begin(); !i.atEnd(); ++i) {
+                  QTextFragment tf = i.fragment();
+                  if (!tf.isValid())
+                        continue;
+                  QTextCharFormat cf = tf.charFormat();
+                  if (cf.isImageFormat() || cf.isAnchor()
+                     || cf.hasProperty(QTextFormat::BackgroundBrush)
+                     || (cf.fontUnderline() && cf.underlineStyle() != QTextCharFormat::SingleUnderline))
+                        return false;
+                  TFragment f;
+                  f.text   = tf.text();
+                  if (f.text.contains(QChar::LineSeparator))
+                        return false;
+                  f.font   = cf.font();
+                  f.valign = cf.verticalAlignment();
+                  if (cf.hasProperty(QTextFormat::ForegroundBrush))
+                        f.color = cf.foreground().color();
+                  b.fragments.append(f);
+                  }
+            blocks.append(b);
+            }
+      _blocks = blocks;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   createDoc
+//    create _doc for editing
+//---------------------------------------------------------
+
+void Text::createDoc()
+      {
+      if (!_doc)
+            _doc = toDocument();
+      }
+
+//---------------------------------------------------------
+//   releaseDoc
+//    convert _doc back into styled runs and delete it
+//    if not editing
+//---------------------------------------------------------
+
+void Text::releaseDoc()
+      {
+      if (!_doc || editMode() || (_cursor && _cursor->document() == _doc))
+            return;
+      if (!fromDocument(_doc))
+            return;           // keep the document for complex rich text
+      _html = _doc->toHtml("utf-8");
+      delete _doc;
+      _doc = 0;
       }
 
 //---------------------------------------------------------
@@ -92,6 +211,7 @@ Text::Text(Score* s)
       {
       setFlag(ELEMENT_MOVABLE, true);
       _doc        = 0;
+      _baseLine   = 0.0;
       _styleIndex = TEXT_STYLE_DEFAULT;
       }
 
@@ -102,6 +222,10 @@ Text::Text(const Text& e)
             _doc = e._doc->clone();
       else
             _doc = 0;
+      _blocks     = e._blocks;
+      _runs       = e._runs;
+      _baseLine   = e._baseLine;
+      _html       = e._html;
       _styleIndex = e._styleIndex;
       }
 
@@ -130,11 +254,6 @@ void Text::setText(const QString& s)
 void Text::setUnstyledText(const QString& s)
       {
       Align align = textStyle().align();
-      _doc->clear();
-
-      QTextCursor c(_doc);
-      c.setVisualNavigation(true);
-      c.movePosition(QTextCursor::Start);
       Qt::Alignment a;
       if (align & ALIGN_HCENTER)
             a = Qt::AlignHCenter;
@@ -142,6 +261,27 @@ void Text::setUnstyledText(const QString& s)
             a = Qt::AlignRight;
       else
             a = Qt::AlignLeft;
+
+      if (!_doc) {
+            QFont font(textStyle().font(spatium()));
+            _blocks.clear();
+            _html = QString();
+            foreach (const QString& l, s.split(QRegExp("[\\n\\r\\x2029]"))) {
+                  TBlock b;
+                  b.align = a;
+                  if (!l.isEmpty())
+                        b.fragments.append(TFragment(l, font));
+                  _blocks.append(b);
+                  }
+            textChanged();
+            return;
+            }
+
+      _doc->clear();
+
+      QTextCursor c(_doc);
+      c.setVisualNavigation(true);
+      c.movePosition(QTextCursor::Start);
       QTextBlockFormat bf = c.blockFormat();
       bf.setAlignment(a);
       c.setBlockFormat(bf);
@@ -169,18 +309,41 @@ void Text::setText(const QTextDocumentFragment& f)
 void Text::setHtml(const QString& s)
       {
       setUnstyled();
-      _doc->clear();
+      if (_doc)
+            _doc->clear();
+      else
+            _doc = createDocument();
       _doc->setHtml(s);
+      releaseDoc();
       textChanged();
       }
 
+//---------------------------------------------------------
+//   blocksText
+//---------------------------------------------------------
+
+QString Text::blocksText() const
+      {
+      QString s;
+      for (int i = 0; i < _blocks.size(); ++i) {
+            if (i)
+                  s += QChar('\n');
+            foreach (const TFragment& f, _blocks[i].fragments)
+                  s += f.text;
+            }
+      s.replace(QChar::Nbsp, QChar(' '));
+      return s;
+      }
+
 //---------------------------------------------------------
 //   text
 //---------------------------------------------------------
 
 QString Text::text() const
       {
-      return styled() ? SimpleText::text() : _doc->toPlainText();
+      if (styled())
+            return SimpleText::text();
+      return _doc ? _doc->toPlainText() : blocksText();
       }
 
 //---------------------------------------------------------
@@ -189,7 +352,16 @@ QString Text::text() const
 
 QString Text::getHtml() const
       {
-      return styled() ? "" : _doc->toHtml("utf-8");
+      if (styled())
+            return "";
+      if (_doc)
+            return _doc->toHtml("utf-8");
+      if (_html.isNull()) {
+            QTextDocument* doc = toDocument();
+            _html = doc->toHtml("utf-8");
+            delete doc;
+            }
+      return _html;
       }
 
 //---------------------------------------------------------
@@ -229,7 +401,6 @@ void Text::layout1()
       if (styled())
             SimpleText::layout();
       else {
-            _doc->setDefaultFont(textStyle().font(spatium()));
             qreal w = -1.0;
 
             if (parent() && layoutToParentWidth()) {
@@ -241,17 +412,24 @@ void Text::layout1()
                         }
                   }
 
-            QTextOption to = _doc->defaultTextOption();
-            to.setUseDesignMetrics(true);
-            to.setWrapMode(w <= 0.0 ? QTextOption::NoWrap : QTextOption::WrapAtWordBoundaryOrAnywhere);
-            _doc->setDefaultTextOption(to);
-
-            if (w <= 0.0)
-                  w = _doc->idealWidth();
-            _doc->setTextWidth(w);
+            QSizeF size;
+            if (_doc) {
+                  _doc->setDefaultFont(textStyle().font(spatium()));
+                  QTextOption to = _doc->defaultTextOption();
+                  to.setUseDesignMetrics(true);
+                  to.setWrapMode(w <= 0.0 ? QTextOption::NoWrap : QTextOption::WrapAtWordBoundaryOrAnywhere);
+                  _doc->setDefaultTextOption(to);
+
+                  if (w <= 0.0)
+                        w = _doc->idealWidth();
+                  _doc->setTextWidth(w);
+                  size = _doc->size();
+                  _doc->setModified(false);
+                  }
+            else
+                  size = layoutBlocks(w);
 
             QPointF o;
-            QSizeF size(_doc->size());
             if (align() & ALIGN_BOTTOM) {
                   o.ry() += 3;
                   o.ry() -= size.height();
@@ -268,8 +446,6 @@ void Text::layout1()
             bbox().setRect(o.x(), o.y(), size.width(), size.height());
 
             setPos(textStyle().offset(spatium()));
-
-            _doc->setModified(false);
             }
 
       if (parent()) {
@@ -304,6 +480,56 @@ void Text::layout1()
             layoutFrame();
       }
 
+//---------------------------------------------------------
+//   layoutBlocks
+//    break the blocks into lines of width w (no wrapping
+//    if w <= 0) and position the shaped runs; returns
+//    the size of the text
+//---------------------------------------------------------
+
+QSizeF Text::layoutBlocks(qreal w)
+      {
+      QFont defaultFont(textStyle().font(spatium()));
+      QList<ShapedBlock> blocks;
+      qreal tw = qMax(w, 0.0);
+      foreach (const TBlock& b, _blocks) {
+            ShapedBlock sb = TextCache::layout(b, defaultFont, w);
+            if (w <= 0.0) {
+                  foreach (const ShapedLine& l, sb.lines)
+                        tw = qMax(tw, l.width);
+                  }
+            blocks.append(sb);
+            }
+
+      _runs.clear();
+      _baseLine = 0.0;
+      qreal y   = 0.0;
+      for (int i = 0; i < blocks.size(); ++i) {
+            const TBlock& b       = _blocks[i];
+            const ShapedBlock& sb = blocks[i];
+            for (int k = 0; k < sb.lines.size(); ++k) {
+                  const ShapedLine& l = sb.lines[k];
+                  qreal x = 0.0;
+                  if (b.align & Qt::AlignRight)
+                        x = tw - l.width;
+                  else if (b.align & Qt::AlignHCenter)
+                        x = (tw - l.width) * .5;
+                  if (i == 0 && k == 0)
+                        _baseLine = l.baseLine;
+                  foreach (const ShapedRun& sr, l.runs) {
+                        TRun r;
+                        r.glyphs = sr.glyphs;
+                        r.pos    = QPointF(x, y);
+                        r.rect   = sr.rect.translated(x, y);
+                        r.color  = b.fragments[sr.fragment].color;
+                        _runs.append(r);
+                        }
+                  }
+            y += sb.height;
+            }
+      return QSizeF(tw, y);
+      }
+
 //---------------------------------------------------------
 //   pageRectangle
 //---------------------------------------------------------
@@ -338,8 +564,22 @@ void Text::draw(QPainter* painter) const
             SimpleText::draw(painter);
             return;
             }
+      bool printing      = score() && score()->printing();
+      bool showInvisible = score() && score()->showInvisible();
+      if (!_doc) {
+            if ((printing || !showInvisible) && !visible())
+                  return;
+            QColor color(textColor());
+            painter->translate(bbox().topLeft());
+            foreach (const TRun& r, _runs) {
+                  painter->setPen(r.color.isValid() ? r.color : color);
+                  foreach (const QGlyphRun& g, r.glyphs)
+                        painter->drawGlyphRun(r.pos, g);
+                  }
+            painter->translate(-bbox().topLeft());
+            return;
+            }
       QAbstractTextDocumentLayout::PaintContext c;
-      bool printing = score() && score()->printing();
       if (_cursor
          && _doc
          && _cursor->document() == _doc
@@ -356,7 +596,7 @@ void Text::draw(QPainter* painter) const
       else
             c.cursorPosition = -1;
 
-      if ((printing || !score()->showInvisible()) && !visible())
+      if ((printing || !showInvisible) && !visible())
             return;
       c.palette.setColor(QPalette::Text, textColor());
 
@@ -404,7 +644,7 @@ void Text::writeProperties(Xml& xml, bool writeText) const
                   xml.tag("text", text());
             else {
                   xml.stag("html-data");
-                  xml.writeHtml(_doc->toHtml("utf-8"));
+                  xml.writeHtml(getHtml());
                   xml.etag();
                   }
             }
@@ -412,16 +652,15 @@ void Text::writeProperties(Xml& xml, bool writeText) const
 
 //---------------------------------------------------------
 //   isSimpleText
-//    check if _doc can be converted to simple text
+//    check if doc can be converted to simple text
 //---------------------------------------------------------
 
-bool Text::isSimpleText() const
+bool Text::isSimpleText(const QTextDocument* doc)
       {
-      if (_doc->blockCount() > 1)
+      if (doc->blockCount() > 1)
             return false;
       int n = 0;
-      QTextBlock b(_doc->firstBlock());
-      QTextBlock::iterator i(_doc->firstBlock().begin());
+      QTextBlock::iterator i(doc->firstBlock().begin());
       for (; !i.atEnd(); ++i)
             ++n;
       return n <= 1;
@@ -502,7 +741,7 @@ bool Text::readProperties(XmlReader& e)
       else if (tag == "styleName")          // obsolete, unstyled text
             e.skipCurrentElement(); // _styleName = val;
       else if (tag == "data")                  // obsolete
-            _doc->setHtml(e.readElementText());
+            setHtml(e.readElementText());
       else if (tag == "html") {
             QString s = Xml::htmlToString(e);
             setHtml(s);
@@ -527,19 +766,18 @@ bool Text::readProperties(XmlReader& e)
                   s.replace(QChar(0xe167), QString("%1%2").arg(QChar(0xd834)).arg(QChar(0xdd0b)));    // coda
                   s.replace(QChar(0xe168), QString("%1%2").arg(QChar(0xd834)).arg(QChar(0xdd0c)));    // varcoda
                   s.replace(QChar(0xe169), QString("%1%2").arg(QChar(0xd834)).arg(QChar(0xdd0c)));    // segno
-                  if (_doc == 0)
-                        createDoc();
+                  QTextDocument* doc = createDocument();
+                  doc->setHtml(s);
                   // import instrument names as unstyled html
                   if (_styleIndex != TEXT_STYLE_INSTRUMENT_SHORT
                      && _styleIndex != TEXT_STYLE_INSTRUMENT_LONG
-                     && isSimpleText()) {
-                        _doc->setHtml(s);
-                        QString s = _doc->toPlainText();
-                        delete _doc;
-                        _doc = 0;
+                     && isSimpleText(doc)) {
+                        QString s = doc->toPlainText();
+                        delete doc;
                         setText(s);
                         }
                   else {
+                        delete doc;
                         setUnstyled();
                         setHtml(s);
                         }
@@ -577,6 +815,8 @@ void Text::spatiumChanged(qreal oldVal, qreal newVal)
             return;
       qreal v = newVal / oldVal;
 
+      // rescaling is rare; do it on a temporary document
+      createDoc();
       QTextCursor c(_doc);
       QTextBlock cb = _doc->begin();
       while (cb.isValid()) {
@@ -597,6 +837,7 @@ void Text::spatiumChanged(qreal oldVal, qreal newVal)
                   }
             cb = cb.next();
             }
+      releaseDoc();
       }
 
 //---------------------------------------------------------
@@ -611,6 +852,7 @@ void Text::startEdit(MuseScoreView* view, const QPointF& p)
             return;
             }
       undoPushProperty(P_HTML_TEXT);
+      createDoc();
       _cursor = new QTextCursor(_doc);
       _cursor->setVisualNavigation(true);
       setCursor(p);
@@ -862,6 +1104,12 @@ QPainterPath Text::shape() const
             return SimpleText::shape();
       QPainterPath pp;
 
+      if (!_doc) {
+            foreach (const TRun& r, _runs)
+                  pp.addRect(r.rect.translated(bbox().topLeft()));
+            return pp;
+            }
+
       for (QTextBlock tb = _doc->begin(); tb.isValid(); tb = tb.next()) {
             QTextLayout* tl = tb.layout();
             int n = tl->lineCount();
@@ -884,6 +1132,8 @@ qreal Text::baseLine() const
       {
       if (styled())
             return SimpleText::baseLine();
+      if (!_doc)
+            return _baseLine;
       for (QTextBlock tb = _doc->begin(); tb.isValid(); tb = tb.next()) {
             const QTextLayout* tl = tb.layout();
             if (tl->lineCount()) {
@@ -958,6 +1208,8 @@ bool Text::setCursor(const QPointF& p, QTextCursor::MoveMode mode)
       QPointF pt  = p - canvasPos();
       if (!bbox().contains(pt))
             return false;
+      if (!_doc)
+            return true;
 
       int idx = _doc->documentLayout()->hitTest(pt, Qt::FuzzyHit);
       if (idx == -1)
@@ -1312,8 +1564,13 @@ void Text::clear()
       {
       if (styled())
             SimpleText::clear();
-      else
+      else if (_doc)
             _doc->clear();
+      else {
+            _blocks.clear();
+            _runs.clear();
+            _html = QString();
+            }
       }
 
 //---------------------------------------------------------
@@ -1329,11 +1586,19 @@ void Text::setTextStyleType(int st)
       _styleIndex = st;
       if (st != TEXT_STYLE_UNKNOWN)
             setTextStyle(score()->textStyle(st));
-      if (_doc && !_doc->isEmpty() && !editMode()) {
-            SimpleText::setText(_doc->toPlainText());
+      if (editMode())
+            return;
+      if (_doc) {
+            if (!_doc->isEmpty())
+                  SimpleText::setText(_doc->toPlainText());
             delete _doc;
             _doc = 0;
             }
+      else if (!_blocks.isEmpty())
+            SimpleText::setText(blocksText());
+      _blocks.clear();
+      _runs.clear();
+      _html = QString();
       }
 
 //---------------------------------------------------------
@@ -1345,11 +1610,14 @@ void Text::setUnstyled()
       if (!styled())
             return;
       _styleIndex = TEXT_STYLE_UNSTYLED;
-      createDoc();
+      _blocks.clear();
+      _html = QString();
       if (!SimpleText::isEmpty())
             setUnstyledText(SimpleText::text());
-      if (editMode())
+      if (editMode()) {
+            createDoc();
             _cursor = new QTextCursor(_doc);
+            }
       }
 
 //---------------------------------------------------------
@@ -1366,6 +1634,7 @@ QTextCursor* Text::startCursorEdit()
             qDebug("Text::startCursorEdit(): cursor already active\n");
             return 0;
             }
+      createDoc();
       _cursor = new QTextCursor(_doc);
       return _cursor;
       }
@@ -1381,6 +1650,7 @@ void Text::endEdit()
             SimpleText::endEdit();
       else {
             endCursorEdit();
+            releaseDoc();
             layoutEdit();
 
             if (links()) {
@@ -1402,6 +1672,7 @@ void Text::endCursorEdit()
       {
       delete _cursor;
       _cursor = 0;
+      releaseDoc();
       }
 
 //---------------------------------------------------------
@@ -1410,7 +1681,19 @@ void Text::endCursorEdit()
 
 bool Text::isEmpty() const
       {
-      return styled() ? SimpleText::text().isEmpty() : _doc->isEmpty();
+      if (styled())
+            return SimpleText::text().isEmpty();
+      if (_doc)
+            return _doc->isEmpty();
+      if (_blocks.size() > 1)
+            return false;
+      foreach (const TBlock& b, _blocks) {
+            foreach (const TFragment& f, b.fragments) {
+                  if (!f.text.isEmpty())
+                        return false;
+                  }
+            }
+      return true;
       }
 
 //---------------------------------------------------------
@@ -1419,7 +1702,7 @@ bool Text::isEmpty() const
 
 void Text::setModified(bool v)
       {
-      if (!styled())
+      if (!styled() && _doc)
             _doc->setModified(v);
       }
 
@@ -1431,8 +1714,12 @@ QTextDocumentFragment Text::getFragment() const
       {
       if (styled())
             return QTextDocumentFragment::fromPlainText(text());
-      else
+      if (_doc)
             return QTextDocumentFragment(_doc);
+      QTextDocument* doc = toDocument();
+      QTextDocumentFragment f(doc);
+      delete doc;
+      return f;
       }
 
 //---------------------------------------------------------
@@ -1505,9 +1792,11 @@ void Text::spellCheckUnderline(bool on)
                   tf.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
                   tf.setUnderlineColor(Qt::red);
                   }
+            createDoc();
             QTextCursor c(_doc);
             c.select(QTextCursor::Document);
             c.setCharFormat(tf);
+            releaseDoc();
             }
       }
 
@@ -1519,7 +1808,7 @@ void Text::undo()
       {
       if (styled())
             ;
-      else
+      else if (_doc)
             _doc->undo();
       }
 
@@ -1531,7 +1820,7 @@ void Text::redo()
       {
       if (styled())
             ;
-      else
+      else if (_doc)
             _doc->undo();
       }
 
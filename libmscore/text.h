@@ -24,6 +24,47 @@ class TextProp;
 
 struct SymCode;
 
+//---------------------------------------------------------
+//   TFragment
+//    a run of unstyled text with uniform character format
+//---------------------------------------------------------
+
+struct TFragment {
+      QString text;
+      QFont font;             // unresolved, completed by text style font
+      QColor color;           // invalid color: use text color
+      QTextCharFormat::VerticalAlignment valign;
+
+      TFragment() : valign(QTextCharFormat::AlignNormal) {}
+      TFragment(const QString& s, const QFont& f)
+         : text(s), font(f), valign(QTextCharFormat::AlignNormal) {}
+      };
+
+//---------------------------------------------------------
+//   TBlock
+//    a paragraph of unstyled text
+//---------------------------------------------------------
+
+struct TBlock {
+      QList<TFragment> fragments;
+      Qt::Alignment align;
+
+      TBlock() : align(Qt::AlignLeft) {}
+      };
+
+//---------------------------------------------------------
+//   TRun
+//    the part of a TFragment on one line, shaped and
+//    positioned in layout
+//---------------------------------------------------------
+
+struct TRun {
+      QList<QGlyphRun> glyphs;
+      QPointF pos;            // offset of the glyph positions
+      QRectF rect;            // line box covered by this run
+      QColor color;
+      };
+
 //---------------------------------------------------------
 //   @@ MText
 //   @P text QString
@@ -33,14 +74,24 @@ class Text : public SimpleText {
       Q_OBJECT
       Q_PROPERTY(QString text READ text WRITE undoSetText)
 
-      QTextDocument* _doc;
+      QTextDocument* _doc;    // only exists while editing or for complex rich text
+      QList<TBlock> _blocks;  // unstyled text if there is no _doc
+      QList<TRun> _runs;      // layout of _blocks
+      qreal _baseLine;        // first line baseline of _runs
+      mutable QString _html;  // cached html representation of _blocks
       int _styleIndex;        // set to TEXT_STYLE_UNSTYLED if not styled
       static QTextCursor* _cursor;
 
+      QTextDocument* createDocument() const;
+      QTextDocument* toDocument() const;
+      bool fromDocument(const QTextDocument*);
       void createDoc();
+      void releaseDoc();
+      QSizeF layoutBlocks(qreal w);
+      QString blocksText() const;
       void setUnstyledText(const QString& s);
       void layoutEdit();
-      bool isSimpleText() const;
+      static bool isSimpleText(const QTextDocument*);
 
    protected:
       bool setCursor(const QPointF& p, QTextCursor::MoveMode mm = QTextCursor::MoveAnchor);
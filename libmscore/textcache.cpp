@@ -0,0 +1,142 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "textcache.h"
+#include "text.h"
+
+namespace Ms {
+
+static const int MAX_CACHE_SIZE = 16384;
+
+QHash<QString, ShapedBlock> TextCache::_cache;
+QMutex TextCache::_mutex;
+int TextCache::_hits;
+int TextCache::_misses;
+
+//---------------------------------------------------------
+//   layout
+//    break block b into lines of the given width (no
+//    wrapping if width <= 0) and shape each line with
+//    its character formats in one go, as QTextDocument
+//    does; font is the default font of the text.
+//    The result is cached.
+//---------------------------------------------------------
+
+ShapedBlock TextCache::layout(const TBlock& b, const QFont& font, qreal width)
+      {
+      QString text;
+      QList<QTextLayout::FormatRange> formats;
+      QString key = font.key() + QChar(0) + QString::number(qMax(width, 0.0));
+      foreach (const TFragment& f, b.fragments) {
+            QTextLayout::FormatRange r;
+            r.start  = text.size();
+            r.length = f.text.size();
+            r.format.setFont(f.font.resolve(font));
+            r.format.setVerticalAlignment(f.valign);
+            formats.append(r);
+            text += f.text;
+            key += QChar(0) + r.format.font().key() + QChar(1) + QChar('0' + int(f.valign))
+               + QChar(1) + f.text;
+            }
+
+      QMutexLocker locker(&_mutex);
+      auto i = _cache.constFind(key);
+      if (i != _cache.constEnd()) {
+            ++_hits;
+            return i.value();
+            }
+      ++_misses;
+
+      QTextLayout tl(text, font);
+      QTextOption to;
+      to.setUseDesignMetrics(true);
+      to.setAlignment(Qt::AlignLeft);
+      to.setWrapMode(width > 0.0 ? QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap);
+      tl.setTextOption(to);
+      tl.setAdditionalFormats(formats);
+      tl.setCacheEnabled(true);
+
+      ShapedBlock sb;
+      tl.beginLayout();
+      for (;;) {
+            QTextLine l = tl.createLine();
+            if (!l.isValid())
+                  break;
+            l.setLeadingIncluded(true);
+            if (width > 0.0)
+                  l.setLineWidth(width);
+            else
+                  l.setNumColumns(INT_MAX);
+            l.setPosition(QPointF(0.0, sb.height));
+            sb.height += l.height();
+            }
+      tl.endLayout();
+
+      for (int k = 0; k < tl.lineCount(); ++k) {
+            QTextLine l = tl.lineAt(k);
+            ShapedLine sl;
+            sl.width    = l.naturalTextWidth();
+            sl.baseLine = l.y() + l.ascent() + l.leading();
+            int lineStart = l.textStart();
+            int lineEnd   = lineStart + l.textLength();
+            for (int n = 0; n < formats.size(); ++n) {
+                  const QTextLayout::FormatRange& r = formats[n];
+                  int from = qMax(r.start, lineStart);
+                  int to   = qMin(r.start + r.length, lineEnd);
+                  if (from >= to)
+                        continue;
+                  ShapedRun run;
+                  run.fragment = n;
+                  run.glyphs   = l.glyphRuns(from, to - from);
+                  // glyphRuns() does not apply the baseline shift
+                  // QTextLine::draw() uses for super/subscript
+                  QTextCharFormat::VerticalAlignment va = r.format.verticalAlignment();
+                  if (va == QTextCharFormat::AlignSuperScript || va == QTextCharFormat::AlignSubScript) {
+                        for (int g = 0; g < run.glyphs.size(); ++g) {
+                              QRawFont rf = run.glyphs[g].rawFont();
+                              qreal h     = rf.ascent() + rf.descent();
+                              qreal shift = va == QTextCharFormat::AlignSuperScript ? -h * .5 : h / 6.0;
+                              QVector<QPointF> pos = run.glyphs[g].positions();
+                              for (int p = 0; p < pos.size(); ++p)
+                                    pos[p].ry() += shift;
+                              run.glyphs[g].setPositions(pos);
+                              }
+                        }
+                  qreal x1 = l.cursorToX(from);
+                  qreal x2 = l.cursorToX(to);
+                  run.rect = QRectF(qMin(x1, x2), l.y(), qAbs(x2 - x1), l.height());
+                  sl.runs.append(run);
+                  }
+            sb.lines.append(sl);
+            }
+
+      // the cache is not an LRU; just start over if it grows too big
+      if (_cache.size() >= MAX_CACHE_SIZE)
+            _cache.clear();
+      _cache.insert(key, sb);
+      return sb;
+      }
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void TextCache::clear()
+      {
+      QMutexLocker locker(&_mutex);
+      _cache.clear();
+      _hits   = 0;
+      _misses = 0;
+      }
+
+}     // namespace Ms
+
@@ -0,0 +1,81 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __TEXTCACHE_H__
+#define __TEXTCACHE_H__
+
+namespace Ms {
+
+struct TBlock;
+
+//---------------------------------------------------------
+//   ShapedRun
+//    glyph runs of the part of one fragment on one line;
+//    positions are relative to the top left corner of
+//    the block
+//---------------------------------------------------------
+
+struct ShapedRun {
+      QList<QGlyphRun> glyphs;
+      int fragment;           // index into TBlock::fragments
+      QRectF rect;            // line box covered by the run
+
+      ShapedRun() : fragment(0) {}
+      };
+
+//---------------------------------------------------------
+//   ShapedLine
+//---------------------------------------------------------
+
+struct ShapedLine {
+      QList<ShapedRun> runs;
+      qreal width;            // natural text width
+      qreal baseLine;         // relative to the top of the block
+
+      ShapedLine() : width(0.0), baseLine(0.0) {}
+      };
+
+//---------------------------------------------------------
+//   ShapedBlock
+//    a paragraph broken into lines and shaped the way
+//    QTextDocument lays out the same block
+//---------------------------------------------------------
+
+struct ShapedBlock {
+      QList<ShapedLine> lines;
+      qreal height;
+
+      ShapedBlock() : height(0.0) {}
+      };
+
+//---------------------------------------------------------
+//   TextCache
+//    shared cache of shaped blocks keyed by fonts, text
+//    and line width
+//---------------------------------------------------------
+
+class TextCache {
+      static QHash<QString, ShapedBlock> _cache;
+      static QMutex _mutex;
+      static int _hits;
+      static int _misses;
+
+   public:
+      static ShapedBlock layout(const TBlock&, const QFont&, qreal width);
+      static void clear();
+      static int hits()   { return _hits;   }
+      static int misses() { return _misses; }
+      };
+
+}     // namespace Ms
+#endif
+
@@ -144,6 +144,83 @@ void UndoCommand::redo()
       flip();
       }
 
+//---------------------------------------------------------
+//   addTicks
+//    a command with children touches the ticks of its
+//    children; other commands which do not know their
+//    ticks touch all
+//---------------------------------------------------------
+
+void UndoCommand::addTicks(TickRange& r) const
+      {
+      if (childList.isEmpty())
+            r.all = true;
+      foreach (const UndoCommand* c, childList)
+            c->addTicks(r);
+      }
+
+//---------------------------------------------------------
+//   TickRange
+//---------------------------------------------------------
+
+void TickRange::add(const TickRange& r)
+      {
+      all |= r.all;
+      if (!r.isEmpty())
+            add(r.tick1, r.tick2);
+      }
+
+void TickRange::add(const Element* e)
+      {
+      if (e && e->type() == Element::NOTE)
+            e = e->parent();
+      if (e == 0) {
+            all = true;
+            return;
+            }
+      switch (e->type()) {
+            case Element::CHORD:
+            case Element::REST:
+            case Element::REPEAT_MEASURE:
+                  {
+                  const ChordRest* cr = static_cast<const ChordRest*>(e);
+                  if (cr->segment())
+                        add(cr->tick(), cr->tick() + cr->actualTicks());
+                  else
+                        all = true;
+                  }
+                  break;
+            case Element::TIE:
+                  {
+                  const Tie* tie = static_cast<const Tie*>(e);
+                  add(tie->startNote());
+                  add(tie->endNote());
+                  }
+                  break;
+            case Element::SLUR:
+            case Element::VOLTA:
+            case Element::HAIRPIN:
+            case Element::OTTAVA:
+            case Element::PEDAL:
+            case Element::TRILL:
+            case Element::TEXTLINE:
+            case Element::NOTELINE:
+                  {
+                  const Spanner* sp = static_cast<const Spanner*>(e);
+                  add(sp->tick(), sp->tick2());
+                  }
+                  break;
+            default:
+                  if (e->parent() && e->parent()->type() == Element::SEGMENT) {
+                        int tick = static_cast<const Segment*>(e->parent())->tick();
+                        add(tick, tick);
+                        }
+                  else
+                        all = true;
+                  break;
+            }
+      }
+
 //---------------------------------------------------------
 //   unwind
 //---------------------------------------------------------
@@ -166,6 +243,7 @@ UndoStack::UndoStack()
       curCmd   = 0;
       curIdx   = 0;
       cleanIdx = 0;
+      reopened = false;
       }
 
 //---------------------------------------------------------
@@ -191,6 +269,28 @@ void UndoStack::beginMacro()
             qDebug("UndoStack::beginMacro %p, UndoStack %p", curCmd, this);
       }
 
+//---------------------------------------------------------
+//   reopenMacro
+//    make the last done command current again to append
+//    more changes to it; closed by endMacro(false). The
+//    redo list and the clean state are kept.
+//    Return false if there is no command to reopen.
+//---------------------------------------------------------
+
+bool UndoStack::reopenMacro()
+      {
+      if (curCmd) {
+            qDebug("UndoStack:reopenMacro(): alread active");
+            return false;
+            }
+      if (curIdx == 0)
+            return false;
+      --curIdx;
+      curCmd   = list.takeAt(curIdx);
+      reopened = true;
+      return true;
+      }
+
 //---------------------------------------------------------
 //   endMacro
 //---------------------------------------------------------
@@ -203,7 +303,14 @@ void UndoStack::endMacro(bool rollback)
             qDebug("UndoStack:endMacro(): not active");
             return;
             }
-      if (rollback)
+      if (reopened) {
+            // a reopened command is never rolled back, its
+            // first part is already on the stack
+            list.insert(curIdx, curCmd);
+            ++curIdx;
+            reopened = false;
+            }
+      else if (rollback)
             delete curCmd;
       else {
             while (list.size() > curIdx) {
@@ -226,7 +333,9 @@ void UndoStack::push(UndoCommand* cmd)
             // this can happen for layout() outside of a command (load)
             // qDebug("UndoStack:push(): no active command, UndoStack %p", this);
 
+            cmd->addTicks(_changedTicks);
             cmd->redo();
+            cmd->addTicks(_changedTicks);
             delete cmd;
             return;
             }
@@ -240,7 +349,9 @@ void UndoStack::push(UndoCommand* cmd)
             }
 #endif
       curCmd->appendChild(cmd);
+      cmd->addTicks(_changedTicks);
       cmd->redo();
+      cmd->addTicks(_changedTicks);
       }
 
 //---------------------------------------------------------
@@ -266,7 +377,9 @@ void UndoStack::pop()
             return;
             }
       UndoCommand* cmd = curCmd->removeChild();
+      cmd->addTicks(_changedTicks);
       cmd->undo();
+      cmd->addTicks(_changedTicks);
       }
 
 //---------------------------------------------------------
@@ -291,7 +404,9 @@ void UndoStack::undo()
             Q_ASSERT(curIdx >= 0);
             if (MScore::debugMode)
                   qDebug("--undo index %d", curIdx);
+            list[curIdx]->addTicks(_changedTicks);
             list[curIdx]->undo();
+            list[curIdx]->addTicks(_changedTicks);
             }
       }
 
@@ -304,7 +419,9 @@ void UndoStack::redo()
       if (canRedo()) {
             if (MScore::debugMode)
                   qDebug("--redo index %d", curIdx);
-            list[curIdx++]->redo();
+            list[curIdx]->addTicks(_changedTicks);
+            list[curIdx]->redo();
+            list[curIdx++]->addTicks(_changedTicks);
             }
       }
 
@@ -574,6 +691,37 @@ void Score::undoChangeTpc(Note* note, int tpc)
       undoChangeProperty(note, P_TPC, tpc);
       }
 
+//---------------------------------------------------------
+//   undoChangeTpcs
+//    change the spelling of notes (and linked notes) as one
+//    undo command; unchanged notes are skipped
+//---------------------------------------------------------
+
+void Score::undoChangeTpcs(const QList<Note*>& notes, const QList<int>& tpcs)
+      {
+      QList<Note*> nl;
+      QList<int> tl;
+      for (int i = 0; i < notes.size(); ++i) {
+            Note* note = notes[i];
+            int tpc    = tpcs[i];
+            if (propertyLink(P_TPC) && note->links()) {
+                  foreach(Element* e, *note->links()) {
+                        Note* n = static_cast<Note*>(e);
+                        if (n->tpc() != tpc) {
+                              nl.append(n);
+                              tl.append(tpc);
+                              }
+                        }
+                  }
+            else if (note->tpc() != tpc) {
+                  nl.append(note);
+                  tl.append(tpc);
+                  }
+            }
+      if (!nl.isEmpty())
+            undo(new ChangeTpcs(nl, tl));
+      }
+
 //---------------------------------------------------------
 //   findLinkedVoiceElement
 //---------------------------------------------------------
@@ -1214,6 +1362,15 @@ AddElement::AddElement(Element* e)
       element = e;
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void AddElement::addTicks(TickRange& r) const
+      {
+      r.add(element);
+      }
+
 //---------------------------------------------------------
 //   undoRemoveTuplet
 //---------------------------------------------------------
@@ -1344,6 +1501,15 @@ RemoveElement::RemoveElement(Element* e)
             }
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void RemoveElement::addTicks(TickRange& r) const
+      {
+      r.add(element);
+      }
+
 //---------------------------------------------------------
 //   undo
 //---------------------------------------------------------
@@ -1632,6 +1798,15 @@ void ChangePitch::flip()
       score->setLayoutAll(true);
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void ChangePitch::addTicks(TickRange& r) const
+      {
+      r.add(note);
+      }
+
 //---------------------------------------------------------
 //   FlipNoteDotDirection
 //---------------------------------------------------------
@@ -1703,6 +1878,16 @@ void ChangeElement::flip()
       score->setLayoutAll(true);
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void ChangeElement::addTicks(TickRange& r) const
+      {
+      r.add(oldElement);
+      r.add(newElement);
+      }
+
 //---------------------------------------------------------
 //   InsertStaves
 //---------------------------------------------------------
@@ -2076,6 +2261,15 @@ void ChangeChordRestLen::flip()
       cr->score()->setLayoutAll(true);
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void ChangeChordRestLen::addTicks(TickRange& r) const
+      {
+      r.add(cr);
+      }
+
 //---------------------------------------------------------
 //   MoveElement
 //---------------------------------------------------------
@@ -2505,6 +2699,15 @@ void ChangeVelocity::flip()
       veloOffset = o;
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void ChangeVelocity::addTicks(TickRange& r) const
+      {
+      r.add(note);
+      }
+
 //---------------------------------------------------------
 //   ChangeMStaffProperties
 //---------------------------------------------------------
@@ -2852,6 +3055,15 @@ void ChangeNoteEvents::flip()
       */
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void ChangeNoteEvents::addTicks(TickRange& r) const
+      {
+      r.add(chord);
+      }
+
 //---------------------------------------------------------
 //   undoChangeBarLine
 //---------------------------------------------------------
@@ -3088,6 +3300,39 @@ void ChangeProperty::flip()
       property = v;
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void ChangeProperty::addTicks(TickRange& r) const
+      {
+      r.add(element);
+      }
+
+//---------------------------------------------------------
+//   ChangeTpcs::addTicks
+//---------------------------------------------------------
+
+void ChangeTpcs::addTicks(TickRange& r) const
+      {
+      foreach (const Note* note, notes)
+            r.add(note);
+      }
+
+//---------------------------------------------------------
+//   ChangeTpcs::flip
+//---------------------------------------------------------
+
+void ChangeTpcs::flip()
+      {
+      for (int i = 0; i < notes.size(); ++i) {
+            Note* note = notes[i];
+            int tpc    = note->tpc();
+            note->setProperty(P_TPC, tpcs[i]);
+            tpcs[i] = tpc;
+            }
+      }
+
 //---------------------------------------------------------
 //   ChangeMetaText::flip
 //---------------------------------------------------------
@@ -3123,6 +3368,15 @@ void ChangeEventList::flip()
       userModified = um;
       }
 
+//---------------------------------------------------------
+//   addTicks
+//---------------------------------------------------------
+
+void ChangeEventList::addTicks(TickRange& r) const
+      {
+      r.add(chord);
+      }
+
 //---------------------------------------------------------
 //   ChangeSynthesizerState::flip
 //---------------------------------------------------------
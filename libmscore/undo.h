@@ -84,6 +84,26 @@ class BarLine;
 #define UNDO_NAME(a)
 #endif
 
+//---------------------------------------------------------
+//   TickRange
+//    ticks touched by undo commands; collected by the
+//    undo stack for views which update incrementally.
+//    all is set if a command cannot tell its ticks.
+//---------------------------------------------------------
+
+struct TickRange {
+      int tick1;
+      int tick2;
+      bool all;
+
+      TickRange()                  { clear(); }
+      void clear()                 { tick1 = INT_MAX; tick2 = INT_MIN; all = false; }
+      bool isEmpty() const         { return !all && tick1 > tick2; }
+      void add(int t1, int t2)     { tick1 = qMin(tick1, t1); tick2 = qMax(tick2, t2); }
+      void add(const TickRange& r);
+      void add(const Element*);
+      };
+
 //---------------------------------------------------------
 //   UndoCommand
 //---------------------------------------------------------
@@ -98,6 +118,7 @@ class UndoCommand {
       virtual ~UndoCommand();
       virtual void undo();
       virtual void redo();
+      virtual void addTicks(TickRange&) const;
       void appendChild(UndoCommand* cmd) { childList.append(cmd);       }
       UndoCommand* removeChild()         { return childList.takeLast(); }
       int childCount() const             { return childList.size();     }
@@ -116,6 +137,8 @@ class UndoStack {
       QList<UndoCommand*> list;
       int curIdx;
       int cleanIdx;
+      bool reopened;                // curCmd was taken from list[curIdx]
+      TickRange _changedTicks;
 
    public:
       UndoStack();
@@ -123,6 +146,7 @@ class UndoStack {
 
       bool active() const           { return curCmd != 0; }
       void beginMacro();
+      bool reopenMacro();
       void endMacro(bool rollback);
       void push(UndoCommand*);      // push & execute
       void push1(UndoCommand*);
@@ -134,6 +158,8 @@ class UndoStack {
       UndoCommand* current() const  { return curCmd;               }
       void undo();
       void redo();
+      const TickRange& changedTicks() const { return _changedTicks; }
+      void clearChangedTicks()      { _changedTicks.clear();       }
       };
 
 //---------------------------------------------------------
@@ -151,6 +177,7 @@ class SaveState : public UndoCommand {
       SaveState(Score*);
       virtual void undo();
       virtual void redo();
+      virtual void addTicks(TickRange&) const {}
       UNDO_NAME("SaveState");
       };
 
@@ -322,9 +349,26 @@ class ChangePitch : public UndoCommand {
 
    public:
       ChangePitch(Note* note, int pitch, int tpc, int l/*, int f, int string*/);
+      virtual void addTicks(TickRange& r) const;
       UNDO_NAME("ChangePitch");
       };
 
+//---------------------------------------------------------
+//   ChangeTpcs
+//    change the spelling of many notes in one command
+//---------------------------------------------------------
+
+class ChangeTpcs : public UndoCommand {
+      QList<Note*> notes;
+      QList<int> tpcs;
+      void flip();
+
+   public:
+      ChangeTpcs(const QList<Note*>& n, const QList<int>& t) : notes(n), tpcs(t) {}
+      virtual void addTicks(TickRange& r) const;
+      UNDO_NAME("ChangeTpcs");
+      };
+
 //---------------------------------------------------------
 //   ChangeKeySig
 //---------------------------------------------------------
@@ -380,6 +424,7 @@ class ChangeElement : public UndoCommand {
 
    public:
       ChangeElement(Element* oldElement, Element* newElement);
+      virtual void addTicks(TickRange& r) const;
       UNDO_NAME("ChangeElement");
       };
 
@@ -592,6 +637,7 @@ class ChangeChordRestLen : public UndoCommand {
 
    public:
       ChangeChordRestLen(ChordRest*, const TDuration& d);
+      virtual void addTicks(TickRange& r) const;
       UNDO_NAME("ChangeChordRestLen");
       };
 
@@ -635,6 +681,7 @@ class AddElement : public UndoCommand {
       AddElement(Element*);
       virtual void undo();
       virtual void redo();
+      virtual void addTicks(TickRange& r) const;
 #ifdef DEBUG_UNDO
       virtual const char* name() const;
 #endif
@@ -651,6 +698,7 @@ class RemoveElement : public UndoCommand {
       RemoveElement(Element*);
       virtual void undo();
       virtual void redo();
+      virtual void addTicks(TickRange& r) const;
 #ifdef DEBUG_UNDO
       virtual const char* name() const;
 #endif
@@ -860,6 +908,7 @@ class ChangeVelocity : public UndoCommand {
 
    public:
       ChangeVelocity(Note*, MScore::ValueType, int);
+      virtual void addTicks(TickRange& r) const;
       UNDO_NAME("ChangeVelocity");
       };
 
@@ -1070,6 +1119,7 @@ class ChangeNoteEvents : public UndoCommand {
 
    public:
       ChangeNoteEvents(Chord* n, const QList<NoteEvent*>& l) : chord(n), events(l) {}
+      virtual void addTicks(TickRange& r) const;
       UNDO_NAME("ChangeNoteEvents");
       };
 
@@ -1203,6 +1253,7 @@ class ChangeProperty : public UndoCommand {
       ChangeProperty(Element* e, P_ID i, const QVariant& v)
          : element(e), id(i), property(v) {}
       P_ID getId() const  { return id; }
+      virtual void addTicks(TickRange& r) const;
       UNDO_NAME("ChangeProperty");
       };
 
@@ -1236,6 +1287,7 @@ class ChangeEventList : public UndoCommand {
    public:
       ChangeEventList(Chord* c, const QList<NoteEventList> l, bool u) : chord(c), events(l), userModified(u) {}
       ~ChangeEventList();
+      virtual void addTicks(TickRange& r) const;
       UNDO_NAME("ChangeEventList");
       };
 
@@ -32,6 +32,7 @@
 #include "preferences.h"
 #include "seq.h"
 #include "alsamidi.h"
+#include "rtaudit.h"
 #include "libmscore/utils.h"
 
 namespace Ms {
@@ -385,6 +386,7 @@ int AlsaDriver::recover()
             qDebug("Alsa_driver: pcm_status(): %s\n",  snd_strerror (err));
             }
       else if (snd_pcm_status_get_state (stat) == SND_PCM_STATE_XRUN) {
+            ++rtStats.xruns;
             struct timeval tnow, trig;
             gettimeofday (&tnow, 0);
             snd_pcm_status_get_trigger_tstamp (stat, &trig);
@@ -676,19 +678,25 @@ void AlsaAudio::alsaLoop()
 
       alsa->pcmStart();
       int size = alsa->fsize();
-      float buffer[size * 2];
+      int rate = alsa->sampleRate();
+      // all buffers are allocated before the loop starts
+      QVector<float> buffer(size * 4);
+      float* sbuf = buffer.data();
+      float* l    = sbuf + size * 2;
+      float* r    = l + size;
       runAlsa = 2;
       while (runAlsa == 2) {
-            seq->process(size, buffer);
-            float l[size];
-            float r[size];
+            {
+            RtCallback rt(size, rate);
+            seq->process(size, sbuf);
             float* lp = l;
             float* rp = r;
-            float* sp = buffer;
+            float* sp = sbuf;
             for (int i = 0; i < size; ++i) {
                   *lp++ = *sp++;
                   *rp++ = *sp++;
                   }
+            }
             alsa->write(size, l, r);
             }
       alsa->pcmStop();
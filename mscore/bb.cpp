@@ -13,6 +13,7 @@
 
 #include "libmscore/mscore.h"
 #include "bb.h"
+#include "binaryreader.h"
 #include "libmscore/score.h"
 #include "libmscore/part.h"
 #include "libmscore/staff.h"
@@ -99,18 +100,15 @@ bool BBFile::read(const QString& name)
       if (!f.open(QIODevice::ReadOnly)) {
             return false;
             }
-      ba = f.readAll();
-      f.close();
-
-      a    = (const unsigned char*) ba.data();
-      size = ba.size();
+      BinaryReader r;
+      if (!r.open(&f))
+            return false;
 
       //---------------------------------------------------
       //    read version
       //---------------------------------------------------
 
-      int idx = 0;
-      _version = a[idx++];
+      _version = r.readUChar();
       switch(_version) {
             case 0x43 ... 0x49:
                   break;
@@ -125,24 +123,23 @@ bool BBFile::read(const QString& name)
       //    read title
       //---------------------------------------------------
 
-      int len = a[idx++];
+      int len = r.readUChar();
       _title  = new char[len+1];
-      for (int i = 0; i < len; ++i)
-            _title[i] = a[idx++];
       _title[len] = 0;
+      if (!r.read(_title, len))
+            return false;
 
       //---------------------------------------------------
       //    read style(timesig), key and bpm
       //---------------------------------------------------
 
-      ++idx;
-      ++idx;
-      _style = a[idx++] - 1;
+      r.skip(2);
+      _style = r.readUChar() - 1;
       if (_style < 0 || _style >= int(sizeof(styles)/sizeof(*styles))) {
             qDebug("Import bb: unknown style %d\n", _style + 1);
             return false;
             }
-      _key = a[idx++];
+      _key = r.readUChar();
 
       // map D# G# A#   to Eb Ab Db
       // major   C, Db,  D, Eb,  E,  F, Gb,  G, Ab,  A, Bb,  B, C#, D#, F#, G#, A#
@@ -157,8 +154,7 @@ bool BBFile::read(const QString& name)
             }
       _key = kt[_key];
 
-      _bpm = a[idx] + (a[idx+1] << 8);
-      idx += 2;
+      _bpm = r.readU16LE();
 
       qDebug("Title <%s>\n", _title);
       qDebug("style %d\n",   _style);
@@ -170,11 +166,11 @@ bool BBFile::read(const QString& name)
       //    read bar types
       //---------------------------------------------------
 
-      int bar = a[idx++];           // starting bar number
-      while (bar < 255) {
-            int val = a[idx++];
+      int bar = r.readUChar();           // starting bar number
+      while (bar < 255 && !r.error()) {
+            int val = r.readUChar();
             if (val == 0)
-                  bar += a[idx++];
+                  bar += r.readUChar();
             else {
                   qDebug("bar type: bar %d val %d\n", bar, val);
                   _barType[bar++] = val;
@@ -186,10 +182,10 @@ bool BBFile::read(const QString& name)
       //---------------------------------------------------
 
       int beat;
-      for (beat = 0; beat < MAX_BARS * 4;) {
-            int val = a[idx++];
+      for (beat = 0; beat < MAX_BARS * 4 && !r.error();) {
+            int val = r.readUChar();
             if (val == 0)
-                  beat += a[idx++];
+                  beat += r.readUChar();
             else {
                   BBChord c;
                   c.extension = val;
@@ -205,17 +201,17 @@ bool BBFile::read(const QString& name)
 
       int roots = 0;
       int maxbeat = 0;
-      for (beat = 0; beat < MAX_BARS * 4;) {
-            int val = a[idx++];
+      for (beat = 0; beat < MAX_BARS * 4 && !r.error();) {
+            int val = r.readUChar();
             if (val == 0)
-                  beat += a[idx++];
+                  beat += r.readUChar();
             else {
                   int root = val % 18;
                   int bass = (root - 1 + val / 18) % 12 + 1;
                   if (root == bass)
                         bass = 0;
                   int ibeat = beat * (timesigZ() / timesigN());
-                  if (ibeat != _chords[roots].beat) {
+                  if (roots >= _chords.size() || ibeat != _chords[roots].beat) {
                         qDebug("import bb: inconsistent chord type and root beat\n");
                         return false;
                         }
@@ -227,6 +223,10 @@ bool BBFile::read(const QString& name)
                   ++beat;
                   }
             }
+      if (r.error()) {
+            qDebug("import bb: unexpected end of file\n");
+            return false;
+            }
 
       _measures = ((maxbeat + timesigZ() - 1) / timesigZ()) + 1;
 
@@ -245,17 +245,17 @@ bool BBFile::read(const QString& name)
       qDebug("================chords=======================\n");
 #endif
 
-      if (a[idx] == 1) {            //??
-            qDebug("Skip 0x%02x at 0x%04x\n", a[idx], idx);
-            ++idx;
+      if (r.peek(r.pos()) == 1) {            //??
+            qDebug("Skip 0x%02x at 0x%04llx\n", 1, r.pos());
+            r.skip(1);
             }
 
-      _startChorus = a[idx++];
-      _endChorus   = a[idx++];
-      _repeats     = a[idx++];
+      _startChorus = r.readUChar();
+      _endChorus   = r.readUChar();
+      _repeats     = r.readUChar();
 
-      qDebug("start chorus %d  end chorus %d repeats %d, pos now 0x%x\n",
-         _startChorus, _endChorus, _repeats, idx);
+      qDebug("start chorus %d  end chorus %d repeats %d, pos now 0x%llx\n",
+         _startChorus, _endChorus, _repeats, r.pos());
 
       if (_startChorus >= _endChorus) {
             _startChorus = 0;
@@ -268,18 +268,18 @@ bool BBFile::read(const QString& name)
       //---------------------------------------------------
 
       bool found = false;
-      for (int i = idx; i < size; ++i) {
-            if (a[i] == 0x42) {
-                  if (a[i+1] < 16) {
-                        for (int k = i+2; k < (i+18); ++k) {
-                              if (a[k] == '.' && a[k+1] == 'S' && a[k+2] == 'T' && a[k+3] == 'Y') {
+      for (qint64 i = r.pos(); i < r.size(); ++i) {
+            if (r.peek(i) == 0x42) {
+                  if (r.peek(i+1) < 16) {
+                        for (qint64 k = i+2; k < (i+18); ++k) {
+                              if (r.peek(k) == '.' && r.peek(k+1) == 'S' && r.peek(k+2) == 'T' && r.peek(k+3) == 'Y') {
                                     found = true;
                                     break;
                                     }
                               }
                         }
                   if (found) {
-                        idx = i + 1;
+                        r.seek(i + 1);
                         break;
                         }
                   }
@@ -289,19 +289,20 @@ bool BBFile::read(const QString& name)
             return false;
             }
 
-      qDebug("read styleName at 0x%x\n", idx);
-      len = a[idx++];
+      qDebug("read styleName at 0x%llx\n", r.pos());
+      len = r.readUChar();
       _styleName = new char[len+1];
-
-      for (int i = 0; i < len; ++i)
-            _styleName[i] = a[idx++];
+      if (!r.read(_styleName, len))
+            len = 0;
       _styleName[len] = 0;
 
       qDebug("style name <%s>\n", _styleName);
 
       // read midi events
-      int eventStart = a[size-4] + a[size-3] * 256;
-      int eventCount = a[size-2] + a[size-1] * 256;
+      if (r.size() < 4 || !r.seek(r.size() - 4))
+            return false;
+      int eventStart = r.readU16LE();
+      int eventCount = r.readU16LE();
 
       int endTick = _measures * bbDivision * 4 * timesigZ() / timesigN();
 
@@ -310,14 +311,21 @@ bool BBFile::read(const QString& name)
             return true;
             }
       else {
-            idx = eventStart;
-            qDebug("melody found at 0x%x\n", idx);
+            if (!r.seek(eventStart))
+                  return false;
+            qDebug("melody found at 0x%x\n", eventStart);
             int i = 0;
             int lastLen = 0;
-            for (i = 0; i < eventCount; ++i, idx+=12) {
-                  int type = a[idx + 4] & 0xf0;
+            for (i = 0; i < eventCount; ++i) {
+                  qint64 idx = r.pos();
+                  uchar ev[12];
+                  if (!r.read(ev, 12)) {
+                        qDebug("import bb: event %d truncated\n", i);
+                        break;
+                        }
+                  int type = ev[4] & 0xf0;
                   if (type == 0x90) {
-                        int channel = a[idx + 7];
+                        int channel = ev[7];
                         BBTrack* track = 0;
                         foreach (BBTrack* t, _tracks) {
                               if (t->outChannel() == channel) {
@@ -330,7 +338,7 @@ bool BBFile::read(const QString& name)
                               track->setOutChannel(channel);
                               _tracks.append(track);
                               }
-                        int tick = a[idx] + (a[idx+1]<<8) + (a[idx+2]<<16) + (a[idx+3]<<24);
+                        int tick = ev[0] + (ev[1]<<8) + (ev[2]<<16) + (ev[3]<<24);
                         tick -= 4 * bbDivision;
                         if (tick >= endTick) {
                               qDebug("event tick %d > %d\n", tick, endTick);
@@ -338,13 +346,13 @@ bool BBFile::read(const QString& name)
                               }
                         Event note(ME_NOTE);
                         note.setOntime((tick * MScore::division) / bbDivision);
-                        note.setPitch(a[idx + 5]);
-                        note.setVelo(a[idx + 6]);
+                        note.setPitch(ev[5]);
+                        note.setVelo(ev[6]);
                         note.setChannel(channel);
-                        int len = a[idx+8] + (a[idx+9]<<8) + (a[idx+10]<<16) + (a[idx+11]<<24);
+                        int len = ev[8] + (ev[9]<<8) + (ev[10]<<16) + (ev[11]<<24);
                         if (len == 0) {
                               if (lastLen == 0) {
-                                    qDebug("note event of len 0 at idx %04x\n", idx);
+                                    qDebug("note event of len 0 at idx %04llx\n", idx);
                                     continue;
                                     }
                               len = lastLen;
@@ -359,7 +367,7 @@ bool BBFile::read(const QString& name)
                   else if (type == 0)
                         break;
                   else {
-                        qDebug("unknown event type 0x%02x at x%04x\n", a[idx + 4], idx);
+                        qDebug("unknown event type 0x%02x at x%04llx\n", ev[4], idx);
                         break;
                         }
                   }
@@ -132,9 +132,6 @@ class BBFile {
       int _measures;
       TimeSigMap _siglist;
 
-      QByteArray ba;
-      const unsigned char* a;
-      int size;
       int bbDivision;
 
       int timesigZ() { return styles[_style].timesigZ; }
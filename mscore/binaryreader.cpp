@@ -0,0 +1,132 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "binaryreader.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   BinaryReader
+//---------------------------------------------------------
+
+BinaryReader::BinaryReader()
+      {
+      _file  = 0;
+      _map   = 0;
+      _data  = 0;
+      _size  = 0;
+      _pos   = 0;
+      _error = false;
+      }
+
+BinaryReader::BinaryReader(const uchar* data, qint64 size)
+      {
+      _file  = 0;
+      _map   = 0;
+      _data  = data;
+      _size  = size;
+      _pos   = 0;
+      _error = false;
+      }
+
+BinaryReader::~BinaryReader()
+      {
+      close();
+      }
+
+//---------------------------------------------------------
+//   open
+//    make the content of the open file f available;
+//    reading starts at the current position of f
+//---------------------------------------------------------
+
+bool BinaryReader::open(QFile* f)
+      {
+      close();
+      qint64 pos  = f->pos();
+      qint64 size = f->size();
+      if (size > 0)
+            _map = f->map(0, size);
+      if (_map) {
+            _file = f;
+            _data = _map;
+            }
+      else {
+            f->seek(0);
+            _buffer = f->readAll();
+            if (_buffer.size() != size)
+                  return false;
+            _data = (const uchar*)_buffer.constData();
+            }
+      _size  = size;
+      _pos   = pos;
+      _error = false;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   close
+//---------------------------------------------------------
+
+void BinaryReader::close()
+      {
+      if (_map && _file)
+            _file->unmap(_map);
+      _map  = 0;
+      _file = 0;
+      _buffer.clear();
+      _data = 0;
+      _size = 0;
+      _pos  = 0;
+      }
+
+//---------------------------------------------------------
+//   setData
+//    read from a buffer owned by the caller
+//---------------------------------------------------------
+
+void BinaryReader::setData(const uchar* data, qint64 size)
+      {
+      close();
+      _data  = data;
+      _size  = size;
+      _error = false;
+      }
+
+//---------------------------------------------------------
+//   seek
+//---------------------------------------------------------
+
+bool BinaryReader::seek(qint64 pos)
+      {
+      if (pos < 0 || pos > _size) {
+            _error = true;
+            return false;
+            }
+      _pos = pos;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   skip
+//---------------------------------------------------------
+
+bool BinaryReader::skip(qint64 len)
+      {
+      if (!check(len))
+            return false;
+      _pos += len;
+      return true;
+      }
+
+}     // namespace Ms
+
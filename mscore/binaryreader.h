@@ -0,0 +1,126 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __BINARYREADER_H__
+#define __BINARYREADER_H__
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   BinaryReader
+//    bounds checked reader for binary file formats
+//    (GuitarPro, Capella, Band-in-a-Box, Overture)
+//
+//    The whole file is memory mapped (or read at once if
+//    mapping is not possible), so reading a value is a
+//    memcpy instead of a QIODevice call.
+//    Reading past the end returns zero and sets error(),
+//    like QDataStream.
+//---------------------------------------------------------
+
+class BinaryReader {
+      QPointer<QFile> _file;  // file mapped to _map
+      uchar* _map;
+      QByteArray _buffer;
+      const uchar* _data;
+      qint64 _size;
+      qint64 _pos;
+      bool _error;
+
+      bool check(qint64 len) {
+            if (len < 0 || len > _size - _pos) {
+                  _error = true;
+                  return false;
+                  }
+            return true;
+            }
+
+   public:
+      BinaryReader();
+      BinaryReader(const uchar* data, qint64 size);
+      ~BinaryReader();
+
+      bool open(QFile*);
+      void close();
+      void setData(const uchar* data, qint64 size);
+
+      const uchar* data() const { return _data;         }
+      qint64 size() const       { return _size;         }
+      qint64 pos() const        { return _pos;          }
+      bool atEnd() const        { return _pos >= _size; }
+      bool error() const        { return _error;        }
+
+      bool seek(qint64 pos);
+      bool skip(qint64 len);
+
+      //---------------------------------------------------
+      //   read
+      //    copy len bytes to p; return false if there are
+      //    not enough bytes left
+      //---------------------------------------------------
+
+      bool read(void* p, qint64 len) {
+            if (!check(len))
+                  return false;
+            memcpy(p, _data + _pos, len);
+            _pos += len;
+            return true;
+            }
+
+      // byte at absolute position pos or -1
+      int peek(qint64 pos) const {
+            return (pos >= 0 && pos < _size) ? _data[pos] : -1;
+            }
+
+      uchar readUChar() {
+            return check(1) ? _data[_pos++] : 0;
+            }
+      char readChar() {
+            return char(readUChar());
+            }
+      quint16 readU16LE() {
+            if (!check(2))
+                  return 0;
+            const uchar* p = _data + _pos;
+            _pos += 2;
+            return p[0] | (p[1] << 8);
+            }
+      quint32 readU32LE() {
+            if (!check(4))
+                  return 0;
+            const uchar* p = _data + _pos;
+            _pos += 4;
+            return p[0] | (p[1] << 8) | (p[2] << 16) | (quint32(p[3]) << 24);
+            }
+      quint16 readU16BE() {
+            if (!check(2))
+                  return 0;
+            const uchar* p = _data + _pos;
+            _pos += 2;
+            return (p[0] << 8) | p[1];
+            }
+      quint32 readU32BE() {
+            if (!check(4))
+                  return 0;
+            const uchar* p = _data + _pos;
+            _pos += 4;
+            return (quint32(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+            }
+      qint16 readS16LE() { return qint16(readU16LE()); }
+      qint32 readS32LE() { return qint32(readU32LE()); }
+      qint16 readS16BE() { return qint16(readU16BE()); }
+      qint32 readS32BE() { return qint32(readU32BE()); }
+      };
+
+}     // namespace Ms
+#endif
+
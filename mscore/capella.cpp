@@ -1606,8 +1606,7 @@ void Capella::read(void* p, qint64 len)
       {
       if (len == 0)
             return;
-      qint64 rv = f->read((char*)p, len);
-      if (rv != len)
+      if (!f.read(p, len))
             throw CAP_EOF;
       curPos += len;
       }
@@ -1618,9 +1617,10 @@ void Capella::read(void* p, qint64 len)
 
 unsigned char Capella::readByte()
       {
-      unsigned char c;
-      read(&c, 1);
-      return c;
+      if (f.atEnd())
+            throw CAP_EOF;
+      ++curPos;
+      return f.readUChar();
       }
 
 //---------------------------------------------------------
@@ -1629,9 +1629,10 @@ unsigned char Capella::readByte()
 
 char Capella::readChar()
       {
-      char c;
-      read(&c, 1);
-      return c;
+      if (f.atEnd())
+            throw CAP_EOF;
+      ++curPos;
+      return f.readChar();
       }
 
 //---------------------------------------------------------
@@ -1640,8 +1641,10 @@ char Capella::readChar()
 
 short Capella::readWord()
       {
-      short c;
-      read(&c, 2);
+      short c = f.readS16LE();
+      if (f.error())
+            throw CAP_EOF;
+      curPos += 2;
       return c;
       }
 
@@ -1651,8 +1654,10 @@ short Capella::readWord()
 
 int Capella::readDWord()
       {
-      int c;
-      read(&c, 4);
+      int c = f.readS32LE();
+      if (f.error())
+            throw CAP_EOF;
+      curPos += 4;
       return c;
       }
 
@@ -1662,9 +1667,7 @@ int Capella::readDWord()
 
 int Capella::readLong()
       {
-      int c;
-      read(&c, 4);
-      return c;
+      return readDWord();
       }
 
 //---------------------------------------------------------
@@ -1673,18 +1676,11 @@ int Capella::readLong()
 
 unsigned Capella::readUnsigned()
       {
-      unsigned char c;
-      read(&c, 1);
-      if (c == 254) {
-            unsigned short s;
-            read(&s, 2);
-            return s;
-            }
-      else if (c == 255) {
-            unsigned s;
-            read(&s, 4);
-            return s;
-            }
+      unsigned char c = readByte();
+      if (c == 254)
+            return (unsigned short)readWord();
+      else if (c == 255)
+            return readDWord();
       else
             return c;
       }
@@ -1695,18 +1691,11 @@ unsigned Capella::readUnsigned()
 
 int Capella::readInt()
       {
-      char c;
-      read(&c, 1);
-      if (c == -128) {
-            short s;
-            read(&s, 2);
-            return s;
-            }
-      else if (c == 127) {
-            int s;
-            read(&s, 4);
-            return s;
-            }
+      signed char c = readChar();
+      if (c == -128)
+            return readWord();
+      else if (c == 127)
+            return readDWord();
       else
             return c;
       }
@@ -1839,8 +1828,7 @@ void Capella::readStaveLayout(CapStaffLayout* sl, int idx)
             default:
                   {
                   char lines[11];
-                  f->read(lines, 11);
-                  curPos += 11;
+                  read(lines, 11);
                   }
                   break;
             }
@@ -1873,16 +1861,14 @@ void Capella::readStaveLayout(CapStaffLayout* sl, int idx)
             Q_UNUSED(iMin);
             uchar n    = readByte();
             assert (n > 0 and iMin + n <= 128);
-            f->read(sl->soundMapIn, n);
-            curPos += n;
+            read(sl->soundMapIn, n);
             }
       if (sl->bSoundMapOut) {     // Umleitungstabelle für das Vorspielen
             unsigned char iMin = readByte();
             Q_UNUSED(iMin);
             unsigned char n    = readByte();
             assert (n > 0 and iMin + n <= 128);
-            f->read(sl->soundMapOut, n);
-            curPos += n;
+            read(sl->soundMapOut, n);
             }
       sl->sound  = readInt();
       sl->volume = readInt();
@@ -2263,7 +2249,8 @@ QPointF Capella::readPoint()
 
 void Capella::read(QFile* fp)
       {
-      f      = fp;
+      if (!f.open(fp))
+            throw CAP_EOF;
       curPos = 0;
 
       char signature[9];
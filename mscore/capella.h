@@ -23,6 +23,7 @@
 
 #include "globals.h"
 #include "libmscore/xml.h"
+#include "binaryreader.h"
 
 namespace Ms {
 
@@ -628,7 +629,7 @@ class Capella {
       static const char* errmsg[];
       int curPos;
 
-      QFile* f;
+      BinaryReader f;
       char* author;
       char* keywords;
       char* comment;
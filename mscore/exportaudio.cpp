@@ -38,6 +38,7 @@ namespace Ms {
 
 bool MuseScore::saveAudio(Score* score, const QString& name, const QString& ext)
       {
+      score->ensureLayout();
       int format;
       if (ext == "wav")
             format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
@@ -610,6 +610,7 @@ QString MP3Exporter::getLibraryTypeString()
 
 bool MuseScore::saveMp3(Score* score, const QString& name)
       {
+      score->ensureLayout();
       EventMap events;
       score->renderMidi(&events);
       if(events.size() == 0)
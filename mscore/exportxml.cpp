@@ -226,6 +226,7 @@ class SlurHandler {
 
 public:
       SlurHandler();
+      bool empty() const;
       void doSlurStart(Chord* chord, Notations& notations, Xml& xml);
       void doSlurStop(Chord* chord, Notations& notations, Xml& xml);
       };
@@ -241,6 +242,7 @@ class GlissandoHandler {
 
 public:
       GlissandoHandler();
+      bool empty() const;
       void doGlissandoStart(Chord* chord, Notations& notations, Xml& xml);
       void doGlissandoStop(Chord* chord, Notations& notations, Xml& xml);
       };
@@ -282,14 +284,21 @@ class ExportMusicXml {
       double getTenthsFromInches(double);
       double getTenthsFromDots(double);
       void keysigTimesig(Measure* m, int strack, int etrack);
+      void writePart(int idx, int staffCount);
+      void writeParts(QIODevice* dev);
+      bool openState() const;
+      void copyState(const ExportMusicXml* em);
 
 public:
       ExportMusicXml(Score* s)
             {
             score = s; tick = 0; div = 1; tenths = 40;
             millimeters = score->spatium() * tenths / (10 * MScore::DPMM);
+            for (int i = 0; i < MAX_BRACKETS; ++i)
+                  bracket[i] = 0;
             }
       void write(QIODevice* dev);
+      QByteArray writePartBuffer(int idx, int staffCount);
       void credits(Xml& xml);
       void moveToTick(int t);
       void words(Text const* const text, int staff);
@@ -404,6 +413,18 @@ SlurHandler::SlurHandler()
             }
       }
 
+//---------------------------------------------------------
+//   empty -- true if no slur is pending
+//---------------------------------------------------------
+
+bool SlurHandler::empty() const
+      {
+      for (int i = 0; i < MAX_NUMBER_LEVEL; ++i)
+            if (slur[i])
+                  return false;
+      return true;
+      }
+
 //---------------------------------------------------------
 //   findSlur -- get index of slur in slur table
 //   return -1 if not found
@@ -560,6 +581,18 @@ GlissandoHandler::GlissandoHandler()
             }
       }
 
+//---------------------------------------------------------
+//   empty -- true if no glissando or slide is pending
+//---------------------------------------------------------
+
+bool GlissandoHandler::empty() const
+      {
+      for (int i = 0; i < MAX_NUMBER_LEVEL; ++i)
+            if (glissChrd[i] || slideChrd[i])
+                  return false;
+      return true;
+      }
+
 //---------------------------------------------------------
 //   findChord -- get index of chord in chord table for subtype st
 //   return -1 if not found
@@ -3846,6 +3879,522 @@ void ExportMusicXml::keysigTimesig(Measure* m, int strack, int etrack)
             timesig(tsig);
       }
 
+//---------------------------------------------------------
+//  writePart
+//    write part idx; staffCount is the number of staves
+//    in the parts before it
+//---------------------------------------------------------
+
+void ExportMusicXml::writePart(int idx, int staffCount)
+      {
+      Part* part = score->parts().at(idx);
+      tick = 0;
+      xml.stag(QString("part id=\"P%1\"").arg(idx+1));
+
+      int staves = part->nstaves();
+      int strack = score->staffIdx(part) * VOICES;
+      int etrack = strack + staves * VOICES;
+
+      trillStart.clear();
+      trillStop.clear();
+
+      int measureNo = 1;          // number of next regular measure
+      int irregularMeasureNo = 1; // number of next irregular measure
+      int pickupMeasureNo = 1;    // number of next pickup measure
+
+      FigBassMap fbMap;           // pending figure base extends
+
+      for (MeasureBase* mb = score->measures()->first(); mb; mb = mb->next()) {
+            if (mb->type() != Element::MEASURE)
+                  continue;
+            Measure* m = static_cast<Measure*>(mb);
+            const PageFormat* pf = score->pageFormat();
+
+
+            // pickup and other irregular measures need special care
+            QString measureTag = "measure number=";
+            if ((irregularMeasureNo + measureNo) == 2 && m->irregular()) {
+                  measureTag += "\"0\" implicit=\"yes\"";
+                  pickupMeasureNo++;
+                  }
+            else if (m->irregular())
+                  measureTag += QString("\"X%1\" implicit=\"yes\"").arg(irregularMeasureNo++);
+            else
+                  measureTag += QString("\"%1\"").arg(measureNo++);
+            if (preferences.musicxmlExportLayout)
+                  measureTag += QString(" width=\"%1\"").arg(QString::number(m->bbox().width() / MScore::DPMM / millimeters * tenths,'f',2));
+            xml.stag(measureTag);
+
+            // Handle the <print> element.
+            // When exporting layout and all breaks, a <print> with layout informations
+            // is generated for the measure types TopSystem, NewSystem and newPage.
+            // When exporting layout but only manual or no breaks, a <print> with
+            // layout informations is generated only for the measure type TopSystem,
+            // as it is assumed the system layout is broken by the importing application
+            // anyway and is thus useless.
+
+            int currentSystem = NoSystem;
+            Measure* previousMeasure = 0;
+
+            for (MeasureBase* currentMeasureB = m->prev(); currentMeasureB; currentMeasureB = currentMeasureB->prev()) {
+                  if (currentMeasureB->type() == Element::MEASURE) {
+                        previousMeasure = (Measure*) currentMeasureB;
+                        break;
+                        }
+                  }
+
+            if (!previousMeasure)
+                  currentSystem = TopSystem;
+            else if (m->parent()->parent() != previousMeasure->parent()->parent())
+                  currentSystem = NewPage;
+            else if (m->parent() != previousMeasure->parent())
+                  currentSystem = NewSystem;
+
+            bool prevMeasLineBreak = false;
+            bool prevMeasPageBreak = false;
+            if (previousMeasure) {
+                  prevMeasLineBreak = previousMeasure->lineBreak();
+                  prevMeasPageBreak = previousMeasure->pageBreak();
+                  }
+
+            if (currentSystem != NoSystem) {
+
+                  // determine if a new-system or new-page is required
+                  QString newThing; // new-[system|page]="yes" or empty
+                  if (preferences.musicxmlExportBreaks == ALL_BREAKS) {
+                        if (currentSystem == NewSystem)
+                              newThing = " new-system=\"yes\"";
+                        else if (currentSystem == NewPage)
+                              newThing = " new-page=\"yes\"";
+                        }
+                  else if (preferences.musicxmlExportBreaks == MANUAL_BREAKS) {
+                        if (currentSystem == NewSystem && prevMeasLineBreak)
+                              newThing = " new-system=\"yes\"";
+                        else if (currentSystem == NewPage && prevMeasPageBreak)
+                              newThing = " new-page=\"yes\"";
+                        }
+
+                  // determine if layout information is required
+                  bool doLayout = false;
+                  if (preferences.musicxmlExportLayout) {
+                        if (currentSystem == TopSystem
+                            || (preferences.musicxmlExportBreaks == ALL_BREAKS && newThing != "")) {
+                              doLayout = true;
+                              }
+                        }
+
+                  if (doLayout) {
+                        xml.stag(QString("print%1").arg(newThing));
+                        const double pageWidth  = getTenthsFromInches(pf->size().width());
+                        const double lm = getTenthsFromInches(pf->oddLeftMargin());
+                        const double rm = getTenthsFromInches(pf->oddRightMargin());
+                        const double tm = getTenthsFromInches(pf->oddTopMargin());
+
+                        // System Layout
+                        // Put the system print suggestions only for the first part in a score...
+                        if (idx == 0) {
+                              // Find the right margin of the system.
+                              double systemLM = getTenthsFromDots(m->pagePos().x() - m->system()->page()->pagePos().x()) - lm;
+                              double systemRM = pageWidth - rm - (getTenthsFromDots(m->system()->bbox().width()) + lm);
+
+                              xml.stag("system-layout");
+                              xml.stag("system-margins");
+                              xml.tag("left-margin", QString("%1").arg(QString::number(systemLM,'f',2)));
+                              xml.tag("right-margin", QString("%1").arg(QString::number(systemRM,'f',2)) );
+                              xml.etag();
+
+                              if (currentSystem == NewPage || currentSystem == TopSystem)
+                                    xml.tag("top-system-distance", QString("%1").arg(QString::number(getTenthsFromDots(m->pagePos().y()) - tm,'f',2)) );
+                              if (currentSystem == NewSystem)
+                                    xml.tag("system-distance", QString("%1").arg(QString::number(getTenthsFromDots(m->pagePos().y() - previousMeasure->pagePos().y() - previousMeasure->bbox().height()),'f',2)));
+
+                              xml.etag();
+                              }
+
+                        // Staff layout elements.
+                        for (int staffIdx = (staffCount == 0) ? 1 : 0; staffIdx < staves; staffIdx++) {
+                              xml.stag(QString("staff-layout number=\"%1\"").arg(staffIdx + 1));
+                              xml.tag("staff-distance", QString("%1").arg(QString::number(getTenthsFromDots(mb->system()->staff(staffCount + staffIdx - 1)->distanceDown()),'f',2)));
+                              xml.etag();
+                              }
+
+                        xml.etag();
+                        }
+                  else {
+                        // !doLayout
+                        if (newThing != "")
+                              xml.tagE(QString("print%1").arg(newThing));
+                        }
+
+                  } // if (currentSystem ...
+
+            attr.start();
+
+            findTrills(m, strack, etrack, trillStart, trillStop);
+
+            // barline left must be the first element in a measure
+            barlineLeft(m);
+
+            // output attributes with the first actual measure (pickup or regular)
+            if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
+                  attr.doAttr(xml, true);
+                  xml.tag("divisions", MScore::division / div);
+                  }
+            // output attributes at start of measure: key, time
+            keysigTimesig(m, strack, etrack);
+            // output attributes with the first actual measure (pickup or regular) only
+            if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
+                  if (staves > 1)
+                        xml.tag("staves", staves);
+                  }
+            // output attribute at start of measure: clef
+            for (Segment* seg = m->first(); seg; seg = seg->next()) {
+
+                  if (seg->tick() > m->tick())
+                        break;
+                  Element* el = seg->element(strack);
+                  if (!el)
+                        continue;
+                  if (el->type() == Element::CLEF)
+                        for (int st = strack; st < etrack; st += VOICES) {
+                              // sstaff - xml staff number, counting from 1 for this
+                              // instrument
+                              // special number 0 -> dont show staff number in
+                              // xml output (because there is only one staff)
+
+                              int sstaff = (staves > 1) ? st - strack + VOICES : 0;
+                              sstaff /= VOICES;
+
+                              el = seg->element(st);
+                              if (el && el->type() == Element::CLEF) {
+                                    Clef* cle = static_cast<Clef*>(el);
+                                    int ct = cle->clefType();
+                                    int ti = cle->segment()->tick();
+#ifdef DEBUG_CLEF
+                                    qDebug("exportxml: clef at start measure ti=%d ct=%d gen=%d", ti, ct, el->generated());
+#endif
+                                    // output only clef changes, not generated clefs at line beginning
+                                    // exception: at tick=0, export clef anyway
+                                    if (ti == 0 || !cle->generated()) {
+#ifdef DEBUG_CLEF
+                                          qDebug("exportxml: clef exported");
+#endif
+                                          clef(sstaff, ct);
+                                          }
+                                    else {
+#ifdef DEBUG_CLEF
+                                          qDebug("exportxml: clef not exported");
+#endif
+                                          }
+                                    }
+                              }
+                  }
+
+            // output attributes with the first actual measure (pickup or regular) only
+            if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
+                  const Instrument* instrument = part->instr();
+
+                  // staff details
+                  // TODO: decide how to handle linked regular / TAB staff
+                  //       currently exported as a two staff part ...
+                  for (int i = 0; i < staves; i++) {
+                        Staff* st = part->staff(i);
+                        if (st->lines() != 5) {
+                              if (staves > 1)
+                                    xml.stag(QString("staff-details number=\"%1\"").arg(i+1));
+                              else
+                                    xml.stag("staff-details");
+                              xml.tag("staff-lines", st->lines());
+                              if (st->isTabStaff() && instrument->tablature()) {
+                                    QList<int> l = instrument->tablature()->stringList();
+                                    for (int i = 0; i < l.size(); i++) {
+                                          char step  = ' ';
+                                          int alter  = 0;
+                                          int octave = 0;
+                                          midipitch2xml(l.at(i), step, alter, octave);
+                                          xml.stag(QString("staff-tuning line=\"%1\"").arg(i+1));
+                                          xml.tag("tuning-step", QString("%1").arg(step));
+                                          if (alter)
+                                                xml.tag("tuning-alter", alter);
+                                          xml.tag("tuning-octave", octave);
+                                          xml.etag();
+                                          }
+                                    }
+                              xml.etag();
+                              }
+                        }
+                  // instrument details
+                  if (instrument->transpose().chromatic) {
+                        xml.stag("transpose");
+                        xml.tag("diatonic",  instrument->transpose().diatonic);
+                        xml.tag("chromatic", instrument->transpose().chromatic);
+                        xml.etag();
+                        }
+                  }
+
+            // output attribute at start of measure: measure-style
+            measureStyle(xml, attr, m);
+
+            // MuseScore limitation: repeats are always in the first part
+            // and are implicitly placed at either measure start or stop
+            if (idx == 0)
+                  repeatAtMeasureStart(xml, attr, m, strack, etrack, strack);
+
+            for (int st = strack; st < etrack; ++st) {
+                  // sstaff - xml staff number, counting from 1 for this
+                  // instrument
+                  // special number 0 -> dont show staff number in
+                  // xml output (because there is only one staff)
+
+                  int sstaff = (staves > 1) ? st - strack + VOICES : 0;
+                  sstaff /= VOICES;
+
+                  for (Segment* seg = m->first(); seg; seg = seg->next()) {
+                        Element* el = seg->element(st);
+                        if (!el)
+                              continue;
+                        // must ignore start repeat to prevent spurious backup/forward
+                        if (el->type() == Element::BAR_LINE && static_cast<BarLine*>(el)->barLineType() == START_REPEAT)
+                              continue;
+
+                        // look for harmony element for this tick position
+                        if (el->isChordRest()) {
+                              QList<Element*> list;
+
+#if 0 // TODO-WS
+                              foreach(Element* he, *m->el()) {
+                                    if ((he->type() == Element::HARMONY) && (he->staffIdx() == sstaff)
+                                        && (he->tick() == el->tick())) {
+                                          list << he;
+                                          }
+                                    }
+#endif
+
+                              qSort(list.begin(), list.end(), elementRighter);
+
+                              foreach (Element* hhe, list) {
+                                    attr.doAttr(xml, false);
+                                    qDebug("writing harmony");
+                                    harmony((Harmony*)hhe, 0);
+                                    }
+                              }
+
+                        // generate backup or forward to the start time of the element
+                        // but not for breath, which has the same start time as the
+                        // previous note, while tick is already at the end of that note
+                        if (tick != seg->tick()) {
+                              attr.doAttr(xml, false);
+                              if (el->type() != Element::BREATH)
+                                    moveToTick(seg->tick());
+                              }
+
+                        // handle annotations and spanners (directions attached to this note or rest)
+                        if (el->isChordRest()) {
+                              attr.doAttr(xml, false);
+                              annotations(this, xml, strack, etrack, st, sstaff, seg);
+                              figuredBass(xml, strack, etrack, st, static_cast<const ChordRest*>(el), fbMap);
+                              spannerStop(this, strack, etrack, st, sstaff, seg);
+                              spannerStart(this, strack, etrack, st, sstaff, seg);
+                              }
+
+                        switch (el->type()) {
+
+                              case Element::CLEF:
+                                    {
+                                    // output only clef changes, not generated clefs
+                                    // at line beginning
+                                    // also ignore clefs at the start of a measure,
+                                    // these have already been output
+                                    int ct = ((Clef*)el)->clefType();
+#ifdef DEBUG_CLEF
+                                    int ti = seg->tick();
+                                    qDebug("exportxml: clef in measure ti=%d ct=%d gen=%d", ti, ct, el->generated());
+#endif
+                                    if (el->generated()) {
+#ifdef DEBUG_CLEF
+                                          qDebug("exportxml: generated clef not exported");
+#endif
+                                          break;
+                                          }
+                                    if (!el->generated() && seg->tick() != m->tick())
+                                          clef(sstaff, ct);
+                                    else {
+#ifdef DEBUG_CLEF
+                                          qDebug("exportxml: clef not exported");
+#endif
+                                          }
+                                    }
+                                    break;
+
+                              case Element::KEYSIG:
+                                    // ignore
+                                    break;
+
+                              case Element::TIMESIG:
+                                    // ignore
+                                    break;
+
+                              case Element::CHORD:
+                                    {
+                                    Chord* c                 = static_cast<Chord*>(el);
+                                    const QList<Lyrics*>* ll = &c->lyricsList();
+
+                                    chord(c, sstaff, ll, part->instr()->useDrumset());
+                                    break;
+                                    }
+                              case Element::REST:
+                                    rest((Rest*)el, sstaff);
+                                    break;
+
+                              case Element::BAR_LINE:
+                                    // Following must be enforced (ref MusicXML barline.dtd):
+                                    // If location is left, it should be the first element in the measure;
+                                    // if location is right, it should be the last element.
+                                    // implementation note: START_REPEAT already written by barlineLeft()
+                                    // any bars left should be "middle"
+                                    // TODO: print barline only if middle
+                                    // if (el->subtype() != START_REPEAT)
+                                    //       bar((BarLine*) el);
+                                    break;
+                              case Element::BREATH:
+                                    // ignore, already exported as note articulation
+                                    break;
+
+                              default:
+                                    qDebug("ExportMusicXml::write unknown segment type %s\n", el->name());
+                                    break;
+                              }
+                        } // for (Segment* seg = ...
+                  attr.stop(xml);
+                  } // for (int st = ...
+            // move to end of measure (in case of incomplete last voice)
+#ifdef DEBUG_TICK
+            qDebug("end of measure");
+#endif
+            moveToTick(m->tick() + m->ticks());
+            if (idx == 0)
+                  repeatAtMeasureStop(xml, m, strack, etrack, strack);
+            // note: don't use "m->repeatFlags() & RepeatEnd" here, because more
+            // barline types need to be handled besides repeat end ("light-heavy")
+            barlineRight(m);
+            xml.etag();
+            }
+      xml.etag();
+      }
+
+//---------------------------------------------------------
+//  writePartBuffer
+//    write part idx into a buffer, indented as in the
+//    complete document
+//---------------------------------------------------------
+
+QByteArray ExportMusicXml::writePartBuffer(int idx, int staffCount)
+      {
+      QBuffer buf;
+      buf.open(QIODevice::WriteOnly);
+      xml.setDevice(&buf);
+      xml.setCodec("utf8");
+      xml.stag("score-partwise");
+      xml.flush();
+      qint64 start = buf.pos();
+      writePart(idx, staffCount);
+      xml.flush();
+      QByteArray data = buf.data().mid(start);
+      xml.etag();
+      xml.setDevice(0);
+      return data;
+      }
+
+//---------------------------------------------------------
+//  openState
+//    true if a slur, glissando or bracket is still open;
+//    a serial export carries it over into the next part
+//---------------------------------------------------------
+
+bool ExportMusicXml::openState() const
+      {
+      if (!sh.empty() || !gh.empty())
+            return true;
+      for (int i = 0; i < MAX_BRACKETS; ++i)
+            if (bracket[i])
+                  return true;
+      return false;
+      }
+
+//---------------------------------------------------------
+//  copyState
+//---------------------------------------------------------
+
+void ExportMusicXml::copyState(const ExportMusicXml* em)
+      {
+      sh = em->sh;
+      gh = em->gh;
+      for (int i = 0; i < MAX_BRACKETS; ++i)
+            bracket[i] = em->bracket[i];
+      }
+
+//---------------------------------------------------------
+//  PartJob
+//---------------------------------------------------------
+
+struct PartJob {
+      ExportMusicXml* em;
+      int idx;
+      int staffCount;
+      QByteArray data;
+      };
+
+static void exportPartJob(PartJob& job)
+      {
+      job.data = job.em->writePartBuffer(job.idx, job.staffCount);
+      }
+
+//---------------------------------------------------------
+//  writeParts
+//    Write all <part> elements. The parts are exported in
+//    parallel, each starting without open slurs, glissandi
+//    or brackets. A part following one which left such
+//    state open is written again with that state, so the
+//    output is identical to a serial export.
+//---------------------------------------------------------
+
+void ExportMusicXml::writeParts(QIODevice* dev)
+      {
+      const QList<Part*>& il = score->parts();
+      if (il.size() < 2) {
+            if (!il.isEmpty())
+                  writePart(0, 0);
+            return;
+            }
+
+      QList<PartJob> jobs;
+      int staffCount = 0;
+      foreach (Part* part, il) {
+            PartJob job;
+            job.em         = new ExportMusicXml(score);
+            job.em->div    = div;
+            job.idx        = jobs.size();
+            job.staffCount = staffCount;
+            jobs.append(job);
+            staffCount += part->nstaves();
+            }
+      QtConcurrent::blockingMap(jobs, exportPartJob);
+
+      for (int i = 1; i < jobs.size(); ++i) {
+            if (jobs[i-1].em->openState()) {
+                  jobs[i].em->copyState(jobs[i-1].em);
+                  exportPartJob(jobs[i]);
+                  }
+            }
+
+      xml.flush();
+      for (int i = 0; i < jobs.size(); ++i) {
+            dev->write(jobs[i].data);
+            jobs[i].data.clear();
+            delete jobs[i].em;
+            }
+      }
+
 //---------------------------------------------------------
 //  write
 //---------------------------------------------------------
@@ -3859,9 +4408,6 @@ void ExportMusicXml::write(QIODevice* dev)
 
       calcDivisions();
 
-      for (int i = 0; i < MAX_BRACKETS; ++i)
-            bracket[i] = 0;
-
       xml.setDevice(dev);
       xml.setCodec("utf8");
       xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
@@ -4001,406 +4547,10 @@ void ExportMusicXml::write(QIODevice* dev)
             }
       xml.etag();
 
-      staffCount = 0;
-
-      for (int idx = 0; idx < il.size(); ++idx) {
-            Part* part = il.at(idx);
-            tick = 0;
-            xml.stag(QString("part id=\"P%1\"").arg(idx+1));
-
-            int staves = part->nstaves();
-            int strack = score->staffIdx(part) * VOICES;
-            int etrack = strack + staves * VOICES;
-
-            trillStart.clear();
-            trillStop.clear();
-
-            int measureNo = 1;          // number of next regular measure
-            int irregularMeasureNo = 1; // number of next irregular measure
-            int pickupMeasureNo = 1;    // number of next pickup measure
-
-            FigBassMap fbMap;           // pending figure base extends
-
-            for (MeasureBase* mb = score->measures()->first(); mb; mb = mb->next()) {
-                  if (mb->type() != Element::MEASURE)
-                        continue;
-                  Measure* m = static_cast<Measure*>(mb);
-                  const PageFormat* pf = score->pageFormat();
-
-
-                  // pickup and other irregular measures need special care
-                  QString measureTag = "measure number=";
-                  if ((irregularMeasureNo + measureNo) == 2 && m->irregular()) {
-                        measureTag += "\"0\" implicit=\"yes\"";
-                        pickupMeasureNo++;
-                        }
-                  else if (m->irregular())
-                        measureTag += QString("\"X%1\" implicit=\"yes\"").arg(irregularMeasureNo++);
-                  else
-                        measureTag += QString("\"%1\"").arg(measureNo++);
-                  if (preferences.musicxmlExportLayout)
-                        measureTag += QString(" width=\"%1\"").arg(QString::number(m->bbox().width() / MScore::DPMM / millimeters * tenths,'f',2));
-                  xml.stag(measureTag);
-
-                  // Handle the <print> element.
-                  // When exporting layout and all breaks, a <print> with layout informations
-                  // is generated for the measure types TopSystem, NewSystem and newPage.
-                  // When exporting layout but only manual or no breaks, a <print> with
-                  // layout informations is generated only for the measure type TopSystem,
-                  // as it is assumed the system layout is broken by the importing application
-                  // anyway and is thus useless.
-
-                  int currentSystem = NoSystem;
-                  Measure* previousMeasure = 0;
-
-                  for (MeasureBase* currentMeasureB = m->prev(); currentMeasureB; currentMeasureB = currentMeasureB->prev()) {
-                        if (currentMeasureB->type() == Element::MEASURE) {
-                              previousMeasure = (Measure*) currentMeasureB;
-                              break;
-                              }
-                        }
-
-                  if (!previousMeasure)
-                        currentSystem = TopSystem;
-                  else if (m->parent()->parent() != previousMeasure->parent()->parent())
-                        currentSystem = NewPage;
-                  else if (m->parent() != previousMeasure->parent())
-                        currentSystem = NewSystem;
-
-                  bool prevMeasLineBreak = false;
-                  bool prevMeasPageBreak = false;
-                  if (previousMeasure) {
-                        prevMeasLineBreak = previousMeasure->lineBreak();
-                        prevMeasPageBreak = previousMeasure->pageBreak();
-                        }
-
-                  if (currentSystem != NoSystem) {
-
-                        // determine if a new-system or new-page is required
-                        QString newThing; // new-[system|page]="yes" or empty
-                        if (preferences.musicxmlExportBreaks == ALL_BREAKS) {
-                              if (currentSystem == NewSystem)
-                                    newThing = " new-system=\"yes\"";
-                              else if (currentSystem == NewPage)
-                                    newThing = " new-page=\"yes\"";
-                              }
-                        else if (preferences.musicxmlExportBreaks == MANUAL_BREAKS) {
-                              if (currentSystem == NewSystem && prevMeasLineBreak)
-                                    newThing = " new-system=\"yes\"";
-                              else if (currentSystem == NewPage && prevMeasPageBreak)
-                                    newThing = " new-page=\"yes\"";
-                              }
-
-                        // determine if layout information is required
-                        bool doLayout = false;
-                        if (preferences.musicxmlExportLayout) {
-                              if (currentSystem == TopSystem
-                                  || (preferences.musicxmlExportBreaks == ALL_BREAKS && newThing != "")) {
-                                    doLayout = true;
-                                    }
-                              }
-
-                        if (doLayout) {
-                              xml.stag(QString("print%1").arg(newThing));
-                              const double pageWidth  = getTenthsFromInches(pf->size().width());
-                              const double lm = getTenthsFromInches(pf->oddLeftMargin());
-                              const double rm = getTenthsFromInches(pf->oddRightMargin());
-                              const double tm = getTenthsFromInches(pf->oddTopMargin());
-
-                              // System Layout
-                              // Put the system print suggestions only for the first part in a score...
-                              if (idx == 0) {
-                                    // Find the right margin of the system.
-                                    double systemLM = getTenthsFromDots(m->pagePos().x() - m->system()->page()->pagePos().x()) - lm;
-                                    double systemRM = pageWidth - rm - (getTenthsFromDots(m->system()->bbox().width()) + lm);
-
-                                    xml.stag("system-layout");
-                                    xml.stag("system-margins");
-                                    xml.tag("left-margin", QString("%1").arg(QString::number(systemLM,'f',2)));
-                                    xml.tag("right-margin", QString("%1").arg(QString::number(systemRM,'f',2)) );
-                                    xml.etag();
-
-                                    if (currentSystem == NewPage || currentSystem == TopSystem)
-                                          xml.tag("top-system-distance", QString("%1").arg(QString::number(getTenthsFromDots(m->pagePos().y()) - tm,'f',2)) );
-                                    if (currentSystem == NewSystem)
-                                          xml.tag("system-distance", QString("%1").arg(QString::number(getTenthsFromDots(m->pagePos().y() - previousMeasure->pagePos().y() - previousMeasure->bbox().height()),'f',2)));
-
-                                    xml.etag();
-                                    }
-
-                              // Staff layout elements.
-                              for (int staffIdx = (staffCount == 0) ? 1 : 0; staffIdx < staves; staffIdx++) {
-                                    xml.stag(QString("staff-layout number=\"%1\"").arg(staffIdx + 1));
-                                    xml.tag("staff-distance", QString("%1").arg(QString::number(getTenthsFromDots(mb->system()->staff(staffCount + staffIdx - 1)->distanceDown()),'f',2)));
-                                    xml.etag();
-                                    }
-
-                              xml.etag();
-                              }
-                        else {
-                              // !doLayout
-                              if (newThing != "")
-                                    xml.tagE(QString("print%1").arg(newThing));
-                              }
-
-                        } // if (currentSystem ...
-
-                  attr.start();
-
-                  findTrills(m, strack, etrack, trillStart, trillStop);
-
-                  // barline left must be the first element in a measure
-                  barlineLeft(m);
-
-                  // output attributes with the first actual measure (pickup or regular)
-                  if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
-                        attr.doAttr(xml, true);
-                        xml.tag("divisions", MScore::division / div);
-                        }
-                  // output attributes at start of measure: key, time
-                  keysigTimesig(m, strack, etrack);
-                  // output attributes with the first actual measure (pickup or regular) only
-                  if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
-                        if (staves > 1)
-                              xml.tag("staves", staves);
-                        }
-                  // output attribute at start of measure: clef
-                  for (Segment* seg = m->first(); seg; seg = seg->next()) {
-
-                        if (seg->tick() > m->tick())
-                              break;
-                        Element* el = seg->element(strack);
-                        if (!el)
-                              continue;
-                        if (el->type() == Element::CLEF)
-                              for (int st = strack; st < etrack; st += VOICES) {
-                                    // sstaff - xml staff number, counting from 1 for this
-                                    // instrument
-                                    // special number 0 -> dont show staff number in
-                                    // xml output (because there is only one staff)
-
-                                    int sstaff = (staves > 1) ? st - strack + VOICES : 0;
-                                    sstaff /= VOICES;
-
-                                    el = seg->element(st);
-                                    if (el && el->type() == Element::CLEF) {
-                                          Clef* cle = static_cast<Clef*>(el);
-                                          int ct = cle->clefType();
-                                          int ti = cle->segment()->tick();
-#ifdef DEBUG_CLEF
-                                          qDebug("exportxml: clef at start measure ti=%d ct=%d gen=%d", ti, ct, el->generated());
-#endif
-                                          // output only clef changes, not generated clefs at line beginning
-                                          // exception: at tick=0, export clef anyway
-                                          if (ti == 0 || !cle->generated()) {
-#ifdef DEBUG_CLEF
-                                                qDebug("exportxml: clef exported");
-#endif
-                                                clef(sstaff, ct);
-                                                }
-                                          else {
-#ifdef DEBUG_CLEF
-                                                qDebug("exportxml: clef not exported");
-#endif
-                                                }
-                                          }
-                                    }
-                        }
-
-                  // output attributes with the first actual measure (pickup or regular) only
-                  if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
-                        const Instrument* instrument = part->instr();
-
-                        // staff details
-                        // TODO: decide how to handle linked regular / TAB staff
-                        //       currently exported as a two staff part ...
-                        for (int i = 0; i < staves; i++) {
-                              Staff* st = part->staff(i);
-                              if (st->lines() != 5) {
-                                    if (staves > 1)
-                                          xml.stag(QString("staff-details number=\"%1\"").arg(i+1));
-                                    else
-                                          xml.stag("staff-details");
-                                    xml.tag("staff-lines", st->lines());
-                                    if (st->isTabStaff() && instrument->tablature()) {
-                                          QList<int> l = instrument->tablature()->stringList();
-                                          for (int i = 0; i < l.size(); i++) {
-                                                char step  = ' ';
-                                                int alter  = 0;
-                                                int octave = 0;
-                                                midipitch2xml(l.at(i), step, alter, octave);
-                                                xml.stag(QString("staff-tuning line=\"%1\"").arg(i+1));
-                                                xml.tag("tuning-step", QString("%1").arg(step));
-                                                if (alter)
-                                                      xml.tag("tuning-alter", alter);
-                                                xml.tag("tuning-octave", octave);
-                                                xml.etag();
-                                                }
-                                          }
-                                    xml.etag();
-                                    }
-                              }
-                        // instrument details
-                        if (instrument->transpose().chromatic) {
-                              xml.stag("transpose");
-                              xml.tag("diatonic",  instrument->transpose().diatonic);
-                              xml.tag("chromatic", instrument->transpose().chromatic);
-                              xml.etag();
-                              }
-                        }
-
-                  // output attribute at start of measure: measure-style
-                  measureStyle(xml, attr, m);
-
-                  // MuseScore limitation: repeats are always in the first part
-                  // and are implicitly placed at either measure start or stop
-                  if (idx == 0)
-                        repeatAtMeasureStart(xml, attr, m, strack, etrack, strack);
-
-                  for (int st = strack; st < etrack; ++st) {
-                        // sstaff - xml staff number, counting from 1 for this
-                        // instrument
-                        // special number 0 -> dont show staff number in
-                        // xml output (because there is only one staff)
-
-                        int sstaff = (staves > 1) ? st - strack + VOICES : 0;
-                        sstaff /= VOICES;
-
-                        for (Segment* seg = m->first(); seg; seg = seg->next()) {
-                              Element* el = seg->element(st);
-                              if (!el)
-                                    continue;
-                              // must ignore start repeat to prevent spurious backup/forward
-                              if (el->type() == Element::BAR_LINE && static_cast<BarLine*>(el)->barLineType() == START_REPEAT)
-                                    continue;
-
-                              // look for harmony element for this tick position
-                              if (el->isChordRest()) {
-                                    QList<Element*> list;
-
-#if 0 // TODO-WS
-                                    foreach(Element* he, *m->el()) {
-                                          if ((he->type() == Element::HARMONY) && (he->staffIdx() == sstaff)
-                                              && (he->tick() == el->tick())) {
-                                                list << he;
-                                                }
-                                          }
-#endif
-
-                                    qSort(list.begin(), list.end(), elementRighter);
-
-                                    foreach (Element* hhe, list) {
-                                          attr.doAttr(xml, false);
-                                          qDebug("writing harmony");
-                                          harmony((Harmony*)hhe, 0);
-                                          }
-                                    }
-
-                              // generate backup or forward to the start time of the element
-                              // but not for breath, which has the same start time as the
-                              // previous note, while tick is already at the end of that note
-                              if (tick != seg->tick()) {
-                                    attr.doAttr(xml, false);
-                                    if (el->type() != Element::BREATH)
-                                          moveToTick(seg->tick());
-                                    }
-
-                              // handle annotations and spanners (directions attached to this note or rest)
-                              if (el->isChordRest()) {
-                                    attr.doAttr(xml, false);
-                                    annotations(this, xml, strack, etrack, st, sstaff, seg);
-                                    figuredBass(xml, strack, etrack, st, static_cast<const ChordRest*>(el), fbMap);
-                                    spannerStop(this, strack, etrack, st, sstaff, seg);
-                                    spannerStart(this, strack, etrack, st, sstaff, seg);
-                                    }
-
-                              switch (el->type()) {
-
-                                    case Element::CLEF:
-                                          {
-                                          // output only clef changes, not generated clefs
-                                          // at line beginning
-                                          // also ignore clefs at the start of a measure,
-                                          // these have already been output
-                                          int ct = ((Clef*)el)->clefType();
-#ifdef DEBUG_CLEF
-                                          int ti = seg->tick();
-                                          qDebug("exportxml: clef in measure ti=%d ct=%d gen=%d", ti, ct, el->generated());
-#endif
-                                          if (el->generated()) {
-#ifdef DEBUG_CLEF
-                                                qDebug("exportxml: generated clef not exported");
-#endif
-                                                break;
-                                                }
-                                          if (!el->generated() && seg->tick() != m->tick())
-                                                clef(sstaff, ct);
-                                          else {
-#ifdef DEBUG_CLEF
-                                                qDebug("exportxml: clef not exported");
-#endif
-                                                }
-                                          }
-                                          break;
-
-                                    case Element::KEYSIG:
-                                          // ignore
-                                          break;
-
-                                    case Element::TIMESIG:
-                                          // ignore
-                                          break;
-
-                                    case Element::CHORD:
-                                          {
-                                          Chord* c                 = static_cast<Chord*>(el);
-                                          const QList<Lyrics*>* ll = &c->lyricsList();
-
-                                          chord(c, sstaff, ll, part->instr()->useDrumset());
-                                          break;
-                                          }
-                                    case Element::REST:
-                                          rest((Rest*)el, sstaff);
-                                          break;
-
-                                    case Element::BAR_LINE:
-                                          // Following must be enforced (ref MusicXML barline.dtd):
-                                          // If location is left, it should be the first element in the measure;
-                                          // if location is right, it should be the last element.
-                                          // implementation note: START_REPEAT already written by barlineLeft()
-                                          // any bars left should be "middle"
-                                          // TODO: print barline only if middle
-                                          // if (el->subtype() != START_REPEAT)
-                                          //       bar((BarLine*) el);
-                                          break;
-                                    case Element::BREATH:
-                                          // ignore, already exported as note articulation
-                                          break;
-
-                                    default:
-                                          qDebug("ExportMusicXml::write unknown segment type %s\n", el->name());
-                                          break;
-                                    }
-                              } // for (Segment* seg = ...
-                        attr.stop(xml);
-                        } // for (int st = ...
-                  // move to end of measure (in case of incomplete last voice)
-#ifdef DEBUG_TICK
-                  qDebug("end of measure");
-#endif
-                  moveToTick(m->tick() + m->ticks());
-                  if (idx == 0)
-                        repeatAtMeasureStop(xml, m, strack, etrack, strack);
-                  // note: don't use "m->repeatFlags() & RepeatEnd" here, because more
-                  // barline types need to be handled besides repeat end ("light-heavy")
-                  barlineRight(m);
-                  xml.etag();
-                  }
-            staffCount += staves;
-            xml.etag();
-            }
+      writeParts(dev);
 
       xml.etag();
+      xml.flush();
       }
 
 //---------------------------------------------------------
@@ -4416,6 +4566,7 @@ void ExportMusicXml::write(QIODevice* dev)
 
 bool saveXml(Score* score, const QString& name)
       {
+      score->ensureLayout();
       QFile f(name);
       if (!f.open(QIODevice::WriteOnly))
             return false;
@@ -4425,6 +4576,23 @@ bool saveXml(Score* score, const QString& name)
       }
 
 
+//---------------------------------------------------------
+//   MxlEntry
+//    write only device passing everything written to it
+//    to the current file of a QZipWriter
+//---------------------------------------------------------
+
+class MxlEntry : public QIODevice {
+      QZipWriter* zip;
+
+   protected:
+      virtual qint64 readData(char*, qint64)                 { return -1; }
+      virtual qint64 writeData(const char* data, qint64 len) { zip->writeFileData(data, len); return len; }
+
+   public:
+      MxlEntry(QZipWriter* z) : zip(z) {}
+      };
+
 //---------------------------------------------------------
 //   saveMxl
 //    return false on error
@@ -4446,6 +4614,7 @@ bool saveXml(Score* score, const QString& name)
 
 bool saveMxl(Score* score, const QString& name)
       {
+      score->ensureLayout();
       QZipWriter uz(name);
 
       QFileInfo fi(name);
@@ -4473,14 +4642,15 @@ bool saveMxl(Score* score, const QString& name)
       //uz.addDirectory("META-INF");
       uz.addFile("META-INF/container.xml", cbuf.data());
 
-      QBuffer dbuf;
-      dbuf.open(QIODevice::ReadWrite);
+      // deflate the document while it is written
+      MxlEntry entry(&uz);
+      entry.open(QIODevice::WriteOnly);
+      uz.startFile(fn);
       ExportMusicXml em(score);
-      em.write(&dbuf);
-      dbuf.seek(0);
-      uz.addFile(fn, dbuf.data());
+      em.write(&entry);
+      uz.endFile();
       uz.close();
-      return true;
+      return uz.status() == QZipWriter::NoError;
       }
 
 double ExportMusicXml::getTenthsFromInches(double inches)
@@ -29,6 +29,7 @@
 #include "exportmidi.h"
 #include "libmscore/xml.h"
 #include "libmscore/element.h"
+#include "libmscore/symbatch.h"
 #include "libmscore/note.h"
 #include "libmscore/rest.h"
 #include "libmscore/sig.h"
@@ -117,9 +118,11 @@ extern MasterSynthesizer* synti;
 
 static void paintElements(QPainter& p, const QList<const Element*>& el)
       {
+      SymBatch batch(&p);
       foreach(const Element* e, el) {
             if (!e->visible())
                   continue;
+            batch.setZ(e->z());
             QPointF pos(e->pagePos());
             p.translate(pos);
             e->draw(&p);
@@ -1405,6 +1408,7 @@ QString MuseScore::getDrumsetFilename(bool open)
 
 void MuseScore::printFile()
       {
+      cs->ensureLayout();
       QPrinter printerDev(QPrinter::HighResolution);
       const PageFormat* pf = cs->pageFormat();
       printerDev.setPaperSize(pf->size(), QPrinter::Inch);
@@ -1581,6 +1585,7 @@ bool MuseScore::exportParts()
 
 bool MuseScore::saveAs(Score* cs, bool saveCopy, const QString& path, const QString& ext)
       {
+      cs->ensureLayout();
       bool rv = false;
       QString suffix = "." + ext;
       QString fn(path);
@@ -1670,6 +1675,7 @@ bool MuseScore::saveAs(Score* cs, bool saveCopy, const QString& path, const QStr
 
 bool MuseScore::saveMidi(Score* score, const QString& name)
       {
+      score->ensureLayout();
       ExportMidi em(score);
       return em.write(name, preferences.midiExpandRepeats);
       }
@@ -1685,6 +1691,7 @@ bool MuseScore::savePdf(const QString& saveName)
 
 bool MuseScore::savePdf(Score* cs, const QString& saveName)
       {
+      cs->ensureLayout();
       QPrinter printerDev(QPrinter::HighResolution);
       const PageFormat* pf = cs->pageFormat();
       printerDev.setPaperSize(pf->size(), QPrinter::Inch);
@@ -1993,6 +2000,7 @@ bool MuseScore::savePng(Score* score, const QString& name)
 
 bool MuseScore::savePng(Score* score, const QString& name, bool screenshot, bool transparent, double convDpi, QImage::Format format)
       {
+      score->ensureLayout();
       bool rv = true;
       score->setPrinting(!screenshot);    // dont print page break symbols etc.
 
@@ -2026,7 +2034,7 @@ bool MuseScore::savePng(Score* score, const QString& name, bool screenshot, bool
             p.setRenderHint(QPainter::TextAntialiasing, true);
             p.scale(mag, mag);
 
-            paintElements(p, page->elements());
+            paintElements(p, page->displayList());
 
             if (format == QImage::Format_Indexed8) {
                   //convert to grayscale & respect alpha
@@ -2156,6 +2164,7 @@ QString MuseScore::getWallpaper(const QString& caption)
 
 bool MuseScore::saveSvg(Score* score, const QString& saveName)
       {
+      score->ensureLayout();
       SvgGenerator printer;
       printer.setResolution(converterDpi);
       QString title(score->metaTag("workTitle"));
@@ -2180,7 +2189,7 @@ bool MuseScore::saveSvg(Score* score, const QString& saveName)
       p.scale(mag, mag);
 
       foreach (Page* page, score->pages()) {
-            paintElements(p, page->elements());
+            paintElements(p, page->displayList());
             p.translate(QPointF(pf->width() * MScore::DPI, 0.0));
             }
 
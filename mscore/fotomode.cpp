@@ -809,9 +809,8 @@ void ScoreView::paintRect(bool printMode, QPainter& p, const QRectF& r, double m
             if (pr.left() > r.right())
                   break;
             p.translate(page->pos());
-            QList<Element*> ell = page->items(r.translated(-page->pos()));
-            qStableSort(ell.begin(), ell.end(), elementLessThan);
-            drawElements(p, ell);
+            QRectF cr(r.translated(-page->pos()));
+            drawElements(p, page->displayItems(cr), cr);
             p.translate(-page->pos());
             }
 
@@ -95,9 +95,9 @@ GuitarPro::~GuitarPro()
 
 void GuitarPro::skip(qint64 len)
       {
-      char c;
-      while (len--)
-            read(&c, 1);
+      if (!f.skip(len))
+            throw GP_EOF;
+      curPos += len;
       }
 
 //---------------------------------------------------------
@@ -108,11 +108,8 @@ void GuitarPro::read(void* p, qint64 len)
       {
       if (len == 0)
             return;
-      qint64 rv = f->read((char*)p, len);
-      if (rv != len) {
-            abort();
+      if (!f.read(p, len))
             throw GP_EOF;
-            }
       curPos += len;
       }
 
@@ -122,9 +119,10 @@ void GuitarPro::read(void* p, qint64 len)
 
 int GuitarPro::readChar()
       {
-      char c;
-      read(&c, 1);
-      return c;
+      if (f.atEnd())
+            throw GP_EOF;
+      ++curPos;
+      return f.readChar();
       }
 
 //---------------------------------------------------------
@@ -133,9 +131,10 @@ int GuitarPro::readChar()
 
 int GuitarPro::readUChar()
       {
-      uchar c;
-      read(&c, 1);
-      return c;
+      if (f.atEnd())
+            throw GP_EOF;
+      ++curPos;
+      return f.readUChar();
       }
 
 //---------------------------------------------------------
@@ -202,15 +201,10 @@ QString GuitarPro::readDelphiString()
 
 int GuitarPro::readInt()
       {
-      uchar x;
-      read(&x, 1);
-      int r = x;
-      read(&x, 1);
-      r += x << 8;
-      read(&x, 1);
-      r += x << 16;
-      read(&x, 1);
-      r += x << 24;
+      int r = f.readS32LE();
+      if (f.error())
+            throw GP_EOF;
+      curPos += 4;
       return r;
       }
 
@@ -454,7 +448,8 @@ void GuitarPro::applyBeatEffects(Chord* chord, int beatEffect)
 
 void GuitarPro1::read(QFile* fp)
       {
-      f      = fp;
+      if (!f.open(fp))
+            throw GP_EOF;
       curPos = 30;
 
       title  = readDelphiString();
@@ -646,7 +641,8 @@ void GuitarPro::setTempo(int tempo)
 
 void GuitarPro2::read(QFile* fp)
       {
-      f      = fp;
+      if (!f.open(fp))
+            throw GP_EOF;
       curPos = 30;
 
       title        = readDelphiString();
@@ -1117,7 +1113,8 @@ void GuitarPro1::readChord(Segment* seg, int track)
 
 void GuitarPro3::read(QFile* fp)
       {
-      f      = fp;
+      if (!f.open(fp))
+            throw GP_EOF;
       curPos = 30;
 
       title        = readDelphiString();
@@ -1688,7 +1685,8 @@ void GuitarPro4::readChord(Segment* seg, int track)
 
 void GuitarPro4::read(QFile* fp)
       {
-      f      = fp;
+      if (!f.open(fp))
+            throw GP_EOF;
       curPos = 30;
 
       readInfo();
@@ -2552,7 +2550,8 @@ void GuitarPro5::readMeasures()
 
 void GuitarPro5::read(QFile* fp)
       {
-      f = fp;
+      if (!f.open(fp))
+            throw GP_EOF;
       readInfo();
       readLyrics();
       readPageSetup();
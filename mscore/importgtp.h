@@ -23,6 +23,7 @@
 
 #include "libmscore/mscore.h"
 #include "libmscore/fraction.h"
+#include "binaryreader.h"
 
 namespace Ms {
 
@@ -71,7 +72,7 @@ class GuitarPro {
       int key;
 
       Score* score;
-      QFile* f;
+      BinaryReader f;
       int curPos;
 
       void skip(qint64 len);
@@ -570,7 +570,8 @@ static Score::FileError doValidate(const QString& name, QIODevice* dev)
             qDebug("importMusicXml() file '%s' is not a valid MusicXML file", qPrintable(name));
             MScore::lastError = QT_TRANSLATE_NOOP("file", "this is not a valid MusicXML file\n");
             QString text = QString("File '%1' is not a valid MusicXML file").arg(name);
-            if (musicXMLValidationErrorDialog(text, messageHandler.getErrors()) != QMessageBox::Yes)
+            // without gui try to load the file anyway
+            if (!noGui && musicXMLValidationErrorDialog(text, messageHandler.getErrors()) != QMessageBox::Yes)
                   return Score::FILE_USER_ABORT;
             }
 
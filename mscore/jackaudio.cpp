@@ -24,6 +24,7 @@
 #include "preferences.h"
 // #include "msynth/synti.h"
 #include "seq.h"
+#include "rtaudit.h"
 
 #include <jack/midiport.h>
 
@@ -36,7 +37,9 @@ namespace Ms {
 JackAudio::JackAudio(Seq* s)
    : Driver(s)
       {
-      client = 0;
+      client       = 0;
+      useJackAudio = false;
+      useJackMidi  = false;
       }
 
 //---------------------------------------------------------
@@ -156,7 +159,7 @@ bool JackAudio::start()
             qDebug("JACK: cannot activate client\n");
             return false;
             }
-      if (preferences.useJackAudio) {
+      if (useJackAudio) {
             /* connect the ports. Note: you can't do this before
                the client is activated, because we can't allow
                connections to be made to clients that aren't
@@ -181,7 +184,7 @@ bool JackAudio::start()
                   }
 
             }
-      if (preferences.useJackMidi && preferences.rememberLastMidiConnections) {
+      if (useJackMidi && preferences.rememberLastMidiConnections) {
             QSettings settings;
             int nPorts = midiOutputPorts.size();
             for (int i = 0; i < nPorts; ++i) {
@@ -224,7 +227,7 @@ bool JackAudio::start()
 
 bool JackAudio::stop()
       {
-      if (preferences.useJackMidi && preferences.rememberLastMidiConnections) {
+      if (useJackMidi && preferences.rememberLastMidiConnections) {
             QSettings settings;
             settings.setValue("midiPorts", midiOutputPorts.size());
             int port = 0;
@@ -280,9 +283,27 @@ int JackAudio::framePos() const
       }
 
 
-static int bufsize_callback(jack_nframes_t /*n*/, void*)
+//---------------------------------------------------------
+//   bufferSizeChanged
+//    JACK calls this outside of the process callback;
+//    it is the only place where the buffer is resized
+//---------------------------------------------------------
+
+int JackAudio::bufferSizeChanged(jack_nframes_t n, void* p)
+      {
+      JackAudio* audio = (JackAudio*)p;
+      audio->_segmentSize = n;
+      audio->buffer.resize(n * 2);
+      return 0;
+      }
+
+//---------------------------------------------------------
+//   xrun
+//---------------------------------------------------------
+
+int JackAudio::xrun(void*)
       {
-//      qDebug("JACK: buffersize changed %d\n", n);
+      ++rtStats.xruns;
       return 0;
       }
 
@@ -319,23 +340,27 @@ static int graph_callback(void*)
 int JackAudio::processAudio(jack_nframes_t frames, void* p)
       {
       JackAudio* audio = (JackAudio*)p;
+      RtCallback rt(frames, MScore::sampleRate);
+
       float* l;
       float* r;
-      if (preferences.useJackAudio) {
-            l = (float*)jack_port_get_buffer(audio->ports[0], frames);
-            r = (float*)jack_port_get_buffer(audio->ports[1], frames);
+      if (audio->useJackAudio) {
+            l = (float*)jack_port_get_buffer(audio->ports.at(0), frames);
+            r = (float*)jack_port_get_buffer(audio->ports.at(1), frames);
             }
       else {
             l = 0;
             r = 0;
             }
-      if (preferences.useJackMidi) {
-            foreach(jack_port_t* port, audio->midiOutputPorts) {
-                  void* portBuffer = jack_port_get_buffer(port, frames);
+      if (audio->useJackMidi) {
+            int n = audio->midiOutputPorts.size();
+            for (int i = 0; i < n; ++i) {
+                  void* portBuffer = jack_port_get_buffer(audio->midiOutputPorts.at(i), frames);
                   jack_midi_clear_buffer(portBuffer);
                   }
-            foreach(jack_port_t* port, audio->midiInputPorts) {
-                  void* portBuffer = jack_port_get_buffer(port, frames);
+            n = audio->midiInputPorts.size();
+            for (int k = 0; k < n; ++k) {
+                  void* portBuffer = jack_port_get_buffer(audio->midiInputPorts.at(k), frames);
                   if (portBuffer) {
                         jack_nframes_t n = jack_midi_get_event_count(portBuffer);
                         for (jack_nframes_t i = 0; i < n; ++i) {
@@ -347,26 +372,20 @@ int JackAudio::processAudio(jack_nframes_t frames, void* p)
                               int type = event.buffer[0];
                               if (nn && (type == ME_CLOCK || type == ME_SENSE))
                                     continue;
-                              Event e;
-                              e.setType(type);
-                              e.setChannel(type & 0xf);
+                              if (nn < 3)
+                                    continue;
+                              int channel = type & 0xf;
                               type &= 0xf0;
-                              if (type == ME_NOTEON || type == ME_NOTEOFF) {
-                                    e.setPitch(event.buffer[1]);
-                                    e.setVelo(event.buffer[2]);
-                                    audio->seq->eventToGui(e);
-                                    }
-                              else if (type == ME_CONTROLLER) {
-                                    e.setController(event.buffer[1]);
-                                    e.setValue(event.buffer[2]);
-                                    audio->seq->eventToGui(e);
-                                    }
+                              if (type == ME_NOTEON || type == ME_NOTEOFF || type == ME_CONTROLLER)
+                                    audio->seq->eventToGui(NPlayEvent(type, channel, event.buffer[1], event.buffer[2]));
                               }
                         }
                   }
             }
-      if (l && r) {
-            float buffer[frames * 2];
+      // the buffer size callback keeps the buffer in sync with
+      // frames; never resize it here
+      if (l && r && unsigned(audio->buffer.size()) >= frames * 2) {
+            float* buffer = audio->buffer.data();
             audio->seq->process((unsigned)frames, buffer);
             float* sp = buffer;
             for (unsigned i = 0; i < frames; ++i) {
@@ -417,18 +436,24 @@ bool JackAudio::init()
       jack_set_error_function(jackError);
       jack_set_process_callback(client, processAudio, this);
       //jack_on_shutdown(client, processShutdown, this);
-      jack_set_buffer_size_callback(client, bufsize_callback, this);
+      jack_set_buffer_size_callback(client, bufferSizeChanged, this);
+      jack_set_xrun_callback(client, xrun, this);
       jack_set_sample_rate_callback(client, srate_callback, this);
       jack_set_port_registration_callback(client, registration_callback, this);
       jack_set_graph_order_callback(client, graph_callback, this);
       jack_set_freewheel_callback (client, freewheel_callback, this);
       _segmentSize  = jack_get_buffer_size(client);
+      buffer.resize(_segmentSize * 2);
+      useJackAudio  = preferences.useJackAudio;
+      useJackMidi   = preferences.useJackMidi;
 
       MScore::sampleRate = sampleRate();
       // register mscore left/right output ports
-      if (preferences.useJackAudio) {
+      if (useJackAudio) {
             registerPort("left", false, false);
             registerPort("right", false, false);
+            if (ports.size() < 2)
+                  useJackAudio = false;
 
             // connect mscore output ports to jack input ports
             QString lport = preferences.lPort;
@@ -457,7 +482,7 @@ bool JackAudio::init()
                   }
             }
 
-      if (preferences.useJackMidi) {
+      if (useJackMidi) {
             for (int i = 0; i < preferences.midiPorts; ++i)
                   registerPort(QString("mscore-midi-%1").arg(i+1), false, true);
             registerPort(QString("mscore-midiin-1"), true, true);
@@ -506,7 +531,7 @@ int JackAudio::getState()
 
 void JackAudio::putEvent(const Event& e, unsigned framePos)
       {
-      if (!preferences.useJackMidi)
+      if (!useJackMidi)
             return;
 
       int portIdx = e.channel() / 16;
@@ -45,7 +45,15 @@ class JackAudio : public Driver {
       QList<jack_port_t*> midiOutputPorts;
       QList<jack_port_t*> midiInputPorts;
 
+      // state used by the process callback; it must not
+      // allocate or read the global preferences
+      bool useJackAudio;            // copied from the preferences in init(); the
+      bool useJackMidi;             // preference dialog creates a new driver on change
+      QVector<float> buffer;        // interleaved stereo output of Seq::process()
+
       static int processAudio(jack_nframes_t, void*);
+      static int bufferSizeChanged(jack_nframes_t, void*);
+      static int xrun(void*);
 
    public:
       JackAudio(Seq*);
@@ -31,6 +31,7 @@
 #include "midi/midifile.h"
 #include "globals.h"
 #include "seq.h"
+#include "midilatency.h"
 #include "libmscore/utils.h"
 #include "libmscore/score.h"
 
@@ -358,6 +359,7 @@ void AlsaMidiDriver::read()
             int rv = snd_seq_event_input(alsaSeq, &ev);
             if (rv < 0)
                   return;
+            qint64 time = MidiLatency::now();
 
             if (!mscore || !mscore->midiinEnabled()) {
                   snd_seq_free_event(ev);
@@ -367,11 +369,11 @@ void AlsaMidiDriver::read()
             if (ev->type == SND_SEQ_EVENT_NOTEON) {
                   int pitch = ev->data.note.note;
                   int velo  = ev->data.note.velocity;
-                  mscore->midiNoteReceived(ev->data.note.channel, pitch, velo);
+                  mscore->midiNoteReceived(ev->data.note.channel, pitch, velo, time);
                   }
             else if (ev->type == SND_SEQ_EVENT_NOTEOFF) {    // "Virtual Keyboard" sends this
                   int pitch = ev->data.note.note;
-                  mscore->midiNoteReceived(ev->data.note.channel, pitch, 0);
+                  mscore->midiNoteReceived(ev->data.note.channel, pitch, 0, time);
                   }
             else if (ev->type == SND_SEQ_EVENT_CONTROLLER) {
                   mscore->midiCtrlReceived(ev->data.control.param,
@@ -0,0 +1,192 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "midilatency.h"
+#include "globals.h"
+#include <chrono>
+
+namespace Ms {
+
+MidiLatency midiLatency;
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void LatencyHistogram::clear()
+      {
+      for (int i = 0; i < BUCKETS; ++i)
+            _buckets[i] = 0;
+      _count = 0;
+      _sum   = 0;
+      _max   = 0;
+      }
+
+//---------------------------------------------------------
+//   add
+//---------------------------------------------------------
+
+void LatencyHistogram::add(qint64 nsec)
+      {
+      if (nsec < 0)
+            nsec = 0;
+      qint64 usec = nsec / 1000;
+      int i = 0;
+      while (i < BUCKETS - 1 && usec >= bucketLimit(i))
+            ++i;
+      ++_buckets[i];
+      ++_count;
+      _sum += nsec;
+      if (nsec > _max)
+            _max = nsec;
+      }
+
+//---------------------------------------------------------
+//   toString
+//    "n mean max" followed by the non empty buckets
+//    as "<limit:count"
+//---------------------------------------------------------
+
+QString LatencyHistogram::toString() const
+      {
+      QString s = QString("n %1 mean %2 ms max %3 ms")
+         .arg(_count)
+         .arg(double(mean()) / 1e6, 0, 'f', 3)
+         .arg(double(_max) / 1e6, 0, 'f', 3);
+      for (int i = 0; i < BUCKETS; ++i) {
+            if (_buckets[i]) {
+                  if (i == BUCKETS - 1)
+                        s += QString("  >=%1us:%2").arg(bucketLimit(i - 1)).arg(_buckets[i]);
+                  else
+                        s += QString("  <%1us:%2").arg(bucketLimit(i)).arg(_buckets[i]);
+                  }
+            }
+      return s;
+      }
+
+//---------------------------------------------------------
+//   MidiLatency
+//---------------------------------------------------------
+
+MidiLatency::MidiLatency()
+      {
+      _last = -1;
+      for (int i = 0; i < STAGES; ++i)
+            _time[i] = 0;
+      }
+
+//---------------------------------------------------------
+//   now
+//---------------------------------------------------------
+
+qint64 MidiLatency::now()
+      {
+      using namespace std::chrono;
+      return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+      }
+
+//---------------------------------------------------------
+//   start
+//    a new note on was received; an unfinished
+//    measurement is dropped
+//---------------------------------------------------------
+
+void MidiLatency::start(qint64 driverTime)
+      {
+      _time[DRIVER] = driverTime;
+      _last         = DRIVER;
+      }
+
+//---------------------------------------------------------
+//   mark
+//    stages already passed or out of order are ignored,
+//    so only the first layout and repaint after the
+//    note entry command are counted
+//---------------------------------------------------------
+
+void MidiLatency::mark(Stage s)
+      {
+      if (_last == -1 || s <= _last)
+            return;
+      if (s == REPAINT && _last != LAYOUT)
+            return;
+      qint64 t = now();
+      for (int i = _last + 1; i < s; ++i)
+            _time[i] = _time[_last];
+      _time[s] = t;
+      _last    = s;
+      if (s != REPAINT)
+            return;
+
+      for (int i = FIFO; i < STAGES; ++i)
+            _stage[i].add(_time[i] - _time[i-1]);
+      _total.add(_time[REPAINT] - _time[DRIVER]);
+      _last = -1;
+      if (midiInputTrace) {
+            QString txt;
+            for (int i = FIFO; i < STAGES; ++i)
+                  txt += QString(" %1 %2").arg(stageName(Stage(i)))
+                     .arg(double(_time[i] - _time[i-1]) / 1e6, 0, 'f', 3);
+            qDebug("midi latency %.3f ms:%s", double(_time[REPAINT] - _time[DRIVER]) / 1e6, qPrintable(txt));
+            }
+      }
+
+//---------------------------------------------------------
+//   sound
+//    the preview of the current note was started
+//---------------------------------------------------------
+
+void MidiLatency::sound(qint64 driverTime)
+      {
+      _sound.add(now() - driverTime);
+      }
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void MidiLatency::clear()
+      {
+      for (int i = 0; i < STAGES; ++i)
+            _stage[i].clear();
+      _total.clear();
+      _sound.clear();
+      _last = -1;
+      }
+
+//---------------------------------------------------------
+//   report
+//---------------------------------------------------------
+
+QString MidiLatency::report() const
+      {
+      QString s = QString("midi input latency\n  total    %1\n  sound    %2\n")
+         .arg(_total.toString()).arg(_sound.toString());
+      for (int i = FIFO; i < STAGES; ++i)
+            s += QString("  %1 %2\n").arg(stageName(Stage(i)), -8).arg(_stage[i].toString());
+      return s;
+      }
+
+//---------------------------------------------------------
+//   stageName
+//---------------------------------------------------------
+
+const char* MidiLatency::stageName(Stage s)
+      {
+      static const char* names[] = {
+            "driver", "fifo", "dispatch", "cmd", "layout", "repaint"
+            };
+      return s < STAGES ? names[s] : "";
+      }
+
+}     // namespace Ms
+
@@ -0,0 +1,96 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __MIDILATENCY_H__
+#define __MIDILATENCY_H__
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   LatencyHistogram
+//    bucket i counts values below 2^i microseconds
+//---------------------------------------------------------
+
+class LatencyHistogram {
+   public:
+      static const int BUCKETS = 24;
+
+   private:
+      int _buckets[BUCKETS];
+      int _count;
+      qint64 _sum;                  // nsec
+      qint64 _max;                  // nsec
+
+   public:
+      LatencyHistogram()            { clear(); }
+      void clear();
+      void add(qint64 nsec);
+      int count() const             { return _count; }
+      int bucket(int i) const       { return _buckets[i]; }
+      qint64 max() const            { return _max; }
+      qint64 mean() const           { return _count ? _sum / _count : 0; }
+      static qint64 bucketLimit(int i)    { return qint64(1) << i; }    // usec
+      QString toString() const;
+      };
+
+//---------------------------------------------------------
+//   MidiLatency
+//    Time stamps of a midi note on on its way from the
+//    driver to the screen. A measurement is started by
+//    the time the driver read the event, which is carried
+//    with the event to MuseScore::midiNoteReceived(); the
+//    following stages are marked in order. A measurement
+//    is complete when the note is repainted.
+//    Gui thread only, except now().
+//---------------------------------------------------------
+
+class MidiLatency {
+   public:
+      enum Stage {
+            DRIVER,           // event read by midi driver
+            FIFO,             // event reached the gui thread
+            DISPATCH,         // event handed to note entry
+            CMD,              // note added, layout starts
+            LAYOUT,           // layout done
+            REPAINT,          // score view painted
+            STAGES
+            };
+
+   private:
+      qint64 _time[STAGES];
+      int _last;              // last marked stage, -1 if idle
+      LatencyHistogram _stage[STAGES];    // time from previous stage
+      LatencyHistogram _total;            // driver to repaint
+      LatencyHistogram _sound;            // driver to preview note on
+
+   public:
+      MidiLatency();
+      static qint64 now();    // nsec, monotonic; real time safe
+
+      void start(qint64 driverTime);
+      void mark(Stage);
+      void sound(qint64 driverTime);
+      bool pending() const    { return _last != -1; }
+
+      const LatencyHistogram& stage(Stage s) const  { return _stage[s]; }
+      const LatencyHistogram& total() const         { return _total; }
+      const LatencyHistogram& soundLatency() const  { return _sound; }
+      void clear();
+      QString report() const;
+      static const char* stageName(Stage);
+      };
+
+extern MidiLatency midiLatency;
+
+}     // namespace Ms
+#endif
+
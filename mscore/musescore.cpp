@@ -24,6 +24,7 @@
 #include "textstyle.h"
 #include "libmscore/xml.h"
 #include "seq.h"
+#include "midilatency.h"
 #include "libmscore/tempo.h"
 #include "libmscore/sym.h"
 #include "pagesettings.h"
@@ -1446,6 +1447,7 @@ void MuseScore::setCurrentScoreView(ScoreView* view)
             }
       else
             cs = 0;
+      updateMidiPreviewChannel();
 
                   // set midi import panel
       QString fileName = cs ? cs->fileInfo()->filePath() : "";
@@ -1731,6 +1733,7 @@ void MeasuresDialog::accept()
 void MuseScore::midiinToggled(bool val)
       {
       _midiinEnabled = val;
+      updateMidiPreviewChannel();
       }
 
 //---------------------------------------------------------
@@ -1742,6 +1745,29 @@ bool MuseScore::midiinEnabled() const
       return preferences.enableMidiInput && _midiinEnabled;
       }
 
+//---------------------------------------------------------
+//   updateMidiPreviewChannel
+//    tell the sequencer on which channel to sound midi
+//    input: the instrument of the input position or of
+//    the selection
+//---------------------------------------------------------
+
+void MuseScore::updateMidiPreviewChannel()
+      {
+      if (!seq)
+            return;
+      int channel = -1;
+      if (cs && cs->nstaves() && midiinEnabled()) {
+            int staffIdx = cs->noteEntryMode() ? cs->inputState().track() / VOICES : cs->selection().staffStart();
+            if (staffIdx < 0 || staffIdx >= cs->nstaves())
+                  staffIdx = 0;
+            Part* p = cs->staff(staffIdx)->part();
+            if (p)
+                  channel = p->instr()->channel(0).channel;
+            }
+      seq->setMidiPreviewChannel(channel);
+      }
+
 //---------------------------------------------------------
 //   processMidiRemote
 //    return if midi remote command detected
@@ -1792,9 +1818,11 @@ bool MuseScore::processMidiRemote(MidiRemoteType type, int data)
 
 //---------------------------------------------------------
 //   midiNoteReceived
+//    time is the MidiLatency::now() stamp of the driver
+//    which read the event, 0 if unknown
 //---------------------------------------------------------
 
-void MuseScore::midiNoteReceived(int channel, int pitch, int velo)
+void MuseScore::midiNoteReceived(int channel, int pitch, int velo, qint64 time, bool previewed)
       {
       static const int THRESHOLD = 3; // iterations required before consecutive drum notes
                                      // are not considered part of a chord
@@ -1841,13 +1869,25 @@ void MuseScore::midiNoteReceived(int channel, int pitch, int velo)
                         active = 0;
                   iter = 0;
                   }
+            midiLatency.start(time ? time : MidiLatency::now());
+            midiLatency.mark(MidiLatency::FIFO);
+            // events from gui thread drivers are not yet sounding
+            if (previewed)
+                  midiLatency.sound(time);
+            else if (seq && seq->midiPreviewChannel() >= 0) {
+                  seq->startNote(seq->midiPreviewChannel(), pitch, velo, 0.0);
+                  midiLatency.sound(time ? time : MidiLatency::now());
+                  previewed = true;
+                  }
 // qDebug("    midiNoteReceived %d active %d", pitch, active);
-            cv->midiNoteReceived(pitch, active > 0);
+            cv->midiNoteReceived(pitch, active > 0, previewed);
             ++active;
             }
       else {
             if (channel != 0x09)
                   --active;
+            if (!previewed && seq && seq->midiPreviewChannel() >= 0)
+                  seq->sendEvent(NPlayEvent(ME_NOTEOFF, seq->midiPreviewChannel(), pitch, 0));
             }
       }
 
@@ -3859,6 +3899,7 @@ void MuseScore::endCmd()
                   cs->moveCursor();
             setPos(cs->inputState().tick());
             updateInputState(cs);
+            updateMidiPreviewChannel();
             updateUndoRedo();
             cs->setDirty(!cs->undo()->isClean());
             dirtyChanged(cs);
@@ -4489,6 +4530,9 @@ using namespace Ms;
 
 int main(int argc, char* av[])
       {
+      QElapsedTimer startupTimer;
+      startupTimer.start();
+
 #if defined(QT_DEBUG) && defined(Q_OS_WIN)
       qInstallMsgHandler(mscoreMessageHandler);
 #endif
@@ -4824,6 +4868,8 @@ int main(int argc, char* av[])
 
       int files = 0;
       if (noGui) {
+            if (MScore::debugMode)
+                  qDebug("startup time %lld ms", startupTimer.elapsed());
             loadScores(argv);
             exit(processNonGui() ? 0 : -1);
             }
@@ -462,7 +462,7 @@ class MuseScore : public QMainWindow, public MuseScoreCore {
       void setPlayState()      { changeState(STATE_PLAY); }
       void checkForUpdate();
       QMenu* fileMenu() const  { return _fileMenu; }
-      void midiNoteReceived(int channel, int pitch, int velo);
+      void midiNoteReceived(int channel, int pitch, int velo, qint64 time = 0, bool previewed = false);
       void midiNoteReceived(int pitch, bool ctrl);
       void instrumentChanged();
       void showMasterPalette(const QString& = 0);
@@ -524,6 +524,7 @@ class MuseScore : public QMainWindow, public MuseScoreCore {
       ScoreState state() const { return _sstate; }
       void changeState(ScoreState);
       void updateInputState(Score*);
+      void updateMidiPreviewChannel();
 
       bool readLanguages(const QString& path);
       void setRevision(QString& r)  {rev = r;}
@@ -3324,27 +3324,22 @@ QList<MidiData*> MeasureData::getMidiDatas(MidiType type) {
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
-StreamHandle::StreamHandle() :
-	size_(0), curPos_(0), point_(NULL) {
+StreamHandle::StreamHandle() {
 }
 
 StreamHandle::StreamHandle(unsigned char* p, int size) :
-	size_(size), curPos_(0), point_(p) {
+	reader_(p, size) {
 }
 
 StreamHandle::~StreamHandle() {
-	point_ = NULL;
 }
 
 bool StreamHandle::read(char* buff, int size) {
-	if (point_ != NULL && curPos_ + size <= size_) {
-		memcpy(buff, point_ + curPos_, size);
-		curPos_ += size;
-
-		return true;
-	}
+	return reader_.read(buff, size);
+}
 
-	return false;
+bool StreamHandle::skip(int size) {
+	return reader_.skip(size);
 }
 
 bool StreamHandle::write(char* /*buff*/, int /*size*/) {
@@ -3366,20 +3361,15 @@ void Block::resize(unsigned int count) {
 }
 
 void Block::doResize(unsigned int count) {
-	data_.clear();
-	for(unsigned int i=0; i<count; ++i) {
-		data_.push_back('\0');
-	}
-	//data_.resize(count);
+	data_.fill('\0', count);
 }
 
 const unsigned char* Block::data() const {
-	//return const_cast<unsigned char*>(&data_.front());
-	return &data_.front();
+	return data_.constData();
 }
 
 unsigned char* Block::data() {
-	return &data_.front();
+	return data_.data();
 }
 
 int Block::size() const {
@@ -3689,8 +3679,7 @@ bool BasicParse::jump(int offset) {
 	}
 
 	if (offset > 0) {
-		Block placeHolder(offset);
-		return handle_->read((char*) placeHolder.data(), placeHolder.size());
+		return handle_->skip(offset);
 	}
 
 	return true;
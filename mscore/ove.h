@@ -27,6 +27,8 @@
 #define DLL_EXPORT
 #endif
 
+#include "binaryreader.h"
+
 namespace OVE {
 
 class OveSong;
@@ -2236,11 +2238,10 @@ private:
 public:
 	virtual bool read(char* buff, int size);
 	virtual bool write(char* buff, int size);
+	bool skip(int size);
 
 private:
-	int size_;
-	int curPos_;
-	unsigned char* point_;
+	Ms::BinaryReader reader_;
 };
 
 // Block.h
@@ -2274,7 +2275,7 @@ private:
 
 private:
 	// char [-128, 127], unsigned char [0, 255]
-	QList<unsigned char> data_;
+	QVector<unsigned char> data_;
 };
 
 class FixedBlock: public Block {
@@ -239,8 +239,10 @@ void PianorollEditor::setStaff(Staff* st)
 
       gv->setStaff(staff, locator);
       ruler->setScore(_score, locator);
-      if (waveView)
+      if (waveView) {
             waveView->setScore(_score, locator);
+            waveView->setAudio(_score->audio());
+            }
       pos->setContext(tl, sl);
       updateSelection();
       showWave->setEnabled(_score->audio() != 0);
@@ -476,9 +478,7 @@ void PianorollEditor::cmd(QAction* a)
                         }
                   }
             }
-
-      gv->setStaff(staff, locator);
-      score()->endCmd();
+      score()->endCmd();      // updates the piano view
       }
 
 //---------------------------------------------------------
@@ -487,6 +487,7 @@ void PianorollEditor::cmd(QAction* a)
 
 void PianorollEditor::dataChanged(const QRectF&)
       {
+      gv->updateNotes();
       }
 
 //---------------------------------------------------------
@@ -627,6 +628,7 @@ Element* PianorollEditor::elementNear(QPointF)
 
 void PianorollEditor::updateAll()
       {
+      gv->updateNotes();
       gv->update();
       }
 
@@ -42,11 +42,11 @@ static int pitch2y(int pitch)
       }
 
 //---------------------------------------------------------
-//   PianoItem
+//   eventRect
+//    scene rectangle of the play event e of note n
 //---------------------------------------------------------
 
-PianoItem::PianoItem(Note* n, NoteEvent* e)
-   : QGraphicsRectItem(0), _note(n), event(e)
+static QRectF eventRect(Note* n, const NoteEvent& e)
       {
       Chord* chord = n->chord();
       int tieLen, ticks;
@@ -59,15 +59,39 @@ PianoItem::PianoItem(Note* n, NoteEvent* e)
             ticks = chord->duration().ticks();
             tieLen = n->playTicks() - ticks;
             }
+      int pitch = n->pitch() + e.pitch();
+      int len   = ticks * e.len() / 1000 + tieLen;
+      return QRectF(n->chord()->tick() + e.ontime() * ticks / 1000 + MAP_OFFSET,
+         pitch2y(pitch) + keyHeight / 4, len, keyHeight/2);
+      }
+
+//---------------------------------------------------------
+//   noteTick
+//    tick of the chord of n; grace notes are kept at the
+//    tick of their main chord
+//---------------------------------------------------------
+
+static int noteTick(Note* n)
+      {
+      Chord* chord = n->chord();
+      if (chord->isGrace())
+            chord = static_cast<Chord*>(chord->parent());
+      return chord->tick();
+      }
+
+//---------------------------------------------------------
+//   PianoItem
+//---------------------------------------------------------
+
+PianoItem::PianoItem(Note* n, const NoteEvent& e)
+   : QGraphicsRectItem(0), _note(n)
+      {
+      QRectF r(eventRect(n, e));
       setFlags(flags() | QGraphicsItem::ItemIsSelectable);
-      int pitch = n->pitch() + e->pitch();
-      int len   = ticks * e->len() / 1000 + tieLen;
-      setRect(0, 0, len, keyHeight/2);
+      setRect(0, 0, r.width(), r.height());
       setBrush(QBrush());
       setSelected(_note->selected());
-
-      setPos(_note->chord()->tick() + e->ontime() * ticks / 1000 + MAP_OFFSET,
-         pitch2y(pitch) + keyHeight / 4);
+      setPos(r.topLeft());
       }
 
 //---------------------------------------------------------
@@ -256,10 +280,16 @@ PianoView::PianoView()
       setMouseTracking(true);
       setRubberBandSelectionMode(Qt::IntersectsItemBoundingRect);
       setDragMode(QGraphicsView::RubberBandDrag);
-      _timeType = TICKS;
-      magStep   = 0;
-      staff     = 0;
-      chord     = 0;
+      _timeType   = TICKS;
+      magStep     = 0;
+      staff       = 0;
+      chord       = 0;
+      _locator    = 0;
+      ticks       = 0;
+      _generation = 0;
+      _x1         = 0.0;
+      _x2         = 0.0;
+      createLocators();
       }
 
 //---------------------------------------------------------
@@ -286,7 +316,7 @@ void PianoView::createLocators()
 
 void PianoView::moveLocator(int i)
       {
-      if (_locator[i].valid()) {
+      if (_locator && _locator[i].valid()) {
             locatorLines[i]->setVisible(true);
             qreal x = qreal(pos2pix(_locator[i]));
             locatorLines[i]->setPos(QPointF(x, 0.0));
@@ -323,6 +353,7 @@ void PianoView::wheelEvent(QWheelEvent* event)
                         }
                   }
             emit magChanged(xmag, ymag);
+            syncItems();
 
             int tpix  = (480 * 4) * xmag;
             magStep = -5;
@@ -466,29 +497,115 @@ void PianoView::ensureVisible(int tick)
 
 void PianoView::setStaff(Staff* s, Pos* l)
       {
+      if (s != staff)
+            clearNotes();
       staff    = s;
       _locator = l;
       pos.setContext(s->score()->tempomap(), s->score()->sigmap());
 
-      updateNotes();
-
-      Measure* lm = staff->score()->lastMeasure();
-      ticks       = lm->tick() + lm->ticks();
-      scene()->setSceneRect(0.0, 0.0, double(ticks + 960), keyHeight * 75);
+      _dirtyTicks.all = true;
+      syncNotes();
 
       //
       // move to something interesting
       //
-      QList<QGraphicsItem*> items = scene()->selectedItems();
       QRectF boundingRect;
-      foreach (QGraphicsItem* item, items) {
-            if (item->type() == PianoItemType)
-                  boundingRect |= item->mapToScene(item->boundingRect()).boundingRect();
+      for (auto i = _notes.constBegin(); i != _notes.constEnd(); ++i) {
+            if (i.key()->selected())
+                  boundingRect |= i.value().rect;
             }
       centerOn(boundingRect.center());
       horizontalScrollBar()->setValue(0);
       }
 
+//---------------------------------------------------------
+//   createItems
+//---------------------------------------------------------
+
+void PianoView::createItems(Note* note, PianoNote& pn)
+      {
+      for (const NoteEvent& e : note->playEvents()) {
+            PianoItem* item = new PianoItem(note, e);
+            scene()->addItem(item);
+            pn.items.append(item);
+            }
+      }
+
+//---------------------------------------------------------
+//   removeItems
+//---------------------------------------------------------
+
+void PianoView::removeItems(PianoNote& pn)
+      {
+      foreach (PianoItem* item, pn.items) {
+            scene()->removeItem(item);
+            delete item;
+            }
+      pn.items.clear();
+      }
+
+//---------------------------------------------------------
+//   clearNotes
+//---------------------------------------------------------
+
+void PianoView::clearNotes()
+      {
+      scene()->blockSignals(true);
+      for (auto i = _notes.begin(); i != _notes.end(); ++i)
+            removeItems(i.value());
+      scene()->blockSignals(false);
+      _notes.clear();
+      _ticks.clear();
+      }
+
+//---------------------------------------------------------
+//   removeNote
+//---------------------------------------------------------
+
+void PianoView::removeNote(Note* note)
+      {
+      auto i = _notes.find(note);
+      if (i == _notes.end())
+            return;
+      removeItems(i.value());
+      _ticks.remove(i.value().tick, note);
+      _notes.erase(i);
+      }
+
+//---------------------------------------------------------
+//   addNote
+//    create, update or keep the entry of note; items are
+//    only rebuilt if the geometry of the note changed
+//---------------------------------------------------------
+
+void PianoView::addNote(Note* note)
+      {
+      QRectF rect;
+      uint key = 0;
+      for (const NoteEvent& e : note->playEvents()) {
+            QRectF r(eventRect(note, e));
+            rect |= r;
+            key = key * 31 + uint(int(r.x()));
+            key = key * 31 + uint(int(r.y()));
+            key = key * 31 + uint(int(r.width()));
+            }
+      PianoNote& pn = _notes[note];
+      pn.generation = _generation;
+      int tick = noteTick(note);
+      if (pn.tick != tick) {
+            _ticks.remove(pn.tick, note);
+            _ticks.insert(tick, note);
+            pn.tick = tick;
+            }
+      if (pn.key != key || pn.rect != rect) {
+            removeItems(pn);
+            pn.key  = key;
+            pn.rect = rect;
+            }
+      if (pn.items.isEmpty() && inView(pn))
+            createItems(note, pn);
+      }
+
 //---------------------------------------------------------
 //   addChord
 //---------------------------------------------------------
@@ -500,38 +617,178 @@ void PianoView::addChord(Chord* chord)
       for (Note* note : chord->notes()) {
             if (note->tieBack())
                   continue;
-            for (NoteEvent& e : note->playEvents())
-                  scene()->addItem(new PianoItem(note, &e));
+            addNote(note);
             }
       }
 
 //---------------------------------------------------------
 //   updateNotes
+//    synchronize the piano items with the ticks changed
+//    by the last command; only items of new, removed or
+//    changed notes are touched.
+//    Deferred until the view is shown.
 //---------------------------------------------------------
 
 void PianoView::updateNotes()
       {
-      scene()->clear();
+      if (staff == 0)
+            return;
+      _dirtyTicks.add(staff->score()->undo()->changedTicks());
+      if (_dirtyTicks.isEmpty() || !isVisible())
+            return;
+      syncNotes();
+      }
+
+//---------------------------------------------------------
+//   syncNotes
+//    visit the chords in _dirtyTicks and remove the notes
+//    of that range which were not visited
+//---------------------------------------------------------
+
+void PianoView::syncNotes()
+      {
+      TickRange r = _dirtyTicks;
+      _dirtyTicks.clear();
+      ++_generation;
+      updateViewRange();
 
       scene()->blockSignals(true);  // block changeSelection()
-      createLocators();
 
+      Score* score   = staff->score();
       int staffIdx   = staff->idx();
       int startTrack = staffIdx * VOICES;
       int endTrack   = startTrack + VOICES;
 
       Segment::SegmentTypes st = Segment::SegChordRest;
-      for (Segment* s = staff->score()->firstSegment(st); s; s = s->next1(st)) {
+      Segment* s = 0;
+      if (r.all)
+            s = score->firstSegment(st);
+      else {
+            Measure* m = score->tick2measure(qMax(r.tick1, 0));
+            s = m ? m->first(st) : 0;
+            while (s && s->tick() < r.tick1)
+                  s = s->next1(st);
+            }
+      for (; s && (r.all || s->tick() <= r.tick2); s = s->next1(st)) {
             for (int track = startTrack; track < endTrack; ++track) {
                   Chord* chord = static_cast<Chord*>(s->element(track));
                   if (chord == 0 || chord->type() != Element::CHORD)
                         continue;
                   addChord(chord);
+                  if (r.all)
+                        continue;
+                  // the items of a tie chain belong to its first
+                  // note, which may start before the range
+                  for (Note* note : chord->notes()) {
+                        Tie* tie = note->tieBack();
+                        if (tie == 0 || noteTick(tie->startNote()) >= r.tick1)
+                              continue;
+                        Note* n = tie->startNote();
+                        while (n->tieBack())
+                              n = n->tieBack()->startNote();
+                        addNote(n);
+                        }
+                  }
+            }
+      QList<Note*> removed;
+      if (r.all) {
+            for (auto i = _notes.constBegin(); i != _notes.constEnd(); ++i) {
+                  if (i.value().generation != _generation)
+                        removed.append(i.key());
                   }
             }
+      else {
+            for (auto i = _ticks.lowerBound(r.tick1); i != _ticks.end() && i.key() <= r.tick2; ++i) {
+                  if (_notes[i.value()].generation != _generation)
+                        removed.append(i.value());
+                  }
+            }
+      foreach (Note* note, removed)
+            removeNote(note);
       for (int i = 0; i < 3; ++i)
             moveLocator(i);
       scene()->blockSignals(false);
+
+      Measure* lm = staff->score()->lastMeasure();
+      int t       = lm ? lm->tick() + lm->ticks() : 0;
+      if (t != ticks) {
+            ticks = t;
+            scene()->setSceneRect(0.0, 0.0, double(ticks + 960), keyHeight * 75);
+            }
       }
-}
 
+//---------------------------------------------------------
+//   updateViewRange
+//    return true if the visible area left the range
+//    with items; the new range has a margin of one
+//    screen width on both sides
+//---------------------------------------------------------
+
+bool PianoView::updateViewRange()
+      {
+      QRectF r = mapToScene(viewport()->rect()).boundingRect();
+      if (r.left() >= _x1 && r.right() <= _x2)
+            return false;
+      qreal w = r.width();
+      _x1 = r.left() - w;
+      _x2 = r.right() + w;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   syncItems
+//    create items for notes which scrolled into view and
+//    remove the items of notes far away
+//---------------------------------------------------------
+
+void PianoView::syncItems()
+      {
+      if (!_dirtyTicks.isEmpty() || !updateViewRange())
+            return;
+      scene()->blockSignals(true);
+      for (auto i = _notes.begin(); i != _notes.end(); ++i) {
+            PianoNote& pn = i.value();
+            if (inView(pn)) {
+                  if (pn.items.isEmpty())
+                        createItems(i.key(), pn);
+                  }
+            else if (!pn.items.isEmpty())
+                  removeItems(pn);
+            }
+      scene()->blockSignals(false);
+      }
+
+//---------------------------------------------------------
+//   scrollContentsBy
+//---------------------------------------------------------
+
+void PianoView::scrollContentsBy(int dx, int dy)
+      {
+      QGraphicsView::scrollContentsBy(dx, dy);
+      if (dx)
+            syncItems();
+      }
+
+//---------------------------------------------------------
+//   resizeEvent
+//---------------------------------------------------------
+
+void PianoView::resizeEvent(QResizeEvent* event)
+      {
+      QGraphicsView::resizeEvent(event);
+      syncItems();
+      }
+
+//---------------------------------------------------------
+//   showEvent
+//---------------------------------------------------------
+
+void PianoView::showEvent(QShowEvent* event)
+      {
+      QGraphicsView::showEvent(event);
+      if (!_dirtyTicks.isEmpty() && staff)
+            syncNotes();
+      else
+            syncItems();
+      }
+}
@@ -14,13 +14,13 @@
 #define __PIANOVIEW_H__
 
 #include "libmscore/pos.h"
+#include "libmscore/undo.h"
 
 namespace Ms {
 
 class Staff;
 class Chord;
 class Note;
-class NoteEvent;
 
 enum { PianoItemType = QGraphicsItem::UserType + 1 };
 
@@ -29,17 +29,32 @@ enum { PianoItemType = QGraphicsItem::UserType + 1 };
 //---------------------------------------------------------
 
 class PianoItem : public QGraphicsRectItem {
-      Note*      _note;
-      NoteEvent* event;
+      Note* _note;
       virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = 0);
 
    public:
-      PianoItem(Note*, NoteEvent*);
+      PianoItem(Note*, const NoteEvent&);
       virtual ~PianoItem() {}
       virtual int type() const { return PianoItemType; }
       Note* note() { return _note; }
       };
 
+//---------------------------------------------------------
+//   PianoNote
+//    a note displayed in the piano roll; the items are
+//    only created while the note is near the visible area
+//---------------------------------------------------------
+
+struct PianoNote {
+      uint key;                     // hash of the item geometry
+      QRectF rect;                  // bounding rect of all items
+      int tick;                     // key in PianoView::_ticks
+      int generation;
+      QList<PianoItem*> items;
+
+      PianoNote() : key(0), tick(-1), generation(0) {}
+      };
+
 //---------------------------------------------------------
 //   PianoView
 //---------------------------------------------------------
@@ -56,6 +71,12 @@ class PianoView : public QGraphicsView {
       TType _timeType;
       int magStep;
 
+      QHash<Note*, PianoNote> _notes;
+      QMultiMap<int, Note*> _ticks; // notes by chord tick
+      int _generation;
+      TickRange _dirtyTicks;        // not yet synchronized
+      qreal _x1, _x2;               // scene range with items
+
       virtual void drawBackground(QPainter* painter, const QRectF& rect);
 
       int y2pitch(int y) const;
@@ -63,11 +84,23 @@ class PianoView : public QGraphicsView {
       int pos2pix(const Pos& p) const;
       void createLocators();
       void addChord(Chord* chord);
+      void addNote(Note* note);
+      bool inView(const PianoNote& pn) const { return pn.rect.right() >= _x1 && pn.rect.left() <= _x2; }
+      bool updateViewRange();
+      void syncItems();
+      void createItems(Note*, PianoNote&);
+      void removeItems(PianoNote&);
+      void clearNotes();
+      void removeNote(Note*);
+      void syncNotes();
 
    protected:
       virtual void wheelEvent(QWheelEvent* event);
       virtual void mouseMoveEvent(QMouseEvent* event);
       virtual void leaveEvent(QEvent*);
+      virtual void scrollContentsBy(int dx, int dy);
+      virtual void resizeEvent(QResizeEvent*);
+      virtual void showEvent(QShowEvent*);
 
    signals:
       void magChanged(double, double);
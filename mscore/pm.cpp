@@ -29,6 +29,7 @@
 #include "pm.h"
 #include "musescore.h"
 #include "seq.h"
+#include "midilatency.h"
 
 namespace Ms {
 
@@ -212,18 +213,21 @@ void PortMidiDriver::read()
       while (Pm_Poll(inputStream)) {
             int n = Pm_Read(inputStream, buffer, 1);
             if (n > 0) {
+                  // PortMidi stamps the event with Pt_Time() when it
+                  // arrives; the polling delay is part of the latency
+                  qint64 time = MidiLatency::now() - qint64(Pt_Time() - buffer[0].timestamp) * 1000000;
                   int status  = Pm_MessageStatus(buffer[0].message);
                   int type    = status & 0xF0;
                   int channel = status & 0x0F;
                   if (type == ME_NOTEON) {
                         int pitch = Pm_MessageData1(buffer[0].message);
                         int velo = Pm_MessageData2(buffer[0].message);
-                        mscore->midiNoteReceived(channel, pitch, velo);
+                        mscore->midiNoteReceived(channel, pitch, velo, time);
                         }
                   else if (type == ME_NOTEOFF) {
                         int pitch = Pm_MessageData1(buffer[0].message);
                         int velo  = Pm_MessageData2(buffer[0].message);
-                        mscore->midiNoteReceived(channel, pitch, 0);
+                        mscore->midiNoteReceived(channel, pitch, 0, time);
                         }
                   }
             }
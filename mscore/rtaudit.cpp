@@ -0,0 +1,190 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "rtaudit.h"
+
+#if defined(RT_AUDIT) && defined(__GLIBC__)
+#include <pthread.h>
+#include <dlfcn.h>
+#endif
+
+namespace Ms {
+
+RtStats rtStats;
+
+//---------------------------------------------------------
+//   reset
+//---------------------------------------------------------
+
+void RtStats::reset()
+      {
+      callbacks       = 0;
+      xruns           = 0;
+      deadlineMisses  = 0;
+      maxCallbackTime = 0;
+      lateEvents      = 0;
+      fifoOverflows   = 0;
+      allocations     = 0;
+      locks           = 0;
+      firstViolation  = 0;
+      reported        = 0;
+      }
+
+//---------------------------------------------------------
+//   report
+//    print a summary; gui thread
+//---------------------------------------------------------
+
+void RtStats::report() const
+      {
+      qDebug("audio: %d callbacks, %d xruns, %d deadline misses, max callback %.3f ms, "
+         "%d late events, %d fifo overflows",
+         int(callbacks), int(xruns), int(deadlineMisses), double(maxCallbackTime) / 1e6,
+         int(lateEvents), int(fifoOverflows));
+#ifdef RT_AUDIT
+      qDebug("audio: %d allocations, %d locks inside the callback, first at %p",
+         int(allocations), int(locks), (void*)firstViolation);
+#endif
+      }
+
+//---------------------------------------------------------
+//   audit
+//    report new violations of the real time rules;
+//    called periodically from the gui thread
+//---------------------------------------------------------
+
+void RtStats::audit()
+      {
+#ifdef RT_AUDIT
+      int n = allocations + locks;
+      if (n == reported)
+            return;
+      reported = n;
+      qDebug("RT audit: %d allocations, %d locks inside the audio callback, first at %p",
+         int(allocations), int(locks), (void*)firstViolation);
+#endif
+      }
+
+//---------------------------------------------------------
+//   RtCallback
+//---------------------------------------------------------
+
+RtCallback::RtCallback(unsigned frames, int sampleRate)
+      {
+      budget = sampleRate > 0 ? (qint64(frames) * 1000000000LL) / sampleRate : 0;
+      timer.start();
+      AudioCallback::setActive(true);
+      }
+
+RtCallback::~RtCallback()
+      {
+      AudioCallback::setActive(false);
+      qint64 t = timer.nsecsElapsed();
+      ++rtStats.callbacks;
+      if (budget && t > budget)
+            ++rtStats.deadlineMisses;
+      qint64 max = rtStats.maxCallbackTime;
+      while (t > max && !rtStats.maxCallbackTime.compare_exchange_weak(max, t))
+            ;
+      }
+
+}     // namespace Ms
+
+#if defined(RT_AUDIT) && defined(__GLIBC__)
+
+//---------------------------------------------------------
+//   violation
+//    must not allocate or lock itself
+//---------------------------------------------------------
+
+static void violation(std::atomic<int>& counter, void* addr)
+      {
+      ++counter;
+      void* expected = 0;
+      Ms::rtStats.firstViolation.compare_exchange_strong(expected, addr);
+      }
+
+//---------------------------------------------------------
+//   audit hooks
+//    replace the glibc allocator and mutex entry points
+//    for the whole process; outside of a callback they
+//    only forward to glibc
+//---------------------------------------------------------
+
+extern "C" {
+
+extern void* __libc_malloc(size_t);
+extern void* __libc_calloc(size_t, size_t);
+extern void* __libc_realloc(void*, size_t);
+extern void  __libc_free(void*);
+
+void* malloc(size_t n)
+      {
+      if (Ms::AudioCallback::active())
+            violation(Ms::rtStats.allocations, __builtin_return_address(0));
+      return __libc_malloc(n);
+      }
+
+void* calloc(size_t n, size_t size)
+      {
+      if (Ms::AudioCallback::active())
+            violation(Ms::rtStats.allocations, __builtin_return_address(0));
+      return __libc_calloc(n, size);
+      }
+
+void* realloc(void* p, size_t n)
+      {
+      if (Ms::AudioCallback::active())
+            violation(Ms::rtStats.allocations, __builtin_return_address(0));
+      return __libc_realloc(p, n);
+      }
+
+void free(void* p)
+      {
+      if (p && Ms::AudioCallback::active())
+            violation(Ms::rtStats.allocations, __builtin_return_address(0));
+      __libc_free(p);
+      }
+
+//---------------------------------------------------------
+//   pthread_mutex_lock
+//    the real function is looked up in the next object;
+//    __pthread_mutex_lock is a compat only symbol since
+//    glibc 2.34 and cannot be linked against
+//---------------------------------------------------------
+
+typedef int (*MutexLockFunction)(pthread_mutex_t*);
+
+static MutexLockFunction realMutexLock()
+      {
+      static std::atomic<MutexLockFunction> fn(nullptr);
+      MutexLockFunction f = fn.load(std::memory_order_acquire);
+      if (f == nullptr) {
+            f = (MutexLockFunction)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+            fn.store(f, std::memory_order_release);
+            }
+      return f;
+      }
+
+// resolve before the first audio callback
+static MutexLockFunction mutexLockInit = realMutexLock();
+
+int pthread_mutex_lock(pthread_mutex_t* m)
+      {
+      if (Ms::AudioCallback::active())
+            violation(Ms::rtStats.locks, __builtin_return_address(0));
+      return realMutexLock()(m);
+      }
+
+}     // extern "C"
+#endif
+
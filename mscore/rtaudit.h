@@ -0,0 +1,69 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __RTAUDIT_H__
+#define __RTAUDIT_H__
+
+#include "config.h"
+#include "synthesizer/synthesizer.h"
+#include <atomic>
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   RtStats
+//    counters written by the audio thread and read by
+//    the gui thread; all updates are lock free
+//---------------------------------------------------------
+
+struct RtStats {
+      std::atomic<int> callbacks;
+      std::atomic<int> xruns;
+      std::atomic<int> deadlineMisses;    // callback took longer than one period
+      std::atomic<qint64> maxCallbackTime;   // nsec
+      std::atomic<int> lateEvents;        // events played after their time
+      std::atomic<int> fifoOverflows;     // messages to the gui thread dropped
+
+      // only counted if built with RT_AUDIT:
+      std::atomic<int> allocations;       // malloc/free inside a callback
+      std::atomic<int> locks;             // pthread mutex locks inside a callback
+      std::atomic<void*> firstViolation;  // return address of first violation
+      int reported;                       // violations already reported (gui thread)
+
+      RtStats()   { reset(); }
+      void reset();
+      void report() const;
+      void audit();
+      };
+
+extern RtStats rtStats;
+
+//---------------------------------------------------------
+//   RtCallback
+//    marks a driver callback (AudioCallback) for the
+//    lifetime of the object and checks its run time
+//    against the period of frames/sampleRate
+//---------------------------------------------------------
+
+class RtCallback {
+      qint64 budget;                      // nsec
+      QElapsedTimer timer;
+
+   public:
+      RtCallback(unsigned frames, int sampleRate);
+      ~RtCallback();
+      static bool active()                { return AudioCallback::active(); }
+      };
+
+}     // namespace Ms
+#endif
+
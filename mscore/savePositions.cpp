@@ -45,6 +45,7 @@ static void saveMeasureEvents(Xml& xml, Measure* m, int offset)
 
 bool savePositions(Score* score, const QString& name)
       {
+      score->ensureLayout();
       segs.clear();
       QFile fp(name);
       if (!fp.open(QIODevice::WriteOnly)) {
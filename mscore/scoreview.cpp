@@ -58,6 +58,7 @@
 #include "libmscore/tablature.h"
 #include "libmscore/shadownote.h"
 #include "libmscore/sym.h"
+#include "libmscore/symbatch.h"
 #include "libmscore/lasso.h"
 #include "libmscore/box.h"
 #include "libmscore/textframe.h"
@@ -79,6 +80,7 @@
 #include "libmscore/stafftype.h"
 
 #include "navigator.h"
+#include "midilatency.h"
 #include "inspector/inspector.h"
 
 namespace Ms {
@@ -919,6 +921,7 @@ void ScoreView::setScore(Score* s)
       if (s) {
             s->setLayoutMode(LayoutPage);
             s->setLayoutAll(true);
+            s->ensureLayout();
             s->update();
             }
       }
@@ -1539,6 +1542,7 @@ void ScoreView::paintEvent(QPaintEvent* ev)
             if (editObject)      // if object is moved, it may not be covered by bsp
                   paintElement(&vp, editObject);
             }
+      midiLatency.mark(MidiLatency::REPAINT);
       }
 
 //---------------------------------------------------------
@@ -1679,9 +1683,7 @@ void ScoreView::paint(const QRect& r, QPainter& p)
       QRegion r1(r);
       if (_score->layoutMode() == LayoutLine) {
             Page* page = _score->pages().front();
-            QList<Element*> ell = page->items(fr);
-            qStableSort(ell.begin(), ell.end(), elementLessThan);
-            drawElements(p, ell);
+            drawElements(p, page->displayItems(fr), fr);
             }
       else {
             foreach (Page* page, _score->pages()) {
@@ -1692,11 +1694,10 @@ void ScoreView::paint(const QRect& r, QPainter& p)
                         continue;
                   if (pr.left() > fr.right())
                         break;
-                  QList<Element*> ell = page->items(fr.translated(-page->pos()));
-                  qStableSort(ell.begin(), ell.end(), elementLessThan);
                   QPointF pos(page->pos());
                   p.translate(pos);
-                  drawElements(p, ell);
+                  QRectF cr(fr.translated(-pos));
+                  drawElements(p, page->displayItems(cr), cr);
                   p.translate(-pos);
                   r1 -= _matrix.mapRect(pr).toAlignedRect();
                   }
@@ -2098,17 +2099,26 @@ static void drawDebugInfo(QPainter& p, const Element* _e)
 
 //---------------------------------------------------------
 //   drawElements
+//    replay the display list of a page; elements outside
+//    of clip (page coordinates) are skipped
 //---------------------------------------------------------
 
-void ScoreView::drawElements(QPainter& painter, const QList<Element*>& el)
+void ScoreView::drawElements(QPainter& painter, const QList<const Element*>& el, const QRectF& clip)
       {
+      SymBatch batch(&painter);
       foreach(const Element* e, el) {
-            e->itemDiscovered = 0;
             if (!e->visible()) {
                   if (score()->printing() || !score()->showInvisible())
                         continue;
                   }
             QPointF pos(e->pagePos());
+            if (!clip.isNull()) {
+                  QRectF r(e->bbox().translated(pos));
+                  if (r.right() < clip.left() || r.left() > clip.right()
+                     || r.bottom() < clip.top() || r.top() > clip.bottom())
+                        continue;
+                  }
+            batch.setZ(e->z());
             painter.translate(pos);
             e->draw(&painter);
             painter.translate(-pos);
@@ -4559,13 +4569,16 @@ void ScoreView::cmdTuplet(int n)
 //   midiNoteReceived
 //---------------------------------------------------------
 
-void ScoreView::midiNoteReceived(int pitch, bool chord)
+void ScoreView::midiNoteReceived(int pitch, bool chord, bool previewed)
       {
       MidiInputEvent ev;
-      ev.pitch = pitch;
-      ev.chord = chord;
+      ev.pitch     = pitch;
+      ev.chord     = chord;
+      ev.previewed = previewed;
 
-qDebug("midiNoteReceived %d chord %d", pitch, chord);
+      if (midiInputTrace)
+            qDebug("midiNoteReceived %d chord %d", pitch, chord);
+      midiLatency.mark(MidiLatency::DISPATCH);
       score()->enqueueMidiEvent(ev);
       if (!score()->undo()->active())
             cmd(0);
@@ -5072,10 +5085,20 @@ void ScoreView::gotoMeasure(Measure* measure)
 
 void ScoreView::layoutChanged()
       {
+      midiLatency.mark(MidiLatency::LAYOUT);
       if (mscore->navigator())
             mscore->navigator()->layoutChanged();
       }
 
+//---------------------------------------------------------
+//   layoutStarted
+//---------------------------------------------------------
+
+void ScoreView::layoutStarted()
+      {
+      midiLatency.mark(MidiLatency::CMD);
+      }
+
 //---------------------------------------------------------
 //   ScoreView::figuredBassEndEdit
 //    derived from harmonyEndEdit()
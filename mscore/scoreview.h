@@ -218,7 +218,7 @@ class ScoreView : public QWidget, public MuseScoreView {
       void lassoSelect();
 
       void setShadowNote(const QPointF&);
-      void drawElements(QPainter& p,const QList<Element*>& el);
+      void drawElements(QPainter& p, const QList<const Element*>& el, const QRectF& clip = QRectF());
       bool dragTimeAnchorElement(const QPointF& pos);
       void dragSymbol(const QPointF& pos);
       bool dragMeasureAnchorElement(const QPointF& pos);
@@ -411,10 +411,11 @@ class ScoreView : public QWidget, public MuseScoreView {
       void setCursorVisible(bool v);
       void showOmr(bool flag);
       Element* getCurElement() const { return curElement; }   // current item at mouse press
-      void midiNoteReceived(int pitch, bool);
+      void midiNoteReceived(int pitch, bool chord, bool previewed = false);
       void setEditPos(const QPointF&);
 
       virtual void moveCursor();
+      virtual void layoutStarted();
       virtual void layoutChanged();
       virtual void dataChanged(const QRectF&);
       virtual void updateAll();
@@ -41,6 +41,8 @@
 #include "libmscore/audio.h"
 #include "synthcontrol.h"
 #include "pianoroll.h"
+#include "rtaudit.h"
+#include "midilatency.h"
 
 #include "click.h"
 
@@ -143,6 +145,8 @@ Seq::Seq()
       oggInit  = false;
       _driver  = 0;
       playPos  = events.cbegin();
+      playedUtick = 0;
+      _midiPreview = -1;
 
       playTime  = 0;
       metronomeVolume = 0.3;
@@ -161,8 +165,6 @@ Seq::Seq()
       noteTimer->setSingleShot(true);
       connect(noteTimer, SIGNAL(timeout()), this, SLOT(stopNotes()));
       noteTimer->stop();
-
-      connect(this, SIGNAL(toGui(int)), this, SLOT(seqMessage(int)), Qt::QueuedConnection);
       }
 
 //---------------------------------------------------------
@@ -198,6 +200,7 @@ void Seq::setScoreView(ScoreView* v)
       _synti->reset();
       if (cs)
             initInstruments();
+      setMidiPreviewChannel(midiPreviewChannel());
       }
 
 //---------------------------------------------------------
@@ -244,6 +247,13 @@ void Seq::exit()
             if (MScore::debugMode)
                   qDebug("Stop I/O\n");
             stopWait();
+            if (MScore::debugMode) {
+                  rtStats.report();
+                  if (_synti)
+                        qDebug("synthesizer: %d voices stolen", _synti->stolenVoices());
+                  }
+            if ((MScore::debugMode || midiInputTrace) && midiLatency.total().count())
+                  qDebug("%s", qPrintable(midiLatency.report()));
             delete _driver;
             _driver = 0;
             }
@@ -340,6 +350,7 @@ void Seq::stop()
 void Seq::stopWait()
       {
       stop();
+      QMutex mutex;
       QWaitCondition sleep;
       int idx = 0;
       while (state != TRANSPORT_STOP) {
@@ -408,7 +419,7 @@ void Seq::guiStop()
       }
 
 //---------------------------------------------------------
-//   seqSignal
+//   seqMessage
 //    sequencer message to GUI
 //    execution environment: gui thread
 //---------------------------------------------------------
@@ -553,9 +564,27 @@ void Seq::metronome(unsigned n, float* p)
 
 //---------------------------------------------------------
 //   process
+//    the playlist is only replaced by collectEvents()
+//    while the mutex is held; if the gui thread holds it,
+//    skip the events of this period instead of waiting
 //---------------------------------------------------------
 
 void Seq::process(unsigned n, float* buffer)
+      {
+      if (!mutex.tryLock()) {
+            memset(buffer, 0, sizeof(float) * n * 2);
+            _synti->process(n, buffer);
+            return;
+            }
+      processEvents(n, buffer);
+      mutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   processEvents
+//---------------------------------------------------------
+
+void Seq::processEvents(unsigned n, float* buffer)
       {
       unsigned frames = n;
       int driverState = _driver->getState();
@@ -563,7 +592,7 @@ void Seq::process(unsigned n, float* buffer)
       if (driverState != state) {
             if (state == TRANSPORT_STOP && driverState == TRANSPORT_PLAY) {
                   state = TRANSPORT_PLAY;
-                  emit toGui('1');
+                  toGui('1');
                   }
             else if (state == TRANSPORT_PLAY && driverState == TRANSPORT_STOP) {
                   state = TRANSPORT_STOP;
@@ -572,9 +601,9 @@ void Seq::process(unsigned n, float* buffer)
                   // TODO: channel?
                   putEvent(NPlayEvent(ME_CONTROLLER, 0, CTRL_SUSTAIN, 0));
                   if (playPos == events.cend())
-                        emit toGui('2');
+                        toGui('2');
                   else
-                        emit toGui('0');
+                        toGui('0');
                   }
             else if (state != driverState)
                   qDebug("Seq: state transition %d -> %d ?\n",
@@ -599,8 +628,8 @@ void Seq::process(unsigned n, float* buffer)
                         break;
                   int n = f - playTime;
                   if (n < 0) {
-                        qDebug("%d:  %d - %d\n", playPos->first, f, playTime);
-      			n = 0;
+                        ++rtStats.lateEvents;
+                        n = 0;
                         }
                   if (n) {
                         if (cs->playMode() == PLAYMODE_SYNTHESIZER) {
@@ -635,10 +664,9 @@ void Seq::process(unsigned n, float* buffer)
                         tickRest = tickLength;
                   else if (event.type() == ME_TICK2)
                         tackRest = tackLength;
-                  mutex.lock();
                   ++playPos;
-                  mutex.unlock();
                   }
+            publishPlayPos();
             if (frames) {
                   if (cs->playMode() == PLAYMODE_SYNTHESIZER) {
                         metronome(frames, p);
@@ -699,12 +727,15 @@ void Seq::process(unsigned n, float* buffer)
 
 //---------------------------------------------------------
 //   initInstruments
+//    the samples of every program are loaded before its
+//    program change is queued for the real time thread
 //---------------------------------------------------------
 
 void Seq::initInstruments()
       {
       foreach(const MidiMapping& mm, *cs->midiMapping()) {
             Channel* channel = mm.articulation;
+            _synti->loadProgram(channel->bank, channel->program, _synti->index(channel->synti));
             foreach(const MidiCoreEvent& e, channel->init) {
                   if (e.type() == ME_INVALID)
                         continue;
@@ -723,18 +754,22 @@ void Seq::collectEvents()
       //do not collect even while playing
       if (state ==  TRANSPORT_PLAY)
             return;
-      events.clear();
 
-      mutex.lock();
-      cs->renderMidi(&events);
+      // render outside of the lock; the real time thread
+      // may still read the old playlist
+      EventMap el;
+      cs->renderMidi(&el);
       endTick = 0;
 
-      if (!events.empty()) {
-            auto e = events.cend();
+      if (!el.empty()) {
+            auto e = el.cend();
             --e;
             endTick = e->first;
             }
+      mutex.lock();
+      events.swap(el);
       playPos  = events.cbegin();
+      publishPlayPos();
       mutex.unlock();
 
       playlistChanged = false;
@@ -781,9 +816,26 @@ void Seq::setPos(int utick)
             updateSynthesizerState(ucur, utick);
 
       playTime  = cs->utick2utime(utick) * MScore::sampleRate;
-      mutex.lock();
       playPos   = events.lower_bound(utick);
-      mutex.unlock();
+      publishPlayPos();
+      }
+
+//---------------------------------------------------------
+//   publishPlayPos
+//    make the position of the last played event visible
+//    to the gui thread
+//---------------------------------------------------------
+
+void Seq::publishPlayPos()
+      {
+      if (events.empty()) {
+            playedUtick = 0;
+            return;
+            }
+      auto ppos = playPos;
+      if (ppos != events.cbegin())
+            --ppos;
+      playedUtick = ppos->first;
       }
 
 //---------------------------------------------------------
@@ -1012,9 +1064,63 @@ void Seq::guiToSeq(const SeqMsg& msg)
 //   eventToGui
 //---------------------------------------------------------
 
-void Seq::eventToGui(NPlayEvent e)
+void Seq::eventToGui(const NPlayEvent& e)
+      {
+      SeqMsg msg(SEQ_MIDI_INPUT_EVENT, e);
+      msg.time   = MidiLatency::now();
+      msg.intVal = 0;
+
+      // sound the note right away instead of waiting for
+      // note entry and layout in the gui thread; the
+      // synthesizer was looked up by setMidiPreviewChannel()
+      int preview = _midiPreview;
+      int type    = e.type();
+      if (preview >= 0 && state == TRANSPORT_STOP && (type == ME_NOTEON || type == ME_NOTEOFF)) {
+            _synti->play(NPlayEvent(type, preview & 0xffff, e.pitch(), e.velo()), preview >> 16);
+            msg.intVal = 1;
+            }
+      if (!fromSeq.tryEnqueue(msg))
+            ++rtStats.fifoOverflows;
+      }
+
+//---------------------------------------------------------
+//   setMidiPreviewChannel
+//    set the channel to sound midi input on (-1 = off)
+//    and look up its synthesizer for eventToGui()
+//    execution environment: gui thread
+//---------------------------------------------------------
+
+void Seq::setMidiPreviewChannel(int channel)
       {
-      fromSeq.enqueue(SeqMsg(SEQ_MIDI_INPUT_EVENT, e));
+      if (channel < 0 || !cs || channel >= cs->midiMapping()->size()) {
+            _midiPreview = -1;
+            return;
+            }
+      int syntiIdx = _synti->index(cs->midiMapping(channel)->articulation->synti);
+      _midiPreview = (syntiIdx << 16) | channel;
+      }
+
+//---------------------------------------------------------
+//   midiPreviewChannel
+//---------------------------------------------------------
+
+int Seq::midiPreviewChannel() const
+      {
+      int preview = _midiPreview;
+      return preview < 0 ? -1 : preview & 0xffff;
+      }
+
+//---------------------------------------------------------
+//   toGui
+//    send transport state change to the gui thread;
+//    the message is handled in heartBeatTimeout()
+//    execution environment: real time thread
+//---------------------------------------------------------
+
+void Seq::toGui(int msg)
+      {
+      if (!fromSeq.tryEnqueue(SeqMsg(SEQ_TRANSPORT, msg)))
+            ++rtStats.fifoOverflows;
       }
 
 //---------------------------------------------------------
@@ -1063,6 +1169,20 @@ void SeqMsgFifo::enqueue(const SeqMsg& msg)
       push();
       }
 
+//---------------------------------------------------------
+//   tryEnqueue
+//    real time safe version of enqueue()
+//---------------------------------------------------------
+
+bool SeqMsgFifo::tryEnqueue(const SeqMsg& msg)
+      {
+      if (isFull())
+            return false;
+      messages[widx] = msg;
+      push();
+      return true;
+      }
+
 //---------------------------------------------------------
 //   dequeue
 //---------------------------------------------------------
@@ -1107,14 +1227,19 @@ void Seq::heartBeatTimeout()
             sc->setMeter(meterValue[0], meterValue[1], meterPeakValue[0], meterPeakValue[1]);
             }
 
+      rtStats.audit();
+
       while (!fromSeq.isEmpty()) {
             SeqMsg msg = fromSeq.dequeue();
-            if (msg.id == SEQ_MIDI_INPUT_EVENT) {
+            if (msg.id == SEQ_TRANSPORT)
+                  seqMessage(msg.intVal);
+            else if (msg.id == SEQ_MIDI_INPUT_EVENT) {
                   int type = msg.event.type();
+                  bool previewed = msg.intVal;
                   if (type == ME_NOTEON)
-                        mscore->midiNoteReceived(msg.event.channel(), msg.event.pitch(), msg.event.velo());
+                        mscore->midiNoteReceived(msg.event.channel(), msg.event.pitch(), msg.event.velo(), msg.time, previewed);
                   else if (type == ME_NOTEOFF)
-                        mscore->midiNoteReceived(msg.event.channel(), msg.event.pitch(), 0);
+                        mscore->midiNoteReceived(msg.event.channel(), msg.event.pitch(), 0, msg.time, previewed);
                   else if (type == ME_CONTROLLER)
                         mscore->midiCtrlReceived(msg.event.controller(), msg.event.value());
                   }
@@ -1123,16 +1248,11 @@ void Seq::heartBeatTimeout()
       if (state != TRANSPORT_PLAY)
             return;
       int endTime = playTime;
-
-      mutex.lock();
-      auto ppos = playPos;
-      if (ppos != events.cbegin())
-            --ppos;
-      mutex.unlock();
+      int utick   = playedUtick;
 
       QRectF r;
       for (;guiPos != events.cend(); ++guiPos) {
-            if (guiPos->first > ppos->first)
+            if (guiPos->first > utick)
                   break;
             const NPlayEvent& n = guiPos->second;
             if (n.type() == ME_NOTEON) {
@@ -1156,7 +1276,6 @@ void Seq::heartBeatTimeout()
                         }
                   }
             }
-      int utick = ppos->first;
       int tick = cs->repeatList()->utick2tick(utick);
       mscore->currentScoreView()->moveCursor(tick);
       mscore->setPos(tick);
@@ -1194,7 +1313,7 @@ void Seq::updateSynthesizerState(int tick1, int tick2)
 
 double Seq::curTempo() const
       {
-      return cs->tempomap()->tempo(playPos->first);
+      return cs->tempomap()->tempo(playedUtick);
       }
 }
 
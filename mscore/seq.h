@@ -44,11 +44,11 @@ class Segment;
 
 //---------------------------------------------------------
 //   SeqMsg
-//    message format for gui -> sequencer messages
+//    message format for gui <-> sequencer messages
 //---------------------------------------------------------
 
 enum { SEQ_NO_MESSAGE, SEQ_TEMPO_CHANGE, SEQ_PLAY, SEQ_SEEK,
-       SEQ_MIDI_INPUT_EVENT
+       SEQ_MIDI_INPUT_EVENT, SEQ_TRANSPORT
       };
 
 struct SeqMsg {
@@ -58,6 +58,7 @@ struct SeqMsg {
             qreal realVal;
             };
       NPlayEvent event;
+      qint64 time;                  // driver time of midi input events
 
       SeqMsg() {}
       SeqMsg(int _id, int val) : id(_id), intVal(val) {}
@@ -78,6 +79,7 @@ class SeqMsgFifo : public FifoBase {
       SeqMsgFifo();
       virtual ~SeqMsgFifo()     {}
       void enqueue(const SeqMsg&);        // put object on fifo
+      bool tryEnqueue(const SeqMsg&);     // dont wait if fifo is full
       SeqMsg dequeue();                   // remove object from fifo
       };
 
@@ -89,7 +91,7 @@ class SeqMsgFifo : public FifoBase {
 class Seq : public QObject, public Sequencer {
       Q_OBJECT
 
-      mutable QMutex mutex;
+      mutable QMutex mutex;               // held by the real time thread while it reads events
 
       Score* cs;
       ScoreView* cv;
@@ -114,6 +116,10 @@ class Seq : public QObject, public Sequencer {
       int endTick;
 
       EventMap::const_iterator playPos;   // moved in real time thread
+      std::atomic<int> playedUtick;       // utick of last played event, published by
+                                          // the real time thread
+      std::atomic<int> _midiPreview;      // synthesizer index << 16 | channel to sound
+                                          // midi input on, -1 = off
       EventMap::const_iterator guiPos;    // moved in gui thread
       QList<const Note*> markedNotes;     // notes marked as sounding
 
@@ -127,6 +133,9 @@ class Seq : public QObject, public Sequencer {
       void collectMeasureEvents(Measure*, int staffIdx);
 
       void setPos(int);
+      void processEvents(unsigned, float*);
+      void publishPlayPos();
+      void toGui(int msg);
       void playEvent(const NPlayEvent&);
       void guiToSeq(const SeqMsg& msg);
       void metronome(unsigned n, float* l);
@@ -150,7 +159,6 @@ class Seq : public QObject, public Sequencer {
    signals:
       void started();
       void stopped();
-      int toGui(int);
       void heartBeat(int, int, int);
 
    public:
@@ -203,7 +211,9 @@ class Seq : public QObject, public Sequencer {
       void putEvent(const NPlayEvent&);
       void startNoteTimer(int duration);
       void startNote(int channel, int, int, double nt);
-      void eventToGui(NPlayEvent);
+      void eventToGui(const NPlayEvent&);
+      void setMidiPreviewChannel(int channel);
+      int midiPreviewChannel() const;
       void stopNoteTimer();
       };
 
@@ -20,17 +20,30 @@
 namespace Ms {
 
 
+static const int PEAK_BLOCK   = 64;      // frames per peak in level 0
+static const int PEAK_FACTOR  = 4;
+static const int PEAK_VERSION = 2;
+static const char PEAK_MAGIC[] = "MSPK";
+
+//---------------------------------------------------------
+//   peakHash
+//    identifies the ogg data of a peak cache
+//---------------------------------------------------------
+
+static QByteArray peakHash(const QByteArray& ogg)
+      {
+      return QCryptographicHash::hash(ogg, QCryptographicHash::Sha1);
+      }
+
 //---------------------------------------------------------
 //   VorbisData
 //---------------------------------------------------------
 
 struct VorbisData {
-      int pos;          // current position in audio->data()
+      int pos;          // current position in data
       QByteArray data;
       };
 
-static VorbisData vorbisData;
-
 static size_t ovRead(void* ptr, size_t size, size_t nmemb, void* datasource);
 static int ovSeek(void* datasource, ogg_int64_t offset, int whence);
 static long ovTell(void* datasource);
@@ -88,91 +101,259 @@ static long ovTell(void* datasource)
       return vd->pos;
       }
 
-
 //---------------------------------------------------------
-//   WaveView
+//   toPeak
 //---------------------------------------------------------
 
-WaveView::WaveView(QWidget* parent)
-   : QWidget(parent)
+static inline qint8 toPeak(float v)
       {
-      _xpos   = 0;
-      _xmag   = 0.1;
-      _timeType = TICKS;      // FRAMES
-      setMinimumHeight(50);
+      return qBound(-127, int(lrintf(v * 127.0f)), 127);
       }
 
-static const int WSCALE = 10;
-
 //---------------------------------------------------------
-//   setAudio
+//   build
+//    decode the ogg data and compute all levels;
+//    runs on a worker thread
 //---------------------------------------------------------
 
-void WaveView::setAudio(Audio* audio)
+void WavePeaks::build(const QByteArray& ogg)
       {
-      waves.clear();
+      clear();
+      _size = ogg.size();
+      _hash = peakHash(ogg);
+      VorbisData vd;
+      vd.pos  = 0;
+      vd.data = ogg;
       OggVorbis_File vf;
-      vorbisData.pos  = 0;
-      vorbisData.data = audio->data();
-      int rv = ov_open_callbacks(&vorbisData, &vf, 0, 0, ovCallbacks);
+      int rv = ov_open_callbacks(&vd, &vf, 0, 0, ovCallbacks);
       if (rv < 0) {
-            printf("ogg open failed: %d\n", rv);
+            qDebug("ogg open failed: %d", rv);
             return;
             }
-      int rn = 0;
-      const int n = 10000 / WSCALE;
-      uchar dst[n];
-      float* r = 0;
-      float* l = 0;
+      int channels = ov_info(&vf, -1)->channels;
+
+      QVector<qint8> level;
+      float mn = 0.0;
+      float mx = 0.0;
+      int n    = 0;
       for (;;) {
-            for (int i = 0; i < n; ++i) {
-                  float val = 0;
-                  for (int k = 0; k < WSCALE; ++k) {
-                        if (rn == 0) {
-                              float** pcm;
-                              int section;
-                              rn = ov_read_float(&vf, &pcm, 1000, &section);
-                              if (rn == 0) {
-                                    for (; i < n; ++i)
-                                          dst[i] = 0;
-                                    waves.append((char*)dst, n);
-                                    ov_clear(&vf);
-                                    return;
-                                    }
-                              r = pcm[0];
-                              l = pcm[1];
-                              }
-                        val += fabsf(*r++) + fabsf(*l++);
-                        --rn;
+            float** pcm;
+            int section;
+            long rn = ov_read_float(&vf, &pcm, 4096, &section);
+            if (rn == OV_HOLE)
+                  continue;
+            if (rn <= 0)
+                  break;
+            for (long i = 0; i < rn; ++i) {
+                  float v = 0.0;
+                  for (int c = 0; c < channels; ++c)
+                        v += pcm[c][i];
+                  v /= channels;
+                  if (n == 0)
+                        mn = mx = v;
+                  else {
+                        mn = qMin(mn, v);
+                        mx = qMax(mx, v);
+                        }
+                  if (++n == PEAK_BLOCK) {
+                        level.append(toPeak(mn));
+                        level.append(toPeak(mx));
+                        n = 0;
                         }
-                  unsigned int v = lrint(val * 128);
-                  if (v > 255)
-                        v = 255;
-                  dst[i] = v;
                   }
-            waves.append((char*)dst, n);
+            _frames += rn;
+            }
+      if (n) {
+            level.append(toPeak(mn));
+            level.append(toPeak(mx));
+            }
+      ov_clear(&vf);
+      if (level.isEmpty())
+            return;
+      _levels.append(level);
+
+      while (_levels.last().size() > 2) {
+            const QVector<qint8>& l = _levels.last();
+            int pairs = l.size() / 2;
+            QVector<qint8> nl;
+            nl.reserve(((pairs + PEAK_FACTOR - 1) / PEAK_FACTOR) * 2);
+            for (int i = 0; i < pairs; i += PEAK_FACTOR) {
+                  qint8 a = l[i * 2];
+                  qint8 b = l[i * 2 + 1];
+                  int e   = qMin(i + PEAK_FACTOR, pairs);
+                  for (int k = i + 1; k < e; ++k) {
+                        a = qMin(a, l[k * 2]);
+                        b = qMax(b, l[k * 2 + 1]);
+                        }
+                  nl.append(a);
+                  nl.append(b);
+                  }
+            _levels.append(nl);
+            }
+      }
+
+//---------------------------------------------------------
+//   write
+//    serialize for the score file; size and hash of the
+//    ogg data detect a stale cache
+//---------------------------------------------------------
+
+QByteArray WavePeaks::write() const
+      {
+      QByteArray ba;
+      QDataStream ds(&ba, QIODevice::WriteOnly);
+      ds.writeRawData(PEAK_MAGIC, 4);
+      ds << qint32(PEAK_VERSION) << _size << _hash
+         << qint64(_frames) << qint32(_levels.size());
+      foreach (const QVector<qint8>& l, _levels)
+            ds << l;
+      return ba;
+      }
+
+//---------------------------------------------------------
+//   read
+//    return false if ba is not a valid cache for ogg
+//---------------------------------------------------------
+
+bool WavePeaks::read(const QByteArray& ba, const QByteArray& ogg)
+      {
+      clear();
+      if (!ba.startsWith(PEAK_MAGIC))
+            return false;
+      QDataStream ds(ba);
+      ds.skipRawData(4);
+      qint32 version, size, levels;
+      QByteArray hash;
+      qint64 frames;
+      ds >> version;
+      if (ds.status() != QDataStream::Ok || version != PEAK_VERSION)
+            return false;
+      ds >> size >> hash >> frames >> levels;
+      if (ds.status() != QDataStream::Ok || size != ogg.size() || hash != peakHash(ogg))
+            return false;
+      for (int i = 0; i < levels; ++i) {
+            QVector<qint8> l;
+            ds >> l;
+            _levels.append(l);
+            }
+      if (ds.status() != QDataStream::Ok) {
+            clear();
+            return false;
             }
+      _frames = frames;
+      _size   = size;
+      _hash   = hash;
+      return true;
       }
 
 //---------------------------------------------------------
-//   pegel
+//   range
+//    min/max of the frames frame1 - frame2 from the
+//    coarsest level which still resolves the range
 //---------------------------------------------------------
 
-int WaveView::pegel(int frame1, int frame2)
+bool WavePeaks::range(qint64 frame1, qint64 frame2, int* min, int* max) const
       {
+      if (_levels.isEmpty() || frame2 <= 0 || frame1 >= _frames)
+            return false;
       if (frame1 < 0)
             frame1 = 0;
-      if (frame1 > frame2)
-            return 0;
-      frame1 = (frame1 + WSCALE/2) / WSCALE;
-      frame2 = (frame2 + WSCALE/2) / WSCALE;
-      if (frame2 >= waves.size())
-            frame2 = waves.size()-1;
-      int p = 0;
-      for (int i = frame1; i <= frame2; ++i)
-            p += uchar(waves[i]);
-      p /= (frame2 - frame1 + 1);
-      return p;
+      if (frame2 <= frame1)
+            frame2 = frame1 + 1;
+
+      qint64 block = PEAK_BLOCK;
+      int level    = 0;
+      while (level + 1 < _levels.size() && block * PEAK_FACTOR <= frame2 - frame1) {
+            block *= PEAK_FACTOR;
+            ++level;
+            }
+      const QVector<qint8>& l = _levels[level];
+      qint64 i1 = frame1 / block;
+      qint64 i2 = (frame2 - 1) / block;
+      if (i2 >= l.size() / 2)
+            i2 = l.size() / 2 - 1;
+      if (i1 > i2)
+            return false;
+      int mn = l[i1 * 2];
+      int mx = l[i1 * 2 + 1];
+      for (qint64 i = i1 + 1; i <= i2; ++i) {
+            mn = qMin(mn, int(l[i * 2]));
+            mx = qMax(mx, int(l[i * 2 + 1]));
+            }
+      *min = mn;
+      *max = mx;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   buildPeaks
+//---------------------------------------------------------
+
+static WavePeaks buildPeaks(QByteArray ogg)
+      {
+      WavePeaks peaks;
+      peaks.build(ogg);
+      return peaks;
+      }
+
+//---------------------------------------------------------
+//   WaveView
+//---------------------------------------------------------
+
+WaveView::WaveView(QWidget* parent)
+   : QWidget(parent)
+      {
+      _xpos     = 0;
+      _xmag     = 0.1;
+      _timeType = TICKS;      // FRAMES
+      _score    = 0;
+      _locator  = 0;
+      watcher   = new QFutureWatcher<WavePeaks>(this);
+      connect(watcher, SIGNAL(finished()), SLOT(peaksFinished()));
+      setMinimumHeight(50);
+      }
+
+//---------------------------------------------------------
+//   setAudio
+//    use the peaks cached in the score file if they
+//    match the audio data, else compute them in the
+//    background. The view keeps a (shared) copy of the
+//    audio data, not the Audio, which the score may
+//    delete at any time.
+//---------------------------------------------------------
+
+void WaveView::setAudio(Audio* audio)
+      {
+      _ogg = audio ? audio->data() : QByteArray();
+      peaks.clear();
+      update();
+      if (audio == 0 || peaks.read(audio->peaks(), _ogg))
+            return;
+      _building = _ogg;
+      watcher->setFuture(QtConcurrent::run(buildPeaks, _ogg));
+      }
+
+//---------------------------------------------------------
+//   peaksFinished
+//    the audio may have been replaced or removed from
+//    the score while the peaks were computed
+//---------------------------------------------------------
+
+void WaveView::peaksFinished()
+      {
+      if (_building.constData() != _ogg.constData())
+            return;
+      _building = QByteArray();
+      Audio* audio = _score ? _score->audio() : 0;
+      if (_score && (audio == 0 || audio->data().constData() != _ogg.constData())) {
+            _ogg = QByteArray();
+            update();
+            return;
+            }
+      peaks = watcher->result();
+      if (audio)
+            audio->setPeaks(peaks.write());
+      update();
       }
 
 //---------------------------------------------------------
@@ -266,13 +447,13 @@ void WaveView::paintEvent(QPaintEvent* event)
             x1 = pianoWidth;
       Pos p1 = pix2pos(x1);
       p.setPen(QPen(Qt::blue, 1));
+      int h2 = height() / 2;
       for (int i = x1+1; i < x2; ++i) {
             Pos p2 = pix2pos(i);
-            int val = height() * pegel(p1.frame(), p2.frame()) / 255;
+            int mn, mx;
+            if (peaks.range(p1.frame(), p2.frame(), &mn, &mx))
+                  p.drawLine(i, h2 - mx * h2 / 127, i, h2 - mn * h2 / 127);
             p1 = p2;
-            int y1 = height() - val;
-            int y2 = height();
-            p.drawLine(i, y1, i, y2);
             }
 
       p.setPen(QPen(Qt::lightGray, 2));
@@ -20,6 +20,29 @@ namespace Ms {
 class Audio;
 class Score;
 
+//---------------------------------------------------------
+//   WavePeaks
+//    min/max pyramid of an audio signal; level 0 has one
+//    min/max pair per PEAK_BLOCK frames, every following
+//    level combines PEAK_FACTOR pairs of the level below
+//---------------------------------------------------------
+
+class WavePeaks {
+      QList<QVector<qint8> > _levels;     // interleaved min, max
+      qint64 _frames;
+      qint32 _size;                       // size and hash of the ogg data
+      QByteArray _hash;
+
+   public:
+      WavePeaks() : _frames(0), _size(0) {}
+      bool isEmpty() const { return _levels.isEmpty(); }
+      void clear()         { _levels.clear(); _frames = 0; _size = 0; _hash.clear(); }
+      void build(const QByteArray& ogg);
+      bool read(const QByteArray&, const QByteArray& ogg);
+      QByteArray write() const;
+      bool range(qint64 frame1, qint64 frame2, int* min, int* max) const;
+      };
+
 //---------------------------------------------------------
 //   WaveView
 //---------------------------------------------------------
@@ -30,7 +53,10 @@ class WaveView : public QWidget
       Pos _cursor;
       Pos* _locator;
       Score* _score;
-      QByteArray waves;
+      QByteArray _ogg;              // audio data shown
+      QByteArray _building;         // audio data of the watched future
+      WavePeaks peaks;
+      QFutureWatcher<WavePeaks>* watcher;
 
       TType _timeType;
       int magStep;
@@ -41,7 +67,9 @@ class WaveView : public QWidget
       Pos pix2pos(int x) const;
       virtual void paintEvent(QPaintEvent*);
       virtual QSize sizeHint() const { return QSize(50, 50); }
-      int pegel(int frame1, int frame2);
+
+   private slots:
+      void peaksFinished();
 
    public slots:
       void setMag(double,double);
@@ -50,6 +78,7 @@ class WaveView : public QWidget
    public:
       WaveView(QWidget* parent = 0);
       void setAudio(Audio*);
+      bool hasPeaks() const   { return !peaks.isEmpty(); }
       void setXpos(int);
       void setScore(Score* s, Pos* lc);
       };
@@ -0,0 +1,406 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "config.h"
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "libmscore/mcursor.h"
+#include "libmscore/durationtype.h"
+#include "synthesizer/event.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   Operations
+//    timed for every score, in this order
+//---------------------------------------------------------
+
+enum Operation {
+      OP_READ, OP_LAYOUT, OP_RENDER_MIDI, OP_SAVE_MSCX, OP_SAVE_MSCZ,
+      OP_EXPORT_XML, OP_IMPORT_XML, OP_EXPORT_PDF, OPERATIONS
+      };
+
+static const char* operationNames[OPERATIONS] = {
+      "read", "layout", "renderMidi", "saveMscx", "saveMscz",
+      "exportMusicXml", "importMusicXml", "exportPdf"
+      };
+
+//---------------------------------------------------------
+//   BenchmarkResult
+//---------------------------------------------------------
+
+struct BenchmarkResult {
+      QString name;
+      QString error;
+      qint64 peakMemory;                  // bytes
+      QVector<qint64> times[OPERATIONS];  // nanoseconds, one per run
+      };
+
+//---------------------------------------------------------
+//   TestScoreBenchmark
+//    times load, layout, midi rendering and export of
+//    every score under test/ and mtest/ and of generated
+//    scores; the results are written as json to
+//    $MSCORE_BENCHMARK_OUTPUT (default benchmark.json)
+//    for comparison against a baseline
+//---------------------------------------------------------
+
+class TestScoreBenchmark : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      int runs;
+      QList<BenchmarkResult> results;
+
+      Score* createScore(const QString& name, int staves, int measures);
+      void benchmark(const QString& path, const QString& name);
+      bool writeResults(const QString& path) const;
+
+   private slots:
+      void initTestCase();
+      void scores_data();
+      void scores();
+      void synthetic_data();
+      void synthetic();
+      void cleanupTestCase();
+      };
+
+//---------------------------------------------------------
+//   resetPeakMemory
+//---------------------------------------------------------
+
+static void resetPeakMemory()
+      {
+#ifdef Q_OS_LINUX
+      QFile f("/proc/self/clear_refs");   // "5" resets VmHWM
+      if (f.open(QIODevice::WriteOnly))
+            f.write("5");
+#endif
+      }
+
+//---------------------------------------------------------
+//   peakMemory
+//    peak resident set size in bytes since the last
+//    resetPeakMemory(); without reset support this is
+//    the peak of the whole process
+//---------------------------------------------------------
+
+static qint64 peakMemory()
+      {
+#ifdef Q_OS_LINUX
+      QFile f("/proc/self/status");
+      if (f.open(QIODevice::ReadOnly)) {
+            foreach (const QByteArray& line, f.readAll().split('\n')) {
+                  if (line.startsWith("VmHWM:"))
+                        return line.mid(6).trimmed().split(' ').front().toLongLong() * 1024;
+                  }
+            }
+#endif
+#ifdef Q_OS_UNIX
+      struct rusage ru;
+      if (getrusage(RUSAGE_SELF, &ru) == 0) {
+#ifdef Q_OS_MAC
+            return ru.ru_maxrss;
+#else
+            return qint64(ru.ru_maxrss) * 1024;
+#endif
+            }
+#endif
+      return 0;
+      }
+
+//---------------------------------------------------------
+//   median
+//---------------------------------------------------------
+
+static double median(QVector<qint64> v)
+      {
+      if (v.isEmpty())
+            return 0.0;
+      qSort(v);
+      int n = v.size();
+      if (n & 1)
+            return v[n / 2];
+      return (v[n / 2 - 1] + v[n / 2]) * .5;
+      }
+
+//---------------------------------------------------------
+//   percentile
+//    nearest rank
+//---------------------------------------------------------
+
+static double percentile(QVector<qint64> v, int p)
+      {
+      if (v.isEmpty())
+            return 0.0;
+      qSort(v);
+      int rank = (p * v.size() + 99) / 100;
+      return v[qMax(rank, 1) - 1];
+      }
+
+//---------------------------------------------------------
+//   jsonString
+//---------------------------------------------------------
+
+static QString jsonString(const QString& s)
+      {
+      QString r("\"");
+      foreach (QChar c, s) {
+            if (c == '"' || c == '\\')
+                  r += QChar('\\');
+            if (c.unicode() < 0x20)
+                  r += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+            else
+                  r += c;
+            }
+      return r + "\"";
+      }
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestScoreBenchmark::initTestCase()
+      {
+      initMTest();
+      runs = qMax(qgetenv("MSCORE_BENCHMARK_RUNS").toInt(), 0);
+      if (runs == 0)
+            runs = 3;
+      }
+
+//---------------------------------------------------------
+//   createScore
+//    staves x measures of quarter and eighth notes
+//---------------------------------------------------------
+
+Score* TestScoreBenchmark::createScore(const QString& name, int staves, int measures)
+      {
+      static const char* instruments[] = { "flute", "voice", "violin", "viola", "violoncello" };
+
+      MCursor c;
+      c.setTimeSig(Fraction(4,4));
+      c.createScore(name);
+      for (int staff = 0; staff < staves; ++staff)
+            c.addPart(instruments[staff % 5]);
+      c.move(0, 0);
+      c.addKeySig(0);
+      c.addTimeSig(Fraction(4,4));
+
+      for (int staff = 0; staff < staves; ++staff) {
+            c.move(staff * VOICES, 0);
+            for (int m = 0; m < measures; ++m) {
+                  bool eighths = m & 1;
+                  int n = eighths ? 8 : 4;
+                  for (int i = 0; i < n; ++i) {
+                        int pitch = 55 + (staff * 7 + m * 3 + i * 2) % 24;
+                        c.addChord(pitch, TDuration(eighths ? TDuration::V_EIGHT : TDuration::V_QUARTER));
+                        }
+                  }
+            }
+      Score* score = c.score();
+      score->rebuildMidiMapping();
+      score->doLayout();
+      return score;
+      }
+
+//---------------------------------------------------------
+//   benchmark
+//    time all operations runs times on the score
+//    in path
+//---------------------------------------------------------
+
+void TestScoreBenchmark::benchmark(const QString& path, const QString& name)
+      {
+      BenchmarkResult r;
+      r.name = name;
+      resetPeakMemory();
+
+      QElapsedTimer t;
+      for (int run = 0; run < runs; ++run) {
+            t.start();
+            Score* s = readCreatedScore(path);
+            r.times[OP_READ].append(t.nsecsElapsed());
+            if (s == 0) {
+                  r.error = "cannot read score";
+                  break;
+                  }
+
+            t.start();
+            s->doLayout();
+            r.times[OP_LAYOUT].append(t.nsecsElapsed());
+
+            EventMap events;
+            t.start();
+            s->renderMidi(&events);
+            r.times[OP_RENDER_MIDI].append(t.nsecsElapsed());
+
+            t.start();
+            saveScore(s, "benchmark.mscx");
+            r.times[OP_SAVE_MSCX].append(t.nsecsElapsed());
+
+            QFileInfo fi("benchmark.mscz");
+            t.start();
+            try {
+                  s->saveCompressedFile(fi, false);
+                  }
+            catch (QString) {
+                  r.error = "cannot save mscz";
+                  }
+            r.times[OP_SAVE_MSCZ].append(t.nsecsElapsed());
+
+            t.start();
+            saveMusicXml(s, "benchmark.xml");
+            r.times[OP_EXPORT_XML].append(t.nsecsElapsed());
+
+            t.start();
+            Score* xs = readCreatedScore("benchmark.xml");
+            r.times[OP_IMPORT_XML].append(t.nsecsElapsed());
+            delete xs;
+
+            t.start();
+            savePdf(s, "benchmark.pdf");
+            r.times[OP_EXPORT_PDF].append(t.nsecsElapsed());
+
+            delete s;
+            }
+      r.peakMemory = peakMemory();
+      results.append(r);
+      }
+
+//---------------------------------------------------------
+//   scores
+//---------------------------------------------------------
+
+void TestScoreBenchmark::scores_data()
+      {
+      QTest::addColumn<QString>("path");
+
+      QStringList suffixes;
+      suffixes << "mscx" << "mscz" << "xml" << "mxl";
+      QDir top(TESTROOT);
+      QStringList dirs;
+      dirs << "test" << "mtest";
+      foreach (const QString& d, dirs) {
+            QStringList files;
+            QDirIterator it(top.filePath(d), QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                  QString path = it.next();
+                  if (suffixes.contains(it.fileInfo().suffix().toLower()))
+                        files.append(path);
+                  }
+            files.sort();
+            foreach (const QString& path, files)
+                  QTest::newRow(qPrintable(top.relativeFilePath(path))) << path;
+            }
+      }
+
+void TestScoreBenchmark::scores()
+      {
+      QFETCH(QString, path);
+      benchmark(path, QTest::currentDataTag());
+      }
+
+//---------------------------------------------------------
+//   synthetic
+//    generated scores of staves x measures, saved and
+//    then benchmarked like a file
+//---------------------------------------------------------
+
+void TestScoreBenchmark::synthetic_data()
+      {
+      QTest::addColumn<int>("staves");
+      QTest::addColumn<int>("measures");
+
+      QTest::newRow("4x64")    << 4  << 64;
+      QTest::newRow("16x128")  << 16 << 128;
+      QTest::newRow("32x256")  << 32 << 256;
+      QTest::newRow("48x512")  << 48 << 512;      // segment tables of many staves
+      }
+
+void TestScoreBenchmark::synthetic()
+      {
+      QFETCH(int, staves);
+      QFETCH(int, measures);
+
+      QString name = QString("synthetic-%1x%2").arg(staves).arg(measures);
+      Score* s = createScore(name, staves, measures);
+      QVERIFY(saveScore(s, name + ".mscx"));
+      delete s;
+      benchmark(name + ".mscx", name);
+      QVERIFY(results.back().error.isEmpty());
+      }
+
+//---------------------------------------------------------
+//   writeResults
+//    times in milliseconds
+//---------------------------------------------------------
+
+bool TestScoreBenchmark::writeResults(const QString& path) const
+      {
+      QFile f(path);
+      if (!f.open(QIODevice::WriteOnly))
+            return false;
+      QTextStream os(&f);
+      os.setCodec("UTF-8");
+      os << "{\n";
+      os << "  \"version\": " << jsonString(VERSION) << ",\n";
+      os << "  \"runs\": " << runs << ",\n";
+      os << "  \"scores\": [";
+      for (int i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& r = results[i];
+            os << (i ? ",\n" : "\n");
+            os << "    { \"name\": " << jsonString(r.name);
+            if (!r.error.isEmpty())
+                  os << ", \"error\": " << jsonString(r.error);
+            os << ", \"peakMemory\": " << r.peakMemory;
+            os << ", \"times\": {";
+            bool first = true;
+            for (int op = 0; op < OPERATIONS; ++op) {
+                  if (r.times[op].isEmpty())
+                        continue;
+                  os << (first ? " " : ", ");
+                  first = false;
+                  os << "\"" << operationNames[op] << "\": { \"median\": "
+                     << QString::number(median(r.times[op]) / 1e6, 'f', 3)
+                     << ", \"p95\": "
+                     << QString::number(percentile(r.times[op], 95) / 1e6, 'f', 3)
+                     << " }";
+                  }
+            os << " } }";
+            }
+      os << "\n    ]\n}\n";
+      return true;
+      }
+
+//---------------------------------------------------------
+//   cleanupTestCase
+//---------------------------------------------------------
+
+void TestScoreBenchmark::cleanupTestCase()
+      {
+      QString path = qgetenv("MSCORE_BENCHMARK_OUTPUT");
+      if (path.isEmpty())
+            path = "benchmark.json";
+      QVERIFY(writeResults(path));
+      qDebug("benchmark: %d scores, %d runs each, results in <%s>",
+         results.size(), runs, qPrintable(path));
+      }
+
+QTEST_MAIN(TestScoreBenchmark)
+#include "tst_scorebenchmark.moc"
+
@@ -31,6 +31,7 @@ class TestBiab : public QObject, public MTest
       void initTestCase();
       void biab_data();
       void biab();
+      void biabBenchmark();
       };
 
 //---------------------------------------------------------
@@ -75,6 +76,19 @@ void TestBiab::biab()
       QVERIFY(saveCompareScore(score, writeFile, reference));
       }
 
+//---------------------------------------------------------
+//   biabBenchmark
+//---------------------------------------------------------
+
+void TestBiab::biabBenchmark()
+      {
+      QBENCHMARK {
+            Score* score = readScore(DIR + "chords.SGU");
+            QVERIFY(score);
+            delete score;
+            }
+      }
+
 QTEST_MAIN(TestBiab)
 #include "tst_biab.moc"
 
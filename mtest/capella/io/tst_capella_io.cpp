@@ -61,6 +61,8 @@ private slots:
       void capxTestText1() { capxReadTest("testText1"); }
       // void capxTestTuplet1() { capxReadTest("testTuplet1"); } // generates different (incorrect ?) l1 and l2 values in beams
       void capxTestVolta1() { capxReadTest("testVolta1"); }
+
+      void capBenchmark();
       };
 
 //---------------------------------------------------------
@@ -102,5 +104,21 @@ void TestCapellaIO::capxReadTest(const char* file)
       delete score;
       }
 
+//---------------------------------------------------------
+//   capBenchmark
+//   import all binary Capella test files
+//---------------------------------------------------------
+
+void TestCapellaIO::capBenchmark()
+      {
+      QBENCHMARK {
+            for (int i = 1; i <= 8; ++i) {
+                  Score* score = readScore(DIR + QString("test%1.cap").arg(i));
+                  QVERIFY(score);
+                  delete score;
+                  }
+            }
+      }
+
 QTEST_MAIN(TestCapellaIO)
 #include "tst_capella_io.moc"
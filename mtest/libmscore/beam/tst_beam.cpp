@@ -14,6 +14,10 @@
 #include <QtTest/QtTest>
 #include "mtest/testutils.h"
 #include "libmscore/score.h"
+#include "libmscore/measure.h"
+#include "libmscore/segment.h"
+#include "libmscore/chord.h"
+#include "libmscore/stem.h"
 
 #define DIR QString("libmscore/beam/")
 
@@ -28,6 +32,7 @@ class TestBeam : public QObject, public MTest
       Q_OBJECT
 
       void beam(const char* path);
+      QList<qreal> stemLengths(Score*);
 
    private slots:
       void initTestCase();
@@ -42,6 +47,7 @@ class TestBeam : public QObject, public MTest
       void beam23()  { beam("Beam-23.mscx"); }
       void beamS0()  { beam("Beam-S0.mscx"); }
       void beamDir() { beam("Beam-dir.mscx"); }
+      void relayout();
       };
 
 //---------------------------------------------------------
@@ -66,6 +72,44 @@ void TestBeam::beam(const char* path)
       delete score;
       }
 
+//---------------------------------------------------------
+//   stemLengths
+//---------------------------------------------------------
+
+QList<qreal> TestBeam::stemLengths(Score* score)
+      {
+      QList<qreal> l;
+      Segment::SegmentTypes st = Segment::SegChordRest;
+      for (Segment* s = score->firstMeasure()->first(st); s; s = s->next1(st)) {
+            foreach (Element* e, s->elist()) {
+                  if (e && e->type() == Element::CHORD && static_cast<Chord*>(e)->stem())
+                        l.append(static_cast<Chord*>(e)->stem()->len());
+                  }
+            }
+      return l;
+      }
+
+//---------------------------------------------------------
+//   relayout
+//    a second layout takes beam results from the
+//    cache and must not change them
+//---------------------------------------------------------
+
+void TestBeam::relayout()
+      {
+      const char* files[] = { "Beam-A.mscx", "Beam-B.mscx", "Beam-23.mscx", "Beam-dir.mscx" };
+      for (const char* path : files) {
+            Score* score = readScore(DIR + path);
+            score->doLayout();
+            QList<qreal> l1 = stemLengths(score);
+            score->doLayout();
+            QList<qreal> l2 = stemLengths(score);
+            QVERIFY(!l1.isEmpty());
+            QCOMPARE(l2, l1);
+            delete score;
+            }
+      }
+
 QTEST_MAIN(TestBeam)
 #include "tst_beam.moc"
 
@@ -0,0 +1,126 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/chordlist.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestChordSymbol
+//---------------------------------------------------------
+
+class TestChordSymbol : public QObject, public MTest
+      {
+      Q_OBJECT
+
+   private slots:
+      void initTestCase();
+      void parseCache();
+      void parseCacheInvalidate();
+      void renderListCache();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestChordSymbol::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   parseCache
+//    cached result must match a fresh parse
+//---------------------------------------------------------
+
+void TestChordSymbol::parseCache()
+      {
+      ChordList cl;
+      QStringList names;
+      names << "maj7" << "7(b9)" << "m7b5" << "sus4" << "7" << "maj7";
+      foreach (const QString& s, names) {
+            ParsedChord pc;
+            pc.parse(s, &cl);
+            const ParsedChord& cached = cl.parse(s);
+            QVERIFY(cached == pc);
+            QCOMPARE(cached.name(), pc.name());
+            QCOMPARE(cached.xmlKind(), pc.xmlKind());
+            QCOMPARE(cached.xmlDegrees(), pc.xmlDegrees());
+            }
+      QCOMPARE(cl.parseMisses(), 5);
+      QCOMPARE(cl.parseHits(), 1);
+
+      // parse options are part of the key
+      cl.parse("m7", false, false);
+      cl.parse("m7", true, false);
+      cl.parse("m7", false, true);
+      cl.parse("m7", false, true);
+      QCOMPARE(cl.parseMisses(), 8);
+      QCOMPARE(cl.parseHits(), 2);
+      QCOMPARE(cl.parseCacheSize(), 8);
+      }
+
+//---------------------------------------------------------
+//   parseCacheInvalidate
+//---------------------------------------------------------
+
+void TestChordSymbol::parseCacheInvalidate()
+      {
+      ChordList cl;
+      cl.parse("7");
+      cl.parse("7");
+      QCOMPARE(cl.parseCacheSize(), 1);
+      cl.unload();
+      QCOMPARE(cl.parseCacheSize(), 0);
+      QCOMPARE(cl.parseHits(), 0);
+      cl.parse("7");
+      QCOMPARE(cl.parseMisses(), 1);
+      }
+
+//---------------------------------------------------------
+//   renderListCache
+//    the render list is made once per chord list
+//    generation
+//---------------------------------------------------------
+
+void TestChordSymbol::renderListCache()
+      {
+      ChordList cl;
+      ParsedChord pc;
+      pc.parse("maj7", &cl);
+      QList<RenderAction> rl = pc.renderList(&cl);
+      QVERIFY(!rl.isEmpty());
+      QVERIFY(pc.renderList(&cl).isSharedWith(rl));
+
+      // another chord list renders again
+      ChordList cl2;
+      QVERIFY(!pc.renderList(&cl2).isSharedWith(rl));
+
+      // and so does the same list after unload()
+      rl = pc.renderList(&cl);
+      QVERIFY(pc.renderList(&cl).isSharedWith(rl));
+      cl.unload();
+      QVERIFY(!pc.renderList(&cl).isSharedWith(rl));
+
+      // as well as a new parse
+      rl = pc.renderList(&cl);
+      pc.parse("7", &cl);
+      QVERIFY(!pc.renderList(&cl).isSharedWith(rl));
+      }
+
+QTEST_MAIN(TestChordSymbol)
+#include "tst_chordsymbol.moc"
+
@@ -0,0 +1,199 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "libmscore/cursor.h"
+#include "libmscore/measure.h"
+#include "libmscore/mcursor.h"
+#include "libmscore/durationtype.h"
+#include "libmscore/undo.h"
+
+using namespace Ms;
+
+static const int staff0Pitches[] = { 60, 62, 64, 65 };
+static const int staff1Pitches[] = { 48, 50, 52, 53 };
+
+//---------------------------------------------------------
+//   TestCursor
+//    note table access of the plugin cursor
+//---------------------------------------------------------
+
+class TestCursor : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      Score* createScore();
+      QList<int> pitches(Score*);
+
+   private slots:
+      void initTestCase();
+      void noteTable();
+      void noteTableRange();
+      void setPitches();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestCursor::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   createScore
+//    two staves, two measures of half notes; chord rest
+//    segments start at ticks 0, 960, 1920 and 2880
+//---------------------------------------------------------
+
+Score* TestCursor::createScore()
+      {
+      MCursor c;
+      c.setTimeSig(Fraction(4,4));
+      c.createScore("cursor");
+      c.addPart("violin");
+      c.addPart("violoncello");
+      c.move(0, 0);
+      c.addKeySig(0);
+      c.addTimeSig(Fraction(4,4));
+      for (int i = 0; i < 4; ++i)
+            c.addChord(staff0Pitches[i], TDuration(TDuration::V_HALF));
+      c.move(VOICES, 0);
+      for (int i = 0; i < 4; ++i)
+            c.addChord(staff1Pitches[i], TDuration(TDuration::V_HALF));
+      Score* score = c.score();
+      score->doLayout();
+      return score;
+      }
+
+//---------------------------------------------------------
+//   pitches
+//    pitches of the whole score in note table order
+//---------------------------------------------------------
+
+QList<int> TestCursor::pitches(Score* score)
+      {
+      NoteTable table;
+      Measure* lm = score->lastMeasure();
+      table.collect(score, 0, lm->endTick(), 0, score->nstaves());
+      return table.pitch.toList();
+      }
+
+//---------------------------------------------------------
+//   noteTable
+//---------------------------------------------------------
+
+void TestCursor::noteTable()
+      {
+      Score* score = createScore();
+      Cursor cursor(score);
+      QVariantMap table = cursor.noteTable();
+
+      QVariantList tick  = table["tick"].toList();
+      QVariantList track = table["track"].toList();
+      QVariantList pitch = table["pitch"].toList();
+      QCOMPARE(tick.size(), 8);
+      QCOMPARE(track.size(), 8);
+      for (int i = 0; i < 4; ++i) {
+            QCOMPARE(tick[i * 2].toInt(), i * 960);
+            QCOMPARE(track[i * 2].toInt(), 0);
+            QCOMPARE(pitch[i * 2].toInt(), staff0Pitches[i]);
+            QCOMPARE(tick[i * 2 + 1].toInt(), i * 960);
+            QCOMPARE(track[i * 2 + 1].toInt(), VOICES);
+            QCOMPARE(pitch[i * 2 + 1].toInt(), staff1Pitches[i]);
+            QCOMPARE(table["duration"].toList()[i * 2].toInt(), 960);
+            }
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   noteTableRange
+//    the range may start and end between segments
+//---------------------------------------------------------
+
+void TestCursor::noteTableRange()
+      {
+      Score* score = createScore();
+      Cursor cursor(score);
+
+      // no segment starts at tick 480
+      QVariantMap table = cursor.noteTableRange(480, 2880, 0, 2);
+      QVariantList tick = table["tick"].toList();
+      QCOMPARE(tick.size(), 4);
+      QCOMPARE(tick[0].toInt(), 960);
+      QCOMPARE(tick[3].toInt(), 1920);
+
+      // start in the second measure, second staff only
+      table = cursor.noteTableRange(2000, 4000, 1, 2);
+      tick = table["tick"].toList();
+      QCOMPARE(tick.size(), 1);
+      QCOMPARE(tick[0].toInt(), 2880);
+      QCOMPARE(table["track"].toList()[0].toInt(), VOICES);
+      QCOMPARE(table["pitch"].toList()[0].toInt(), staff1Pitches[3]);
+
+      // empty range between two segments
+      table = cursor.noteTableRange(100, 900, 0, 2);
+      QVERIFY(table["tick"].toList().isEmpty());
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   setPitches
+//    all changes are a single undo step
+//---------------------------------------------------------
+
+void TestCursor::setPitches()
+      {
+      Score* score = createScore();
+      Cursor cursor(score);
+      QList<int> orig = pitches(score);
+
+      QVariantMap table = cursor.noteTable();
+      QVariantList newPitch;
+      foreach (const QVariant& p, table["pitch"].toList())
+            newPitch.append(p.toInt() + 2);
+      table["newPitch"] = newPitch;
+      QCOMPARE(cursor.setPitches(table), 8);
+      QVERIFY(!score->undo()->active());
+
+      QList<int> changed = pitches(score);
+      QCOMPARE(changed.size(), orig.size());
+      for (int i = 0; i < orig.size(); ++i)
+            QCOMPARE(changed[i], orig[i] + 2);
+
+      score->undo()->undo();
+      score->endUndoRedo();
+      QCOMPARE(pitches(score), orig);
+
+      score->undo()->redo();
+      score->endUndoRedo();
+      QCOMPARE(pitches(score), changed);
+
+      // rows which do not match a note are skipped: the
+      // pitch at tick 960 is no longer the original one
+      table = cursor.noteTableRange(960, 961, 0, 1);
+      QVariantList row;
+      row.append(staff0Pitches[1]);
+      table["pitch"]    = row;
+      table["newPitch"] = row;
+      QCOMPARE(cursor.setPitches(table), 0);
+      QCOMPARE(pitches(score), changed);
+      delete score;
+      }
+
+QTEST_MAIN(TestCursor)
+#include "tst_cursor.moc"
+
@@ -14,6 +14,8 @@
 #include <QtTest/QtTest>
 #include "mtest/testutils.h"
 #include "libmscore/score.h"
+#include "libmscore/page.h"
+#include "libmscore/symbatch.h"
 
 #define DIR QString("libmscore/layout/")
 
@@ -39,6 +41,10 @@ class TestBenchmark : public QObject, public MTest
       void benchmark3();
       void benchmark1();
       void benchmark2();
+      void styleLookups();
+      void paint();
+      void paintBatched();
+      void paintBatchedImage();
       };
 
 //---------------------------------------------------------
@@ -82,6 +88,128 @@ void TestBenchmark::benchmark2()
             }
       }
 
+//---------------------------------------------------------
+//   styleLookups
+//---------------------------------------------------------
+
+void TestBenchmark::styleLookups()
+      {
+      MScore::debugMode = true;
+      score->doLayout();
+      int n = MStyle::lookups();
+      MScore::debugMode = false;
+      QVERIFY(n > 0);
+      qDebug("%d style lookups per layout", n);
+
+      const LayoutStyle& ls = score->layoutStyle();
+      QCOMPARE(ls.minNoteDistance, score->styleP(ST_minNoteDistance));
+      QCOMPARE(ls.measureSpacing, score->styleD(ST_measureSpacing));
+      }
+
+//---------------------------------------------------------
+//   paintPage
+//    paint like Score::print(): sorted by z, the batch
+//    is flushed when z changes
+//---------------------------------------------------------
+
+static void paintPage(QPainter& p, Page* page, SymBatch* batch = 0)
+      {
+      foreach (const Element* e, page->displayList()) {
+            if (!e->visible())
+                  continue;
+            if (batch)
+                  batch->setZ(e->z());
+            QPointF pos(e->pagePos());
+            p.translate(pos);
+            e->draw(&p);
+            p.translate(-pos);
+            }
+      }
+
+//---------------------------------------------------------
+//   paint
+//    paint the first page, one draw call per symbol
+//---------------------------------------------------------
+
+void TestBenchmark::paint()
+      {
+      Page* page = score->pages().front();
+      QImage image(page->bbox().size().toSize(), QImage::Format_ARGB32_Premultiplied);
+      QPainter p(&image);
+      QBENCHMARK {
+            paintPage(p, page);
+            }
+      }
+
+//---------------------------------------------------------
+//   paintBatched
+//---------------------------------------------------------
+
+void TestBenchmark::paintBatched()
+      {
+      Page* page = score->pages().front();
+      QImage image(page->bbox().size().toSize(), QImage::Format_ARGB32_Premultiplied);
+      QPainter p(&image);
+      int symbols   = 0;
+      int drawCalls = 0;
+      QBENCHMARK {
+            SymBatch batch(&p);
+            paintPage(p, page, &batch);
+            batch.flush();
+            symbols   = batch.symbols();
+            drawCalls = batch.drawCalls();
+            }
+      QVERIFY(symbols > 0);
+      QVERIFY(drawCalls < symbols);
+      }
+
+//---------------------------------------------------------
+//   paintBatchedImage
+//    the batched page must look like the page painted
+//    symbol by symbol. Glyph runs and drawText() may
+//    round anti-aliased edges differently, so only
+//    pixels which differ clearly are counted.
+//---------------------------------------------------------
+
+void TestBenchmark::paintBatchedImage()
+      {
+      Page* page = score->pages().front();
+      QSize size(page->bbox().size().toSize());
+      QImage direct(size, QImage::Format_ARGB32_Premultiplied);
+      QImage batched(size, QImage::Format_ARGB32_Premultiplied);
+      direct.fill(Qt::white);
+      batched.fill(Qt::white);
+      {
+      QPainter p(&direct);
+      paintPage(p, page);
+      }
+      int symbols = 0;
+      {
+      QPainter p(&batched);
+      SymBatch batch(&p);
+      paintPage(p, page, &batch);
+      batch.flush();
+      symbols = batch.symbols();
+      }
+      QVERIFY(symbols > 0);
+
+      int ink  = 0;
+      int diff = 0;
+      for (int y = 0; y < size.height(); ++y) {
+            const QRgb* a = reinterpret_cast<const QRgb*>(direct.constScanLine(y));
+            const QRgb* b = reinterpret_cast<const QRgb*>(batched.constScanLine(y));
+            for (int x = 0; x < size.width(); ++x) {
+                  if (a[x] != b[x] && qAbs(qGray(a[x]) - qGray(b[x])) > 64)
+                        ++diff;
+                  if (qGray(a[x]) < 128)
+                        ++ink;
+                  }
+            }
+      qDebug("%d symbols, %d of %d ink pixels differ", symbols, diff, ink);
+      QVERIFY(ink > 0);
+      QVERIFY(diff * 100 <= ink);
+      }
+
 QTEST_MAIN(TestBenchmark)
 #include "tst_benchmark.moc"
 
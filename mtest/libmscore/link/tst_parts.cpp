@@ -90,6 +90,7 @@ class TestParts : public QObject, public MTest
 
       void appendMeasure();
       void insertMeasure();
+      void deferredLayout();
       };
 
 //---------------------------------------------------------
@@ -779,6 +780,69 @@ void TestParts::undoRedoRemoveImage()
       }
 #endif
 
+//---------------------------------------------------------
+//   deferredLayout
+//    a part score without a view is laid out on demand;
+//    undo and redo must give the same result as with
+//    an eager layout
+//---------------------------------------------------------
+
+void TestParts::deferredLayout()
+      {
+      Score* score = readScore(DIR + "part2.mscx");
+      score->doLayout();
+      QVERIFY(score);
+      createParts(score);
+      Score* part = score->excerpts().front()->score();
+      part->doLayout();
+
+      score->startCmd();
+      score->insertMeasure(Element::MEASURE, 0);
+      score->endCmd();
+
+      QVERIFY(part->layoutDeferred());
+      QVERIFY(!score->layoutDeferred());
+      QCOMPARE(part->lastMeasure()->endTick(), score->lastMeasure()->endTick());
+
+      // undo/redo lays out the part score at once
+      score->undo()->undo();
+      score->endUndoRedo();
+      QVERIFY(!part->layoutDeferred());
+      QVERIFY(saveCompareScore(score, "part2-7.mscx", DIR + "part2-4o.mscx"));
+
+      score->undo()->redo();
+      score->endUndoRedo();
+      QVERIFY(!part->layoutDeferred());
+      QVERIFY(saveCompareScore(score, "part2-8.mscx", DIR + "part2-3o.mscx"));
+
+      // catch up on the deferred layout, then undo and redo
+      score->undo()->undo();
+      score->endUndoRedo();
+      score->startCmd();
+      score->insertMeasure(Element::MEASURE, 0);
+      score->endCmd();
+      QVERIFY(part->layoutDeferred());
+
+      // the layout is part of the last command and does
+      // not change the clean state
+      score->undo()->setClean();
+      part->ensureLayout();
+      QVERIFY(!part->layoutDeferred());
+      QVERIFY(!score->undo()->active());
+      QVERIFY(score->undo()->isClean());
+      QVERIFY(saveCompareScore(score, "part2-9.mscx", DIR + "part2-3o.mscx"));
+
+      score->undo()->undo();
+      score->endUndoRedo();
+      QVERIFY(!score->undo()->canUndo());
+      QVERIFY(saveCompareScore(score, "part2-10.mscx", DIR + "part2-4o.mscx"));
+
+      score->undo()->redo();
+      score->endUndoRedo();
+      QVERIFY(saveCompareScore(score, "part2-11.mscx", DIR + "part2-3o.mscx"));
+      delete score;
+      }
+
 QTEST_MAIN(TestParts)
 
 #include "tst_parts.moc"
@@ -0,0 +1,341 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "libmscore/measure.h"
+#include "libmscore/segment.h"
+#include "libmscore/chord.h"
+#include "libmscore/note.h"
+#include "libmscore/stem.h"
+#include "libmscore/ledgerline.h"
+#include "libmscore/mcursor.h"
+#include "libmscore/durationtype.h"
+#include "libmscore/pitchspelling.h"
+#include "libmscore/key.h"
+#include "libmscore/clef.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestMeasureLayout
+//    relayout with cached min widths and parallel layout
+//    stage 1 must give the same result as a fresh layout
+//---------------------------------------------------------
+
+class TestMeasureLayout : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      Score* createScore(int staves, int measures, int shiftMeasure = -1, int shift = 0);
+      Chord* chord(Score*, int measure, int idx);
+      void shiftMeasure(Score*, int measure, int shift);
+      bool compareLayout(Score*, Score*);
+
+   private slots:
+      void initTestCase();
+      void relayout();
+      void cachedMinWidth();
+      void crossBarlineBeam();
+      void inPlaceChanges();
+      void parallelStage1();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestMeasureLayout::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   createScore
+//    eighth notes below the middle line; the beam of the
+//    last beat of measure 10 continues into measure 11.
+//    Notes of staff 0 in shiftMeasure are transposed by
+//    shift semitones.
+//---------------------------------------------------------
+
+Score* TestMeasureLayout::createScore(int staves, int measures, int shiftMeasure, int shift)
+      {
+      MCursor c;
+      c.setTimeSig(Fraction(4,4));
+      c.createScore("measurelayout");
+      for (int staff = 0; staff < staves; ++staff)
+            c.addPart("violin");
+      c.move(0, 0);
+      c.addKeySig(0);
+      c.addTimeSig(Fraction(4,4));
+      for (int staff = 0; staff < staves; ++staff) {
+            c.move(staff * VOICES, 0);
+            for (int m = 0; m < measures; ++m) {
+                  for (int i = 0; i < 8; ++i) {
+                        int pitch = 60 + (i * 2 + m + staff) % 8;
+                        if (staff == 0 && m == shiftMeasure)
+                              pitch += shift;
+                        Chord* chord = c.addChord(pitch, TDuration(TDuration::V_EIGHT));
+                        if (m == 11 && i == 0)
+                              chord->setBeamMode(BeamMode::MID);
+                        }
+                  }
+            }
+      Score* score = c.score();
+      score->rebuildMidiMapping();
+      score->doLayout();
+      return score;
+      }
+
+//---------------------------------------------------------
+//   chord
+//    chord idx of staff 0 in measure
+//---------------------------------------------------------
+
+Chord* TestMeasureLayout::chord(Score* score, int measure, int idx)
+      {
+      Measure* m = score->firstMeasure();
+      for (int i = 0; i < measure; ++i)
+            m = m->nextMeasure();
+      Segment* s = m->first(Segment::SegChordRest);
+      for (int i = 0; i < idx; ++i)
+            s = s->next(Segment::SegChordRest);
+      return static_cast<Chord*>(s->element(0));
+      }
+
+//---------------------------------------------------------
+//   shiftMeasure
+//    transpose staff 0 of measure as one command
+//---------------------------------------------------------
+
+void TestMeasureLayout::shiftMeasure(Score* score, int measure, int shift)
+      {
+      score->startCmd();
+      for (int i = 0; i < 8; ++i) {
+            foreach (Note* n, chord(score, measure, i)->notes()) {
+                  int pitch = n->pitch() + shift;
+                  n->undoChangeProperty(P_PITCH, pitch);
+                  n->undoChangeProperty(P_TPC, pitch2tpc(pitch, KEY_C, PREFER_NEAREST));
+                  }
+            }
+      score->endCmd();
+      score->doLayout();
+      }
+
+//---------------------------------------------------------
+//   compareLayout
+//    compare measure, chord rest, stem and ledger line
+//    positions of two scores with the same content
+//---------------------------------------------------------
+
+static bool same(const QPointF& a, const QPointF& b)
+      {
+      return qAbs(a.x() - b.x()) < 0.001 && qAbs(a.y() - b.y()) < 0.001;
+      }
+
+static bool same(const QRectF& a, const QRectF& b)
+      {
+      return same(a.topLeft(), b.topLeft()) && same(a.bottomRight(), b.bottomRight());
+      }
+
+static int ledgerLines(Chord* c)
+      {
+      int n = 0;
+      for (LedgerLine* l = c->ledgerLines(); l; l = l->next())
+            ++n;
+      return n;
+      }
+
+bool TestMeasureLayout::compareLayout(Score* s1, Score* s2)
+      {
+      int tracks = s1->nstaves() * VOICES;
+      Measure* m1 = s1->firstMeasure();
+      Measure* m2 = s2->firstMeasure();
+      for (; m1 && m2; m1 = m1->nextMeasure(), m2 = m2->nextMeasure()) {
+            if (!same(m1->pagePos(), m2->pagePos()) || qAbs(m1->width() - m2->width()) > 0.001) {
+                  qDebug("measure %d: position or width differs", m1->no());
+                  return false;
+                  }
+            Segment* a = m1->first(Segment::SegChordRest);
+            Segment* b = m2->first(Segment::SegChordRest);
+            for (; a && b; a = a->next(Segment::SegChordRest), b = b->next(Segment::SegChordRest)) {
+                  for (int track = 0; track < tracks; ++track) {
+                        ChordRest* cr1 = static_cast<ChordRest*>(a->element(track));
+                        ChordRest* cr2 = static_cast<ChordRest*>(b->element(track));
+                        if (!cr1 && !cr2)
+                              continue;
+                        if (!cr1 || !cr2 || !same(cr1->pagePos(), cr2->pagePos()) || cr1->up() != cr2->up()) {
+                              qDebug("measure %d tick %d track %d: chord rest differs", m1->no(), a->tick(), track);
+                              return false;
+                              }
+                        if (cr1->type() != Element::CHORD)
+                              continue;
+                        Chord* c1 = static_cast<Chord*>(cr1);
+                        Chord* c2 = static_cast<Chord*>(cr2);
+                        Stem* st1 = c1->stem();
+                        Stem* st2 = c2->stem();
+                        if ((st1 == 0) != (st2 == 0)
+                           || (st1 && (!same(st1->pagePos(), st2->pagePos()) || !same(st1->bbox(), st2->bbox())))
+                           || ledgerLines(c1) != ledgerLines(c2)) {
+                              qDebug("measure %d tick %d track %d: stem or ledger lines differ", m1->no(), a->tick(), track);
+                              return false;
+                              }
+                        }
+                  }
+            if (a || b)
+                  return false;
+            }
+      return m1 == 0 && m2 == 0;
+      }
+
+//---------------------------------------------------------
+//   relayout
+//    a relayout without changes keeps the layout
+//---------------------------------------------------------
+
+void TestMeasureLayout::relayout()
+      {
+      Score* score = createScore(2, 8);
+      score->doLayout();
+      Score* fresh = createScore(2, 8);
+      QVERIFY(compareLayout(score, fresh));
+      delete score;
+      delete fresh;
+      }
+
+//---------------------------------------------------------
+//   cachedMinWidth
+//    edit one measure, relayout and compare with a
+//    fresh layout of the edited content
+//---------------------------------------------------------
+
+void TestMeasureLayout::cachedMinWidth()
+      {
+      Score* score = createScore(2, 8);
+      shiftMeasure(score, 3, 14);
+
+      Score* fresh = createScore(2, 8, 3, 14);
+      QVERIFY(compareLayout(score, fresh));
+
+      // and back: the cached widths must follow
+      shiftMeasure(score, 3, -14);
+      Score* orig = createScore(2, 8);
+      QVERIFY(compareLayout(score, orig));
+
+      delete score;
+      delete fresh;
+      delete orig;
+      }
+
+//---------------------------------------------------------
+//   crossBarlineBeam
+//    moving the notes of measure 11 up flips the beam
+//    which starts in measure 10; the stems of the
+//    unchanged measure 10 must follow
+//---------------------------------------------------------
+
+void TestMeasureLayout::crossBarlineBeam()
+      {
+      Score* score = createScore(1, 16);
+      Chord* c = chord(score, 10, 7);
+      QVERIFY(c->beam());
+      QVERIFY(c->beam() == chord(score, 11, 0)->beam());
+      QVERIFY(c->up());
+
+      shiftMeasure(score, 11, 24);
+      QVERIFY(!c->up());
+
+      Score* fresh = createScore(1, 16, 11, 24);
+      QVERIFY(compareLayout(score, fresh));
+      delete score;
+      delete fresh;
+      }
+
+//---------------------------------------------------------
+//   inPlaceChanges
+//    changes which keep the element but change its width:
+//    the naturals of the key signature following a key
+//    change and the type of an existing clef
+//---------------------------------------------------------
+
+static void editKeysAndClef(Score* score, int step)
+      {
+      Staff* staff = score->staff(0);
+      Measure* m   = score->firstMeasure();
+      for (int i = 0; i < 4; ++i)
+            m = m->nextMeasure();
+      Segment* seg = m->first(Segment::SegChordRest);
+      score->startCmd();
+      if (step == 0) {
+            score->undoChangeKeySig(staff, m->tick(), KeySigEvent(4));
+            score->undoChangeKeySig(staff, m->nextMeasure()->nextMeasure()->tick(), KeySigEvent(0));
+            score->undoChangeClef(staff, seg, CLEF_G);
+            }
+      else {
+            score->undoChangeKeySig(staff, m->tick(), KeySigEvent(1));
+            score->undoChangeClef(staff, seg, CLEF_F);
+            }
+      score->endCmd();
+      score->doLayout();
+      }
+
+void TestMeasureLayout::inPlaceChanges()
+      {
+      Score* score = createScore(2, 8);
+      Score* ref   = createScore(2, 8);
+      for (int step = 0; step < 2; ++step) {
+            editKeysAndClef(score, step);
+            editKeysAndClef(ref, step);
+            }
+      // a layout without cached min widths
+      for (Measure* m = ref->firstMeasure(); m; m = m->nextMeasure())
+            m->setDirty();
+      ref->doLayout();
+      QVERIFY(compareLayout(score, ref));
+      delete score;
+      delete ref;
+      }
+
+//---------------------------------------------------------
+//   parallelStage1
+//    layout stage 1 with measures in parallel must give
+//    the same result as the serial stage
+//---------------------------------------------------------
+
+void TestMeasureLayout::parallelStage1()
+      {
+      int n = MScore::parallelLayoutMeasures;
+
+      MScore::parallelLayoutMeasures = INT_MAX;
+      Score* serial = createScore(3, 40);
+      shiftMeasure(serial, 20, 14);
+      shiftMeasure(serial, 11, 24);
+
+      MScore::parallelLayoutMeasures = 32;
+      Score* parallel = createScore(3, 40);
+      Score* fresh    = createScore(3, 40);
+      QVERIFY(compareLayout(parallel, fresh));
+      delete fresh;
+      shiftMeasure(parallel, 20, 14);
+      shiftMeasure(parallel, 11, 24);
+
+      MScore::parallelLayoutMeasures = n;
+      QVERIFY(compareLayout(serial, parallel));
+      delete serial;
+      delete parallel;
+      }
+
+QTEST_MAIN(TestMeasureLayout)
+#include "tst_measurelayout.moc"
+
@@ -0,0 +1,247 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "libmscore/hairpin.h"
+#include "libmscore/slur.h"
+#include "libmscore/chord.h"
+#include "libmscore/measure.h"
+#include "libmscore/mcursor.h"
+#include "libmscore/durationtype.h"
+#include "libmscore/undo.h"
+#include "libmscore/spannermap.h"
+
+using namespace Ms;
+
+static const int SPANNERS = 100000;
+static const int MAXTICK  = SPANNERS * 48;
+
+//---------------------------------------------------------
+//   TestSpannerMap
+//---------------------------------------------------------
+
+class TestSpannerMap : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QList<Spanner*> createSpanners(Score*, int n);
+
+   private slots:
+      void initTestCase();
+      void spannerMap1();
+      void spannerMap2();
+      void insertMeasures();
+      void benchmark1();
+      void benchmark2();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestSpannerMap::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   createSpanners
+//---------------------------------------------------------
+
+QList<Spanner*> TestSpannerMap::createSpanners(Score* score, int n)
+      {
+      QList<Spanner*> sl;
+      qsrand(1);
+      for (int i = 0; i < n; ++i) {
+            Spanner* s = new Hairpin(score);
+            int tick = qrand() % MAXTICK;
+            s->setTick(tick);
+            s->setTick2(tick + qrand() % (MScore::division * 16));
+            sl.append(s);
+            }
+      return sl;
+      }
+
+//---------------------------------------------------------
+//   spannerMap1
+//    compare queries against a linear search
+//---------------------------------------------------------
+
+void TestSpannerMap::spannerMap1()
+      {
+      Score* score = new Score(mscore->baseStyle());
+      QList<Spanner*> sl = createSpanners(score, 1000);
+      foreach (Spanner* s, sl)
+            score->addSpanner(s);
+      QCOMPARE(int(score->spanner().size()), 1000);
+
+      for (int i = 0; i < 100; ++i) {
+            int start = qrand() % MAXTICK;
+            int stop  = start + qrand() % (MScore::division * 32);
+            int overlapping = 0;
+            int contained   = 0;
+            foreach (Spanner* s, sl) {
+                  if (s->tick2() >= start && s->tick() <= stop)
+                        ++overlapping;
+                  if (s->tick() >= start && s->tick2() <= stop)
+                        ++contained;
+                  }
+            QCOMPARE(int(score->spannerMap().findOverlapping(start, stop).size()), overlapping);
+            QCOMPARE(int(score->spannerMap().findContained(start, stop).size()), contained);
+            }
+
+      for (int i = 0; i < sl.size(); i += 2)
+            score->removeSpanner(sl[i]);
+      QCOMPARE(int(score->spanner().size()), 500);
+      QCOMPARE(int(score->spannerMap().findOverlapping(0, MAXTICK * 2).size()), 500);
+      qDeleteAll(sl);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   spannerMap2
+//    changing the tick range of a spanner in the map
+//---------------------------------------------------------
+
+void TestSpannerMap::spannerMap2()
+      {
+      Score* score = new Score(mscore->baseStyle());
+      Spanner* s = new Hairpin(score);
+      s->setTick(480);
+      s->setTick2(960);
+      score->addSpanner(s);
+
+      QCOMPARE(int(score->spannerMap().findOverlapping(2000, 3000).size()), 0);
+      s->setTick2(2400);
+      QCOMPARE(int(score->spannerMap().findOverlapping(2000, 3000).size()), 1);
+      s->setTick(1920);
+      QCOMPARE(score->spanner().begin()->first, 1920);
+      QCOMPARE(int(score->spannerMap().findContained(1920, 2400).size()), 1);
+      QCOMPARE(int(score->spannerMap().findOverlapping(0, 1000).size()), 0);
+
+      score->removeSpanner(s);
+      QVERIFY(score->spanner().empty());
+      QCOMPARE(int(score->spannerMap().findOverlapping(0, 3000).size()), 0);
+      delete s;
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   insertMeasures
+//    inserting measures moves the spanners behind the
+//    insert position exactly once
+//---------------------------------------------------------
+
+void TestSpannerMap::insertMeasures()
+      {
+      MCursor c;
+      c.setTimeSig(Fraction(4,4));
+      c.createScore("spannermap");
+      c.addPart("violin");
+      c.move(0, 0);
+      c.addKeySig(0);
+      c.addTimeSig(Fraction(4,4));
+      QList<Chord*> chords;
+      for (int i = 0; i < 8; ++i)
+            chords.append(c.addChord(60 + i, TDuration(TDuration::V_WHOLE)));
+      Score* score = c.score();
+
+      // a slur from measure 3 to 4, hairpins inside measures 2 to 7
+      Slur* slur = new Slur(score);
+      slur->setTrack(0);
+      slur->setStartElement(chords[2]);
+      slur->setEndElement(chords[3]);
+      slur->setTick(chords[2]->tick());
+      slur->setTick2(chords[3]->tick());
+      score->addSpanner(slur);
+      QList<Spanner*> hairpins;
+      for (int i = 1; i < 7; ++i) {
+            Hairpin* h = new Hairpin(score);
+            h->setTrack(0);
+            h->setAnchor(Spanner::ANCHOR_SEGMENT);
+            h->setTick(i * 1920 + 480);
+            h->setTick2(i * 1920 + 1440);
+            score->addSpanner(h);
+            hairpins.append(h);
+            }
+      score->doLayout();
+
+      // insert two measures before measure 2
+      score->startCmd();
+      score->insertMeasure(Element::MEASURE, score->firstMeasure()->nextMeasure());
+      score->insertMeasure(Element::MEASURE, score->firstMeasure()->nextMeasure());
+      score->endCmd();
+      QCOMPARE(slur->tick(), 4 * 1920);
+      QCOMPARE(slur->tick2(), 5 * 1920);
+      for (int i = 0; i < hairpins.size(); ++i) {
+            QCOMPARE(hairpins[i]->tick(), (i + 3) * 1920 + 480);
+            QCOMPARE(hairpins[i]->tick2(), (i + 3) * 1920 + 1440);
+            }
+      QCOMPARE(int(score->spannerMap().findOverlapping(1920, 3 * 1920 - 1).size()), 0);
+      QCOMPARE(int(score->spannerMap().findContained(4 * 1920, 5 * 1920).size()), 2);
+
+      score->undo()->undo();
+      score->endUndoRedo();
+      QCOMPARE(slur->tick(), 2 * 1920);
+      QCOMPARE(slur->tick2(), 3 * 1920);
+      for (int i = 0; i < hairpins.size(); ++i) {
+            QCOMPARE(hairpins[i]->tick(), (i + 1) * 1920 + 480);
+            QCOMPARE(hairpins[i]->tick2(), (i + 1) * 1920 + 1440);
+            }
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   benchmark1
+//    insert and remove 100k spanners
+//---------------------------------------------------------
+
+void TestSpannerMap::benchmark1()
+      {
+      Score* score = new Score(mscore->baseStyle());
+      QList<Spanner*> sl = createSpanners(score, SPANNERS);
+      QBENCHMARK {
+            foreach (Spanner* s, sl)
+                  score->addSpanner(s);
+            foreach (Spanner* s, sl)
+                  score->removeSpanner(s);
+            }
+      qDeleteAll(sl);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   benchmark2
+//    query 100k spanners while adding them
+//---------------------------------------------------------
+
+void TestSpannerMap::benchmark2()
+      {
+      Score* score = new Score(mscore->baseStyle());
+      QList<Spanner*> sl = createSpanners(score, SPANNERS);
+      QBENCHMARK {
+            foreach (Spanner* s, sl) {
+                  score->addSpanner(s);
+                  score->spannerMap().findOverlapping(s->tick(), s->tick2());
+                  }
+            foreach (Spanner* s, sl)
+                  score->removeSpanner(s);
+            }
+      qDeleteAll(sl);
+      delete score;
+      }
+
+QTEST_MAIN(TestSpannerMap)
+#include "tst_spannermap.moc"
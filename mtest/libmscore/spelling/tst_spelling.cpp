@@ -0,0 +1,266 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/pitchspelling.h"
+#include "libmscore/score.h"
+#include "libmscore/segment.h"
+#include "libmscore/chord.h"
+#include "libmscore/note.h"
+#include "libmscore/undo.h"
+#include "synthesizer/event.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestSpelling
+//    spellNotes() must spell like the brute force sliding
+//    window speller it replaces
+//---------------------------------------------------------
+
+class TestSpelling : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QVector<int> windowed(const QVector<int>& pitch, int key);
+      QList<int> windowed(const QList<Note*>& notes);
+      QList<Note*> staffNotes(Score*, int staffIdx);
+
+   private slots:
+      void initTestCase();
+      void diatonic();
+      void chromatic();
+      void randomSequences();
+      void scores_data();
+      void scores();
+      void benchmark();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestSpelling::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   windowed
+//    spell pitches with the old sliding window speller;
+//    it does not reach notes 3 and 4 of a sequence of
+//    four or five notes, they are INVALID_TPC
+//---------------------------------------------------------
+
+QVector<int> TestSpelling::windowed(const QVector<int>& pitch, int key)
+      {
+      QList<Event> el;
+      foreach (int p, pitch) {
+            Event e(ME_NOTE);
+            e.setDataA(p);
+            e.setTpc(INVALID_TPC);
+            el.append(e);
+            }
+      spell(el, key);
+      QVector<int> tpcs;
+      foreach (const Event& e, el)
+            tpcs.append(e.tpc());
+      return tpcs;
+      }
+
+//---------------------------------------------------------
+//   diatonic
+//    a C major scale is spelled with naturals only
+//---------------------------------------------------------
+
+void TestSpelling::diatonic()
+      {
+      static const int scale[] = { 60, 62, 64, 65, 67, 69, 71, 72, 71, 69, 67, 65, 64, 62, 60 };
+      static const int tpcs[]  = { 14, 16, 18, 13, 15, 17, 19, 14, 19, 17, 15, 13, 18, 16, 14 };
+      QVector<int> pitch;
+      for (int p : scale)
+            pitch.append(p);
+      QVector<int> key(pitch.size(), 7);
+      QVector<int> dp = spellNotes(pitch, key);
+      for (int i = 0; i < pitch.size(); ++i)
+            QCOMPARE(dp[i], tpcs[i]);
+      QCOMPARE(dp, windowed(pitch, 0));
+      }
+
+//---------------------------------------------------------
+//   windowed
+//    spell the notes of a staff like the old
+//    Score::spellNotelist() did
+//---------------------------------------------------------
+
+QList<int> TestSpelling::windowed(const QList<Note*>& notes)
+      {
+      int n = notes.size();
+      QList<int> tpcs;
+      for (int i = 0; i < n; ++i)
+            tpcs.append(INVALID_TPC);
+      int start = 0;
+      while (start < n) {
+            int end = qMin(start + 9, n);
+            int opt = computeWindow(notes, start, end);
+            if (start == 0) {
+                  for (int i = 0; i < 3 && i < n; ++i)
+                        tpcs[i] = tpc(i, notes[i]->pitch(), opt);
+                  }
+            if (end - start >= 6) {
+                  for (int i = 3; i < 6; ++i)
+                        tpcs[start + i] = tpc(i, notes[start + i]->pitch(), opt);
+                  }
+            if (end == n) {
+                  for (int i = 6; i < end - start; ++i)
+                        tpcs[start + i] = tpc(i, notes[start + i]->pitch(), opt);
+                  break;
+                  }
+            start += 3;
+            }
+      return tpcs;
+      }
+
+//---------------------------------------------------------
+//   staffNotes
+//    the notes of a staff in the order of Score::spell()
+//---------------------------------------------------------
+
+QList<Note*> TestSpelling::staffNotes(Score* score, int staffIdx)
+      {
+      QList<Note*> notes;
+      int strack = staffIdx * VOICES;
+      for (Segment* s = score->firstSegment(); s; s = s->next1()) {
+            for (int track = strack; track < strack + VOICES; ++track) {
+                  Element* e = s->element(track);
+                  if (e && e->type() == Element::CHORD)
+                        notes.append(static_cast<Chord*>(e)->notes());
+                  }
+            }
+      return notes;
+      }
+
+//---------------------------------------------------------
+//   chromatic
+//    a chromatic passage in every key
+//---------------------------------------------------------
+
+void TestSpelling::chromatic()
+      {
+      QVector<int> pitch;
+      for (int p = 60; p <= 72; ++p)
+            pitch.append(p);
+      for (int p = 71; p >= 60; --p)
+            pitch.append(p);
+      for (int k = -7; k <= 7; ++k) {
+            QVector<int> key(pitch.size(), k + 7);
+            QVector<int> dp = spellNotes(pitch, key);
+            for (int i = 0; i < pitch.size(); ++i)
+                  QCOMPARE((tpc2pitch(dp[i]) + 12) % 12, pitch[i] % 12);
+            QCOMPARE(dp, windowed(pitch, k));
+            }
+      }
+
+//---------------------------------------------------------
+//   randomSequences
+//    all lengths up to a few windows, every key
+//---------------------------------------------------------
+
+void TestSpelling::randomSequences()
+      {
+      qsrand(1);
+      for (int n = 1; n < 200; ++n) {
+            QVector<int> pitch;
+            for (int i = 0; i < n; ++i)
+                  pitch.append(48 + qrand() % 36);
+            int k = n % 15;
+            QVector<int> key(n, k);
+            QVector<int> dp = spellNotes(pitch, key);
+            QVector<int> w  = windowed(pitch, k - 7);
+            for (int i = 0; i < n; ++i) {
+                  if (w[i] != INVALID_TPC)
+                        QCOMPARE(dp[i], w[i]);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   scores
+//    respell scores with accidentals and key changes;
+//    the result must be the one of the old speller and
+//    a single undo step
+//---------------------------------------------------------
+
+void TestSpelling::scores_data()
+      {
+      QTest::addColumn<QString>("path");
+
+      QTest::newRow("measure-2")   << "libmscore/measure/measure-2.mscx";
+      QTest::newRow("keysig02")    << "libmscore/keysig/keysig02-ref.mscx";
+      QTest::newRow("capella7")    << "capella/io/test7.cap-ref.mscx";
+      QTest::newRow("accidentals") << "libmscore/compat/accidentals-ref.mscx";
+      }
+
+void TestSpelling::scores()
+      {
+      QFETCH(QString, path);
+      Score* score = readScore(path);
+      QVERIFY(score);
+
+      QList<Note*> notes;
+      QList<int> orig;
+      QList<int> ref;
+      for (int staffIdx = 0; staffIdx < score->nstaves(); ++staffIdx) {
+            QList<Note*> nl = staffNotes(score, staffIdx);
+            notes.append(nl);
+            ref.append(windowed(nl));
+            }
+      foreach (Note* note, notes)
+            orig.append(note->tpc());
+      QVERIFY(!notes.isEmpty());
+
+      score->startCmd();
+      score->spell();
+      score->endCmd();
+      for (int i = 0; i < notes.size(); ++i) {
+            if (ref[i] != INVALID_TPC)
+                  QCOMPARE(notes[i]->tpc(), ref[i]);
+            }
+
+      score->undo()->undo();
+      score->endUndoRedo();
+      for (int i = 0; i < notes.size(); ++i)
+            QCOMPARE(notes[i]->tpc(), orig[i]);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   benchmark
+//    spell 100k notes
+//---------------------------------------------------------
+
+void TestSpelling::benchmark()
+      {
+      qsrand(1);
+      QVector<int> pitch;
+      for (int i = 0; i < 100000; ++i)
+            pitch.append(48 + qrand() % 36);
+      QVector<int> key(pitch.size(), 7);
+      QBENCHMARK {
+            spellNotes(pitch, key);
+            }
+      }
+
+QTEST_MAIN(TestSpelling)
+#include "tst_spelling.moc"
@@ -0,0 +1,128 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "libmscore/score.h"
+#include "libmscore/text.h"
+#include "libmscore/box.h"
+#include "mtest/testutils.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestText
+//    unstyled text is laid out from styled runs; the
+//    result has to match the layout of a QTextDocument
+//    with the same content
+//---------------------------------------------------------
+
+class TestText : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      void compareLayout(const QString& html, qreal width);
+
+   private slots:
+      void initTestCase() { initMTest(); }
+      void layoutWrapped();
+      void layoutAligned();
+      void layoutScripts();
+      };
+
+//---------------------------------------------------------
+//   compareLayout
+//    lay out html in a frame of the given width (no
+//    frame and no wrapping if width <= 0) and compare
+//    size and baseline with a QTextDocument
+//---------------------------------------------------------
+
+void TestText::compareLayout(const QString& html, qreal width)
+      {
+      VBox* box = new VBox(score);
+      box->bbox().setRect(0.0, 0.0, width, 100.0);
+      Text* text = new Text(score);
+      if (width > 0.0) {
+            text->setParent(box);
+            text->setLayoutToParentWidth(true);
+            }
+      text->setHtml(html);
+      text->layout();
+
+      QTextDocument doc;
+      doc.setDocumentMargin(0);
+      doc.setUseDesignMetrics(true);
+      doc.setDefaultFont(text->textStyle().font(text->spatium()));
+      QTextOption to = doc.defaultTextOption();
+      to.setUseDesignMetrics(true);
+      to.setWrapMode(width > 0.0 ? QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap);
+      doc.setDefaultTextOption(to);
+      doc.setHtml(text->getHtml());
+      qreal w = width - (box->leftMargin() + box->rightMargin()) * MScore::DPMM;
+      doc.setTextWidth(width > 0.0 ? w : doc.idealWidth());
+
+      QSizeF size = doc.size();
+      QTextLine l = doc.begin().layout()->lineAt(0);
+      qreal baseLine = l.ascent() + l.leading();
+
+      QVERIFY(qAbs(text->width() - size.width()) < 0.01);
+      QVERIFY(qAbs(text->height() - size.height()) < 0.01);
+      QVERIFY(qAbs(text->baseLine() - baseLine) < 0.01);
+
+      delete text;
+      delete box;
+      }
+
+//---------------------------------------------------------
+//   layoutWrapped
+//    words too long for a line are broken anywhere
+//---------------------------------------------------------
+
+void TestText::layoutWrapped()
+      {
+      QString html("<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit</p>"
+         "<p>Pneumonoultramicroscopicsilicovolcanoconiosis</p>");
+      compareLayout(html, 0.0);
+      compareLayout(html, 200.0);
+      compareLayout(html, 80.0);
+      }
+
+//---------------------------------------------------------
+//   layoutAligned
+//---------------------------------------------------------
+
+void TestText::layoutAligned()
+      {
+      QString html("<p align=\"center\">centered</p>"
+         "<p align=\"right\">a right aligned line</p>"
+         "<p>left</p>");
+      compareLayout(html, 0.0);
+      compareLayout(html, 100.0);
+      }
+
+//---------------------------------------------------------
+//   layoutScripts
+//    super/subscript runs change the line metrics
+//---------------------------------------------------------
+
+void TestText::layoutScripts()
+      {
+      QString html("<p>x<span style=\"vertical-align:super;\">2</span> + "
+         "H<span style=\"vertical-align:sub;\">2</span>O</p>"
+         "<p><span style=\"vertical-align:sub;\">sub</span> only</p>");
+      compareLayout(html, 0.0);
+      compareLayout(html, 60.0);
+      }
+
+QTEST_MAIN(TestText)
+#include "tst_text.moc"
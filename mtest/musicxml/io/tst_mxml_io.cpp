@@ -70,6 +70,7 @@ private slots:
       void durationRoundingError() { mxmlIoTestRef("testDurationRoundingError"); }
       void dynamics1() { mxmlIoTest("testDynamics1"); }
       void dynamics2() { mxmlIoTest("testDynamics2"); }
+      void dynamics2ReadWriteCompr() { mxmlReadWriteTestCompr("testDynamics2"); }
       void dynamics3() { mxmlIoTestRef("testDynamics3"); }
       void emptyMeasure() { mxmlIoTestRef("testEmptyMeasure"); }
       void emptyVoice1() { mxmlIoTestRef("testEmptyVoice1"); }
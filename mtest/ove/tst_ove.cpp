@@ -0,0 +1,127 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "mscore/ove.h"
+
+#define DIR QString(TESTROOT "/test/testoves/")
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestOve
+//    import the Overture files of test/testoves
+//---------------------------------------------------------
+
+class TestOve : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QStringList files(const QString& dir);
+
+   private slots:
+      void initTestCase();
+      void oveBenchmark_data();
+      void oveBenchmark();
+      void oveParseBenchmark_data() { oveBenchmark_data(); }
+      void oveParseBenchmark();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestOve::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   files
+//---------------------------------------------------------
+
+QStringList TestOve::files(const QString& dir)
+      {
+      QDir d(DIR + dir);
+      QStringList fl;
+      foreach (const QString& name, d.entryList(QStringList("*.ove"), QDir::Files, QDir::Name))
+            fl.append(d.filePath(name));
+      return fl;
+      }
+
+//---------------------------------------------------------
+//   oveBenchmark
+//    import all files of one directory
+//---------------------------------------------------------
+
+void TestOve::oveBenchmark_data()
+      {
+      QTest::addColumn<QString>("dir");
+
+      QTest::newRow("structure") << "structure";
+      QTest::newRow("ove3")      << "ove3";
+      QTest::newRow("bdat")      << "bdat";
+      }
+
+void TestOve::oveBenchmark()
+      {
+      QFETCH(QString, dir);
+      QStringList fl = files(dir);
+      QVERIFY(!fl.isEmpty());
+      QBENCHMARK {
+            foreach (const QString& path, fl) {
+                  Score* score = readCreatedScore(path);
+                  QVERIFY2(score, qPrintable(path));
+                  delete score;
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   oveParseBenchmark
+//    parse the files of one directory from memory; unlike
+//    oveBenchmark this leaves out disk access, conversion
+//    and layout. It only uses the OVE loader interface, so
+//    the test can be built against older revisions to
+//    compare the parser before and after a change.
+//---------------------------------------------------------
+
+void TestOve::oveParseBenchmark()
+      {
+      QFETCH(QString, dir);
+      QStringList fl = files(dir);
+      QVERIFY(!fl.isEmpty());
+      QList<QByteArray> data;
+      foreach (const QString& path, fl) {
+            QFile f(path);
+            QVERIFY2(f.open(QIODevice::ReadOnly), qPrintable(path));
+            data.append(f.readAll());
+            }
+      QBENCHMARK {
+            for (int i = 0; i < data.size(); ++i) {
+                  OVE::OveSong song;
+                  OVE::IOVEStreamLoader* loader = OVE::createOveStreamLoader();
+                  loader->setOve(&song);
+                  loader->setFileStream((unsigned char*)data[i].data(), data[i].size());
+                  bool ok = loader->load();
+                  loader->release();
+                  QVERIFY2(ok, qPrintable(fl[i]));
+                  }
+            }
+      }
+
+QTEST_MAIN(TestOve)
+#include "tst_ove.moc"
+
@@ -0,0 +1,197 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "synthesizer/voicealloc.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestVoiceAlloc
+//---------------------------------------------------------
+
+class TestVoiceAlloc : public QObject, public MTest
+      {
+      Q_OBJECT
+
+   private slots:
+      void initTestCase();
+      void lowest();
+      void randomOperations();
+      void channelLimit();
+      void steals();
+      void benchmark();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestVoiceAlloc::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   lowest
+//---------------------------------------------------------
+
+void TestVoiceAlloc::lowest()
+      {
+      VoiceAllocator va(8, 2);
+      QCOMPARE(va.lowest(), -1);
+      QCOMPARE(va.victim(0), -1);
+
+      va.add(0, 0, 5.0);
+      va.add(1, 0, 3.0);
+      va.add(2, 1, 4.0);
+      QCOMPARE(va.active(), 3);
+      QCOMPARE(va.active(0), 2);
+      QCOMPARE(va.lowest(), 1);
+      QCOMPARE(va.lowest(1), 2);
+
+      va.update(1, 10.0);
+      QCOMPARE(va.lowest(), 2);
+      QCOMPARE(va.lowest(0), 0);
+
+      va.remove(2);
+      QVERIFY(!va.isActive(2));
+      QCOMPARE(va.lowest(), 0);
+      QCOMPARE(va.lowest(1), -1);
+
+      va.clear();
+      QCOMPARE(va.active(), 0);
+      QVERIFY(!va.isActive(0));
+      }
+
+//---------------------------------------------------------
+//   randomOperations
+//    compare against a linear scan
+//---------------------------------------------------------
+
+void TestVoiceAlloc::randomOperations()
+      {
+      const int voices   = 64;
+      const int channels = 4;
+      VoiceAllocator va(voices, channels);
+      QVector<double> prio(voices);
+      QVector<int> chan(voices, -1);
+
+      qsrand(4711);
+      for (int i = 0; i < 20000; ++i) {
+            int v = qrand() % voices;
+            double p = qrand() % 1000;
+            switch (qrand() % 3) {
+                  case 0:
+                        chan[v] = qrand() % channels;
+                        prio[v] = p;
+                        va.add(v, chan[v], p);
+                        break;
+                  case 1:
+                        if (chan[v] != -1) {
+                              prio[v] = p;
+                              va.update(v, p);
+                              }
+                        break;
+                  case 2:
+                        chan[v] = -1;
+                        va.remove(v);
+                        break;
+                  }
+            for (int c = -1; c < channels; ++c) {
+                  double min = 0.0;
+                  int n      = 0;
+                  for (int k = 0; k < voices; ++k) {
+                        if (chan[k] == -1 || (c != -1 && chan[k] != c))
+                              continue;
+                        if (n == 0 || prio[k] < min)
+                              min = prio[k];
+                        ++n;
+                        }
+                  int lowest = c == -1 ? va.lowest() : va.lowest(c);
+                  QCOMPARE(c == -1 ? va.active() : va.active(c), n);
+                  if (n == 0)
+                        QCOMPARE(lowest, -1);
+                  else
+                        QCOMPARE(prio[lowest], min);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   channelLimit
+//---------------------------------------------------------
+
+void TestVoiceAlloc::channelLimit()
+      {
+      VoiceAllocator va(4, 2);
+      va.setPolyphony(0, 2);
+      va.add(0, 0, 1.0);
+      QCOMPARE(va.victim(0), -1);
+      va.add(1, 0, 2.0);
+      QCOMPARE(va.victim(0), 0);          // channel 0 is full
+      QCOMPARE(va.victim(1), -1);         // channel 1 has no limit
+
+      va.add(2, 1, 0.5);
+      va.add(3, 1, 3.0);
+      QCOMPARE(va.victim(1), 2);          // all voices in use
+      QCOMPARE(va.victim(0), 0);          // limited channel steals from itself
+      }
+
+//---------------------------------------------------------
+//   steals
+//---------------------------------------------------------
+
+void TestVoiceAlloc::steals()
+      {
+      VoiceAllocator va(4, 1);
+      va.stolen();
+      va.stolen();
+      QCOMPARE(va.blockSteals(), 0);
+      va.endBlock();
+      QCOMPARE(va.blockSteals(), 2);
+      va.stolen();
+      va.endBlock();
+      QCOMPARE(va.blockSteals(), 1);
+      va.endBlock();
+      QCOMPARE(va.blockSteals(), 0);
+      QCOMPARE(va.totalSteals(), 3);
+      }
+
+//---------------------------------------------------------
+//   benchmark
+//    note on at maximum polyphony: steal the lowest
+//    priority voice and restart it
+//---------------------------------------------------------
+
+void TestVoiceAlloc::benchmark()
+      {
+      const int voices = 512;
+      VoiceAllocator va(voices, 16);
+      for (int i = 0; i < voices; ++i)
+            va.add(i, i % 16, i);
+      double serial = voices;
+      QBENCHMARK {
+            for (int i = 0; i < 10000; ++i) {
+                  int v = va.victim(i % 16);
+                  va.stolen();
+                  va.add(v, i % 16, serial++);
+                  }
+            }
+      QCOMPARE(va.active(), voices);
+      }
+
+QTEST_MAIN(TestVoiceAlloc)
+#include "tst_voicealloc.moc"
+
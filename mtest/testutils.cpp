@@ -32,6 +32,7 @@ extern Score::FileError importPdf(Score*, const QString&);
 
 extern Score::FileError importBB(Score*, const QString&);
 extern Score::FileError importCapella(Score*, const QString&);
+extern Score::FileError importOve(Score*, const QString&);
 extern Score::FileError importCapXml(Score*, const QString&);
 extern Score::FileError importCompressedMusicXml(Score*, const QString&);
 extern Score::FileError importMusicXml(Score*, const QString&);
@@ -125,6 +126,8 @@ Score* MTest::readCreatedScore(const QString& name)
             rv = importCapXml(score, name);
       else if (csl == "sgu")
             rv = importBB(score, name);
+      else if (csl == "ove")
+            rv = importOve(score, name);
       else if (csl == "mscz" || csl == "mscx")
             rv = score->loadMsc(name, false);
       else if (csl == "mxl")
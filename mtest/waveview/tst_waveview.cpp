@@ -0,0 +1,247 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "libmscore/audio.h"
+#include "libmscore/mcursor.h"
+#include "mscore/waveview.h"
+
+#include <sndfile.h>
+
+using namespace Ms;
+
+static const int SAMPLE_RATE = 44100;
+
+//---------------------------------------------------------
+//   TestWaveView
+//    waveform peaks, their cache in the score and the
+//    background computation while the audio changes
+//---------------------------------------------------------
+
+class TestWaveView : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QByteArray ogg;         // one second of a sine with amplitude 0.5
+
+      Score* createScore(Audio*);
+      void waitForPeaks();
+
+   private slots:
+      void initTestCase();
+      void buildPeaks();
+      void peakCache();
+      void cachePeaksInScore();
+      void removeAudioWhileBuilding();
+      void replaceAudioWhileBuilding();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestWaveView::initTestCase()
+      {
+      initMTest();
+
+      SF_INFO info;
+      memset(&info, 0, sizeof(info));
+      info.samplerate = SAMPLE_RATE;
+      info.channels   = 1;
+      info.format     = SF_FORMAT_OGG | SF_FORMAT_VORBIS;
+      SNDFILE* sf = sf_open("waveview.ogg", SFM_WRITE, &info);
+      QVERIFY(sf);
+      QVector<float> buffer(SAMPLE_RATE);
+      for (int i = 0; i < SAMPLE_RATE; ++i)
+            buffer[i] = 0.5 * sin(2.0 * M_PI * 440.0 * i / SAMPLE_RATE);
+      QCOMPARE(sf_writef_float(sf, buffer.data(), SAMPLE_RATE), sf_count_t(SAMPLE_RATE));
+      sf_close(sf);
+
+      QFile f("waveview.ogg");
+      QVERIFY(f.open(QIODevice::ReadOnly));
+      ogg = f.readAll();
+      QVERIFY(!ogg.isEmpty());
+      }
+
+//---------------------------------------------------------
+//   createScore
+//---------------------------------------------------------
+
+Score* TestWaveView::createScore(Audio* audio)
+      {
+      MCursor c;
+      c.createScore("waveview");
+      Score* score = c.score();
+      score->setAudio(audio);
+      return score;
+      }
+
+//---------------------------------------------------------
+//   waitForPeaks
+//    wait for the background computation and deliver
+//    its finished signal
+//---------------------------------------------------------
+
+void TestWaveView::waitForPeaks()
+      {
+      QThreadPool::globalInstance()->waitForDone();
+      QTest::qWait(50);
+      }
+
+//---------------------------------------------------------
+//   buildPeaks
+//---------------------------------------------------------
+
+void TestWaveView::buildPeaks()
+      {
+      WavePeaks peaks;
+      peaks.build(ogg);
+      QVERIFY(!peaks.isEmpty());
+
+      int mn, mx;
+      QVERIFY(peaks.range(0, SAMPLE_RATE, &mn, &mx));
+      QVERIFY(qAbs(mx - 64) <= 3);
+      QVERIFY(qAbs(mn + 64) <= 3);
+      QVERIFY(!peaks.range(SAMPLE_RATE, SAMPLE_RATE * 2, &mn, &mx));
+      }
+
+//---------------------------------------------------------
+//   peakCache
+//    the cache is rejected for other audio data of
+//    the same size
+//---------------------------------------------------------
+
+void TestWaveView::peakCache()
+      {
+      WavePeaks peaks;
+      peaks.build(ogg);
+      QByteArray cache = peaks.write();
+
+      WavePeaks p;
+      QVERIFY(p.read(cache, ogg));
+      int mn1, mx1, mn2, mx2;
+      for (int frame = 0; frame < SAMPLE_RATE; frame += 1000) {
+            QVERIFY(peaks.range(frame, frame + 1000, &mn1, &mx1));
+            QVERIFY(p.range(frame, frame + 1000, &mn2, &mx2));
+            QCOMPARE(mn1, mn2);
+            QCOMPARE(mx1, mx2);
+            }
+      // the cache must survive another round trip
+      QCOMPARE(p.write(), cache);
+
+      QByteArray other(ogg);
+      other[other.size() / 2] = other[other.size() / 2] ^ 1;
+      QVERIFY(!p.read(cache, other));
+      QVERIFY(p.isEmpty());
+      QVERIFY(!p.read(cache, ogg.left(ogg.size() - 1)));
+      QVERIFY(!p.read(cache.left(cache.size() / 2), ogg));
+      }
+
+//---------------------------------------------------------
+//   cachePeaksInScore
+//    computed peaks are kept in the Audio of the score
+//    and used by the next view
+//---------------------------------------------------------
+
+void TestWaveView::cachePeaksInScore()
+      {
+      Audio* audio = new Audio;
+      audio->setData(ogg);
+      Score* score = createScore(audio);
+      Pos locator[3];
+      {
+      WaveView view;
+      view.setScore(score, locator);
+      view.setAudio(audio);
+      waitForPeaks();
+      QVERIFY(view.hasPeaks());
+      QVERIFY(!audio->peaks().isEmpty());
+      }
+      WaveView view;
+      view.setScore(score, locator);
+      view.setAudio(audio);
+      QVERIFY(view.hasPeaks());
+      score->removeAudio();
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   removeAudioWhileBuilding
+//    the score deletes its Audio before the peaks are
+//    finished
+//---------------------------------------------------------
+
+void TestWaveView::removeAudioWhileBuilding()
+      {
+      Audio* audio = new Audio;
+      audio->setData(ogg);
+      Score* score = createScore(audio);
+      Pos locator[3];
+      WaveView view;
+      view.setScore(score, locator);
+      view.setAudio(audio);
+      score->removeAudio();
+      waitForPeaks();
+      QVERIFY(!view.hasPeaks());
+      QVERIFY(score->audio() == 0);
+
+      // new audio of the same size replaces the removed one
+      QByteArray other(ogg);
+      other[other.size() / 2] = other[other.size() / 2] ^ 1;
+      audio = new Audio;
+      audio->setData(other);
+      score->setAudio(audio);
+      view.setAudio(audio);
+      score->removeAudio();
+      audio = new Audio;
+      audio->setData(ogg);
+      score->setAudio(audio);
+      waitForPeaks();
+      QVERIFY(!view.hasPeaks());
+      QVERIFY(audio->peaks().isEmpty());
+      score->removeAudio();
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   replaceAudioWhileBuilding
+//    only the peaks of the current audio are shown
+//---------------------------------------------------------
+
+void TestWaveView::replaceAudioWhileBuilding()
+      {
+      Audio* audio = new Audio;
+      audio->setData(ogg);
+      Score* score = createScore(audio);
+      Pos locator[3];
+      WaveView view;
+      view.setScore(score, locator);
+      view.setAudio(audio);
+      view.setAudio(0);
+      waitForPeaks();
+      QVERIFY(!view.hasPeaks());
+      QVERIFY(audio->peaks().isEmpty());
+
+      view.setAudio(audio);
+      waitForPeaks();
+      QVERIFY(view.hasPeaks());
+      QVERIFY(!audio->peaks().isEmpty());
+      score->removeAudio();
+      delete score;
+      }
+
+QTEST_MAIN(TestWaveView)
+#include "tst_waveview.moc"
+
@@ -56,6 +56,7 @@ MasterSynthesizer::MasterSynthesizer()
       lock2 = true;
       _synthesizer.reserve(4);
       _gain = 1.0;
+      _stolenVoices = 0;
       _masterTuning = 440.0;
       for (int i = 0; i < MAX_EFFECTS; ++i)
             _effect[i] = 0;
@@ -119,6 +120,16 @@ void MasterSynthesizer::play(const NPlayEvent& event, unsigned syntiIdx)
       _synthesizer[syntiIdx]->play(event);
       }
 
+//---------------------------------------------------------
+//   loadProgram
+//---------------------------------------------------------
+
+void MasterSynthesizer::loadProgram(int bank, int program, unsigned syntiIdx)
+      {
+      if (syntiIdx < _synthesizer.size())
+            _synthesizer[syntiIdx]->loadProgram(bank, program);
+      }
+
 //---------------------------------------------------------
 //   synthNameToIndex
 //---------------------------------------------------------
@@ -274,8 +285,10 @@ void MasterSynthesizer::process(unsigned n, float* p)
             return;
             }
       for (Synthesizer* s : _synthesizer) {
-            if (s->active())
+            if (s->active()) {
                   s->process(n, p, effect1Buffer, effect2Buffer);
+                  _stolenVoices += s->stolenVoices();
+                  }
             }
       if (_effect[0] && _effect[1]) {
             memset(effect1Buffer, 0, n * sizeof(float) * 2);
@@ -48,6 +48,7 @@ class MasterSynthesizer : public QObject {
       Effect* _effect[2];
 
       float _sampleRate;
+      std::atomic<int> _stolenVoices;
 
       float effect1Buffer[MAX_BUFFERSIZE];
       float effect2Buffer[MAX_BUFFERSIZE];
@@ -73,6 +74,7 @@ class MasterSynthesizer : public QObject {
 
       void process(unsigned, float*);
       void play(const NPlayEvent&, unsigned);
+      void loadProgram(int bank, int program, unsigned);
 
       void setMasterTuning(double val);
       double masterTuning() const      { return _masterTuning; }
@@ -99,6 +101,7 @@ class MasterSynthesizer : public QObject {
       int indexOfEffect(int ab);
 
       float gain() const    { return _gain; }
+      int stolenVoices() const { return _stolenVoices; }
       };
 
 }
@@ -22,6 +22,21 @@ class PlayEvent;
 class Synth;
 class SynthesizerGui;
 
+//---------------------------------------------------------
+//   AudioCallback
+//    true while the current thread runs the process
+//    callback of an audio driver; synthesizers must not
+//    block, allocate or decode samples then
+//---------------------------------------------------------
+
+class AudioCallback {
+      static bool& flag()           { static thread_local bool f = false; return f; }
+
+   public:
+      static bool active()          { return flag(); }
+      static void setActive(bool v) { flag() = v; }
+      };
+
 //---------------------------------------------------------
 //   Synthesizer
 //---------------------------------------------------------
@@ -53,6 +68,10 @@ class Synthesizer {
       virtual void process(unsigned, float*, float*, float*) = 0;
       virtual void play(const PlayEvent&) = 0;
 
+      // prepare the samples of a program before its program
+      // change is played; called from the gui thread
+      virtual void loadProgram(int /*bank*/, int /*program*/) {}
+
       virtual const QList<MidiPatch*>& getPatchInfo() const = 0;
 
       // get/set synthesizer state
@@ -68,6 +87,9 @@ class Synthesizer {
       virtual void allSoundsOff(int /*channel*/) {}
       virtual void allNotesOff(int /*channel*/) {}
 
+      // number of voices stolen in the last block
+      virtual int stolenVoices() const { return 0; }
+
       virtual SynthesizerGui* gui()  { return _gui; }
       };
 
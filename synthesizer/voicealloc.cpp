@@ -0,0 +1,225 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "voicealloc.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   VoiceAllocator
+//---------------------------------------------------------
+
+VoiceAllocator::VoiceAllocator(int maxVoices, int nchannels)
+   : slots(maxVoices), channels(nchannels), limits(nchannels, 0)
+      {
+      // channel heaps grow on first use and keep their capacity
+      global.reserve(maxVoices);
+      for (Slot& s : slots) {
+            s.prio    = 0.0;
+            s.channel = 0;
+            s.gpos    = -1;
+            s.cpos    = -1;
+            }
+      _steals      = 0;
+      _blockSteals = 0;
+      _totalSteals = 0;
+      }
+
+//---------------------------------------------------------
+//   siftUp
+//---------------------------------------------------------
+
+void VoiceAllocator::siftUp(Heap& h, int i, int Slot::* pos)
+      {
+      int voice = h[i];
+      while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!less(voice, h[parent]))
+                  break;
+            h[i] = h[parent];
+            slots[h[i]].*pos = i;
+            i = parent;
+            }
+      h[i] = voice;
+      slots[voice].*pos = i;
+      }
+
+//---------------------------------------------------------
+//   siftDown
+//---------------------------------------------------------
+
+void VoiceAllocator::siftDown(Heap& h, int i, int Slot::* pos)
+      {
+      int n     = int(h.size());
+      int voice = h[i];
+      for (;;) {
+            int child = 2 * i + 1;
+            if (child >= n)
+                  break;
+            if (child + 1 < n && less(h[child + 1], h[child]))
+                  ++child;
+            if (!less(h[child], voice))
+                  break;
+            h[i] = h[child];
+            slots[h[i]].*pos = i;
+            i = child;
+            }
+      h[i] = voice;
+      slots[voice].*pos = i;
+      }
+
+//---------------------------------------------------------
+//   insert
+//---------------------------------------------------------
+
+void VoiceAllocator::insert(Heap& h, int voice, int Slot::* pos)
+      {
+      h.push_back(voice);
+      siftUp(h, int(h.size()) - 1, pos);
+      }
+
+//---------------------------------------------------------
+//   erase
+//---------------------------------------------------------
+
+void VoiceAllocator::erase(Heap& h, int voice, int Slot::* pos)
+      {
+      int i = slots[voice].*pos;
+      int last = h.back();
+      h.pop_back();
+      slots[voice].*pos = -1;
+      if (last == voice)
+            return;
+      h[i] = last;
+      slots[last].*pos = i;
+      fix(h, last, pos);
+      }
+
+//---------------------------------------------------------
+//   fix
+//    restore heap order after the priority of voice
+//    has changed
+//---------------------------------------------------------
+
+void VoiceAllocator::fix(Heap& h, int voice, int Slot::* pos)
+      {
+      int i = slots[voice].*pos;
+      if (i > 0 && less(voice, h[(i - 1) / 2]))
+            siftUp(h, i, pos);
+      else
+            siftDown(h, i, pos);
+      }
+
+//---------------------------------------------------------
+//   setPolyphony
+//    limit the number of voices of channel to n;
+//    0 means no limit
+//---------------------------------------------------------
+
+void VoiceAllocator::setPolyphony(int channel, int n)
+      {
+      limits[channel] = n;
+      }
+
+//---------------------------------------------------------
+//   add
+//---------------------------------------------------------
+
+void VoiceAllocator::add(int voice, int channel, double prio)
+      {
+      if (isActive(voice))
+            remove(voice);
+      Slot& s   = slots[voice];
+      s.prio    = prio;
+      s.channel = channel;
+      insert(global, voice, &Slot::gpos);
+      insert(channels[channel], voice, &Slot::cpos);
+      }
+
+//---------------------------------------------------------
+//   update
+//---------------------------------------------------------
+
+void VoiceAllocator::update(int voice, double prio)
+      {
+      Slot& s = slots[voice];
+      if (s.gpos == -1 || s.prio == prio)
+            return;
+      s.prio = prio;
+      fix(global, voice, &Slot::gpos);
+      fix(channels[s.channel], voice, &Slot::cpos);
+      }
+
+//---------------------------------------------------------
+//   remove
+//---------------------------------------------------------
+
+void VoiceAllocator::remove(int voice)
+      {
+      Slot& s = slots[voice];
+      if (s.gpos == -1)
+            return;
+      erase(global, voice, &Slot::gpos);
+      erase(channels[s.channel], voice, &Slot::cpos);
+      }
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void VoiceAllocator::clear()
+      {
+      for (int voice : global) {
+            slots[voice].gpos = -1;
+            slots[voice].cpos = -1;
+            }
+      global.clear();
+      for (Heap& h : channels)
+            h.clear();
+      }
+
+//---------------------------------------------------------
+//   lowest
+//    active voice with the lowest priority or -1
+//---------------------------------------------------------
+
+int VoiceAllocator::lowest() const
+      {
+      return global.empty() ? -1 : global.front();
+      }
+
+int VoiceAllocator::lowest(int channel) const
+      {
+      const Heap& h = channels[channel];
+      return h.empty() ? -1 : h.front();
+      }
+
+//---------------------------------------------------------
+//   victim
+//    the voice which must be stolen before a new voice
+//    can be started on channel, or -1 if there is room
+//---------------------------------------------------------
+
+int VoiceAllocator::victim(int channel) const
+      {
+      if (channel >= 0 && channel < int(limits.size())) {
+            int limit = limits[channel];
+            if (limit > 0 && active(channel) >= limit)
+                  return lowest(channel);
+            }
+      if (active() >= maxVoices())
+            return lowest();
+      return -1;
+      }
+
+}     // namespace Ms
+
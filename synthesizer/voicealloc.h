@@ -0,0 +1,92 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2013 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __VOICEALLOC_H__
+#define __VOICEALLOC_H__
+
+#include <vector>
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   VoiceAllocator
+//    Keeps track of the sounding voices of a synthesizer
+//    for voice stealing. Voices are identified by their
+//    index 0 .. maxVoices-1 and have a priority computed
+//    by the synthesizer; the voice with the lowest priority
+//    is stolen first.
+//
+//    Active voices are kept in an indexed min-heap and in
+//    one heap per channel, so finding the voice to steal
+//    is O(1) and changing a priority is O(log n).
+//    The synthesizer updates the priority when the state
+//    of a voice changes (envelope stage, note off, sustain).
+//
+//    No memory is allocated once every channel heap has
+//    reached its working size. Not thread safe.
+//---------------------------------------------------------
+
+class VoiceAllocator {
+      struct Slot {
+            double prio;
+            int channel;
+            int gpos;               // position in global heap, -1 if not active
+            int cpos;               // position in channel heap
+            };
+      typedef std::vector<int> Heap;
+
+      std::vector<Slot> slots;
+      Heap global;
+      std::vector<Heap> channels;
+      std::vector<int> limits;      // max voices per channel, 0 = no limit
+
+      int _steals;                  // steals in current block
+      int _blockSteals;             // steals in last block
+      int _totalSteals;
+
+      bool less(int a, int b) const { return slots[a].prio < slots[b].prio; }
+      void siftUp(Heap&, int i, int Slot::* pos);
+      void siftDown(Heap&, int i, int Slot::* pos);
+      void insert(Heap&, int voice, int Slot::* pos);
+      void erase(Heap&, int voice, int Slot::* pos);
+      void fix(Heap&, int voice, int Slot::* pos);
+
+   public:
+      VoiceAllocator(int maxVoices, int channels);
+
+      int maxVoices() const               { return int(slots.size()); }
+      int active() const                  { return int(global.size()); }
+      int active(int channel) const       { return int(channels[channel].size()); }
+      bool isActive(int voice) const      { return slots[voice].gpos != -1; }
+      double priority(int voice) const    { return slots[voice].prio; }
+
+      void setPolyphony(int channel, int n);
+      int polyphony(int channel) const    { return limits[channel]; }
+
+      void add(int voice, int channel, double prio);
+      void update(int voice, double prio);
+      void remove(int voice);
+      void clear();
+
+      int lowest() const;
+      int lowest(int channel) const;
+      int victim(int channel) const;
+
+      void stolen()                       { ++_steals; ++_totalSteals; }
+      void endBlock()                     { _blockSteals = _steals; _steals = 0; }
+      int blockSteals() const             { return _blockSteals; }
+      int totalSteals() const             { return _totalSteals; }
+      };
+
+}     // namespace Ms
+#endif
+
@@ -43,8 +43,8 @@ void Envelope::setTime(float ms, int sampleRate)
 //   Voice
 //---------------------------------------------------------
 
-Voice::Voice(Zerberus* z)
-   : _zerberus(z), attackEnv(Envelope::egLin), stopEnv(Envelope::egPow)
+Voice::Voice(Zerberus* z, int index)
+   : _zerberus(z), _index(index), _serial(0), attackEnv(Envelope::egLin), stopEnv(Envelope::egPow)
       {
       }
 
@@ -52,10 +52,27 @@ Voice::Voice(Zerberus* z)
 //   stop
 //---------------------------------------------------------
 
+void Voice::stop()
+      {
+      _state = VoiceState::STOP;
+      _zerberus->updateVoice(this);
+      }
+
 void Voice::stop(float time)
       {
       _state = VoiceState::STOP;
       stopEnv.setTime(time, _zerberus->sampleRate());
+      _zerberus->updateVoice(this);
+      }
+
+//---------------------------------------------------------
+//   sustained
+//---------------------------------------------------------
+
+void Voice::sustained()
+      {
+      _state = VoiceState::SUSTAINED;
+      _zerberus->updateVoice(this);
       }
 
 //---------------------------------------------------------
@@ -95,6 +95,8 @@ enum class VoiceState {
 class Voice {
       Voice* _next;
       Zerberus* _zerberus;
+      int _index;                   // position in Zerberus voice table
+      unsigned _serial;             // start order, used for voice stealing
 
       VoiceState _state = VoiceState::OFF;
       Channel* _channel;
@@ -149,7 +151,7 @@ class Voice {
       void updateFilter(float fres);
 
    public:
-      Voice(Zerberus*);
+      Voice(Zerberus*, int index);
       Voice* next() const         { return _next; }
       void setNext(Voice* v)      { _next = v; }
 
@@ -159,14 +161,17 @@ class Voice {
       Channel* channel() const    { return _channel; }
       int key() const             { return _key;     }
       int velocity() const        { return _velocity; }
+      int index() const           { return _index;    }
+      unsigned serial() const     { return _serial;   }
+      void setSerial(unsigned v)  { _serial = v;      }
 
       bool isPlaying() const      { return _state == VoiceState::PLAYING;   }
       bool isSustained() const    { return _state == VoiceState::SUSTAINED; }
       bool isOff() const          { return _state == VoiceState::OFF; }
       bool isStopped() const      { return _state == VoiceState::STOP; }
-      void stop()                 { _state = VoiceState::STOP;      }
+      void stop();
       void stop(float time);
-      void sustained()            { _state = VoiceState::SUSTAINED; }
+      void sustained();
       void off()                  { _state = VoiceState::OFF;       }
       const char* state() const;
       LoopMode loopMode() const   { return _loopMode; }
@@ -41,14 +41,16 @@ Ms::Synthesizer* createZerberus()
 //---------------------------------------------------------
 
 Zerberus::Zerberus()
-   : Synthesizer()
+   : Synthesizer(), voiceAlloc(MAX_VOICES, MAX_CHANNEL)
       {
       if (!initialized) {
             initialized = true;
             Voice::init();
             }
-      for (int i = 0; i < MAX_VOICES; ++i)
-            freeVoices.push(new Voice(this));
+      for (int i = 0; i < MAX_VOICES; ++i) {
+            _voices[i] = new Voice(this, i);
+            freeVoices.push(_voices[i]);
+            }
       for (int i = 0; i < MAX_CHANNEL; ++i)
             _channel[i] = new Channel(this, i);
       busy = true;      // no sf loaded yet
@@ -95,18 +97,30 @@ void Zerberus::trigger(Channel* channel, int key, int velo, Trigger trigger)
       ZInstrument* i = channel->instrument();
       for (Zone* z : i->zones()) {
             if (z->match(channel, key, velo, trigger)) {
-                  if (freeVoices.empty()) {
-                        qDebug("Zerberus: out of voices...");
-                        return;
+                  Voice* voice;
+                  int idx = voiceAlloc.victim(channel->idx());
+                  if (idx != -1) {
+                        // steal a voice; it is already in the
+                        // active list and is restarted in place
+                        voice = _voices[idx];
+                        voiceAlloc.stolen();
+                        }
+                  else {
+                        if (freeVoices.empty()) {
+                              qDebug("Zerberus: out of voices...");
+                              return;
+                              }
+                        voice = freeVoices.pop();
+                        if (!voice->isOff())
+                              abort();
+                        voice->setNext(activeVoices);
+                        activeVoices = voice;
                         }
-                  Voice* voice = freeVoices.pop();
-                  if (!voice->isOff())
-                        abort();
                   voice->start(channel, key, velo, z);
+                  voice->setSerial(++_serial);
+                  voiceAlloc.add(voice->index(), channel->idx(), voicePriority(voice));
                   if (trigger == Trigger::RELEASE)
                         voice->stop();    // start voice in stop mode
-                  voice->setNext(activeVoices);
-                  activeVoices = voice;
 
                   //
                   // handle offBy voices
@@ -223,12 +237,42 @@ void Zerberus::process(unsigned frames, float* p, float*, float*)
                         pv->setNext(v->next());
                   else
                         activeVoices = v->next();
+                  voiceAlloc.remove(v->index());
                   freeVoices.push(v);
                   }
             else
                   pv = v;
             v = v->next();
             }
+      voiceAlloc.endBlock();
+      }
+
+//---------------------------------------------------------
+//   voicePriority
+//    stopped voices are stolen first, then sustained
+//    voices, then the oldest held voice
+//---------------------------------------------------------
+
+double Zerberus::voicePriority(const Voice* v) const
+      {
+      int level;
+      if (v->isStopped())
+            level = 0;
+      else if (v->isSustained())
+            level = 1;
+      else
+            level = 2;
+      return level * 4294967296.0 + v->serial();
+      }
+
+//---------------------------------------------------------
+//   updateVoice
+//    called when the state of a voice changes
+//---------------------------------------------------------
+
+void Zerberus::updateVoice(Voice* v)
+      {
+      voiceAlloc.update(v->index(), voicePriority(v));
       }
 
 //---------------------------------------------------------
@@ -20,6 +20,7 @@
 
 #include "synthesizer/synthesizer.h"
 #include "synthesizer/event.h"
+#include "synthesizer/voicealloc.h"
 
 class Voice;
 class Channel;
@@ -75,14 +76,18 @@ class Zerberus : public Ms::Synthesizer {
       Channel* _channel[MAX_CHANNEL];
 
       int allocatedVoices = 0;
+      Voice* _voices[MAX_VOICES];
       VoiceFifo freeVoices;
       Voice* activeVoices = 0;
+      Ms::VoiceAllocator voiceAlloc;      // active voices ordered by priority for stealing
+      unsigned _serial = 0;               // incremented for every started voice
       int _loadProgress = 0;
 
       void programChange(int channel, int program);
       void trigger(Channel*, int key, int velo, Trigger);
       void processNoteOff(Channel*, int pitch);
       void processNoteOn(Channel* cp, int key, int velo);
+      double voicePriority(const Voice*) const;
 
    public:
       Zerberus();
@@ -95,6 +100,9 @@ class Zerberus : public Ms::Synthesizer {
 
       ZInstrument* instrument(int program) const;
       Voice* getActiveVoices()      { return activeVoices; }
+      void updateVoice(Voice*);
+      void setPolyphony(int channel, int voices) { voiceAlloc.setPolyphony(channel, voices); }
+      virtual int stolenVoices() const           { return voiceAlloc.blockSteals(); }
       Channel* channel(int n)       { return _channel[n]; }
       int loadProgress()            { return _loadProgress; }
       void setLoadProgress(int val) { _loadProgress = val; }